@@ -6,14 +6,22 @@
 //
 #include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
+#include "td/actor/MultiTimeout.h"
 #include "td/actor/PromiseFuture.h"
 
 #include "td/utils/benchmark.h"
 #include "td/utils/common.h"
 #include "td/utils/crypto.h"
+#include "td/utils/Heap.h"
 #include "td/utils/logging.h"
 #include "td/utils/Promise.h"
+#include "td/utils/Random.h"
+#include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/TimerWheel.h"
+
+#include <array>
+#include <utility>
 
 #if TD_MSVC
 #pragma comment(linker, "/STACK:16777216")
@@ -324,6 +332,311 @@ class QueryBench final : public td::Benchmark {
   td::ActorOwn<ServerActor> server_;
 };
 
+template <bool enable_work_stealing>
+class WorkStealingBench final : public td::Benchmark {
+ public:
+  explicit WorkStealingBench(int thread_n) : thread_n_(thread_n) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "WorkStealing (" << (enable_work_stealing ? "enabled" : "disabled")
+                     << ") (threads_n = " << thread_n_ << ")";
+  }
+
+  // emulates an account, which receives updates, parsing of which doesn't need account's state
+  class AccountActor final : public td::Actor {
+   public:
+    void run(int n) {
+      left_updates_ = n;
+      for (int i = 0; i < n; i++) {
+        td::Scheduler::instance()->run_stealable(
+            td::PromiseCreator::lambda([actor_id = actor_id(this), data = &data_](td::Unit) {
+              td::uint32 hash = 0;
+              for (int j = 0; j < 16; j++) {
+                hash += td::crc32(td::Slice(data->data(), data->size()));
+              }
+              send_closure(actor_id, &AccountActor::on_update_parsed, hash);
+            }));
+      }
+    }
+
+    void on_update_parsed(td::uint32 hash) {
+      hash_ += hash;
+      if (--left_updates_ == 0) {
+        td::Scheduler::instance()->finish();
+      }
+    }
+
+   private:
+    std::array<char, 4096> data_{};
+    int left_updates_ = 0;
+    td::uint32 hash_ = 0;
+  };
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(thread_n_, 0, enable_work_stealing);
+    account_ = scheduler_->create_actor_unsafe<AccountActor>(0, "Account");
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      send_closure(account_, &AccountActor::run, td::max(n, 1));
+    }
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() final {
+    account_.release();
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  int thread_n_ = -1;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  td::ActorOwn<AccountActor> account_;
+};
+
+// a dispatcher on the main scheduler sends queries to actors on other schedulers and waits for all answers,
+// like NetQueryDispatcher does for managers
+class FanOutBench final : public td::Benchmark {
+ public:
+  FanOutBench(int actor_n, int thread_n) : actor_n_(actor_n), thread_n_(thread_n) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "FanOut (actors_n = " << actor_n_ << ") (threads_n = " << thread_n_ << ")";
+  }
+
+  class DispatcherActor;
+
+  class WorkerActor final : public td::Actor {
+   public:
+    explicit WorkerActor(td::ActorId<DispatcherActor> dispatcher) : dispatcher_(std::move(dispatcher)) {
+    }
+
+    void on_query(int x) {
+      send_closure(dispatcher_, &DispatcherActor::on_answer, x + 1);
+    }
+
+   private:
+    td::ActorId<DispatcherActor> dispatcher_;
+  };
+
+  class DispatcherActor final : public td::Actor {
+   public:
+    void add_worker(td::ActorOwn<WorkerActor> worker) {
+      workers_.push_back(std::move(worker));
+    }
+
+    void run(int n) {
+      left_answers_ = n;
+      for (int i = 0; i < n; i++) {
+        send_closure(workers_[i % workers_.size()], &WorkerActor::on_query, i);
+      }
+    }
+
+    void on_answer(int x) {
+      sum_ += x;
+      if (--left_answers_ == 0) {
+        td::Scheduler::instance()->finish();
+      }
+    }
+
+   private:
+    td::vector<td::ActorOwn<WorkerActor>> workers_;
+    int left_answers_ = 0;
+    td::int64 sum_ = 0;
+  };
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(thread_n_, 0);
+    dispatcher_ = scheduler_->create_actor_unsafe<DispatcherActor>(0, "Dispatcher");
+    for (int i = 0; i < actor_n_; i++) {
+      auto worker = scheduler_->create_actor_unsafe<WorkerActor>(i % thread_n_ + 1, "Worker", dispatcher_.get());
+      dispatcher_.get_actor_unsafe()->add_worker(std::move(worker));
+    }
+    scheduler_->start();
+  }
+
+  void run(int n) final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      send_closure(dispatcher_, &DispatcherActor::run, td::max(n, 1));
+    }
+    while (scheduler_->run_main(10)) {
+      // empty
+    }
+  }
+
+  void tear_down() final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      dispatcher_.reset();
+    }
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  int actor_n_ = -1;
+  int thread_n_ = -1;
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  td::ActorOwn<DispatcherActor> dispatcher_;
+};
+
+static constexpr int ACTIVE_TIMEOUT_COUNT = 1000000;
+
+// each operation re-arms or cancels and re-adds one of 1M active timeouts; simulated time moves by 1 ms
+// every 1000 operations, and expired timeouts are re-armed
+template <bool use_timer_wheel>
+class TimeoutQueueBench final : public td::Benchmark {
+ public:
+  td::string get_description() const final {
+    return PSTRING() << (use_timer_wheel ? "TimerWheel" : "KHeap") << " with " << ACTIVE_TIMEOUT_COUNT
+                     << " active timeouts";
+  }
+
+  void start_up() final {
+    now_ = 1000.0;
+    heap_nodes_ = td::vector<td::HeapNode>(ACTIVE_TIMEOUT_COUNT);
+    wheel_nodes_ = td::vector<td::TimerWheelNode>(ACTIVE_TIMEOUT_COUNT);
+    wheel_ = td::make_unique<td::TimerWheel>(now_);
+    for (int i = 0; i < ACTIVE_TIMEOUT_COUNT; i++) {
+      insert(i);
+    }
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      auto id = rnd_.fast(0, ACTIVE_TIMEOUT_COUNT - 1);
+      if (i % 4 == 0) {
+        erase(id);
+        insert(id);
+      } else {
+        fix(id);
+      }
+      if (i % 1000 == 999) {
+        now_ += 0.001;
+        pop_expired();
+      }
+    }
+  }
+
+  void tear_down() final {
+    heap_ = td::KHeap<double>();
+    heap_nodes_.clear();
+    wheel_ = nullptr;
+    wheel_nodes_.clear();
+  }
+
+ private:
+  double now_ = 0.0;
+  td::Random::Xorshift128plus rnd_{123};
+  td::KHeap<double> heap_;
+  td::vector<td::HeapNode> heap_nodes_;
+  td::unique_ptr<td::TimerWheel> wheel_;
+  td::vector<td::TimerWheelNode> wheel_nodes_;
+
+  double random_timeout() {
+    // timeouts are usually re-armed with one of a few fixed delays
+    static constexpr double DELAYS[] = {0.1, 1.0, 60.0, 3600.0, 86400.0};
+    return now_ + DELAYS[rnd_.fast(0, 4)] + rnd_.fast(0, 1000) * 1e-6;
+  }
+
+  void insert(int id) {
+    if (use_timer_wheel) {
+      wheel_->insert(random_timeout(), &wheel_nodes_[id]);
+    } else {
+      heap_.insert(random_timeout(), &heap_nodes_[id]);
+    }
+  }
+
+  void erase(int id) {
+    if (use_timer_wheel) {
+      wheel_->erase(&wheel_nodes_[id]);
+    } else {
+      heap_.erase(&heap_nodes_[id]);
+    }
+  }
+
+  void fix(int id) {
+    if (use_timer_wheel) {
+      wheel_->fix(random_timeout(), &wheel_nodes_[id]);
+    } else {
+      heap_.fix(random_timeout(), &heap_nodes_[id]);
+    }
+  }
+
+  void pop_expired() {
+    if (use_timer_wheel) {
+      td::TimerWheelNode *node;
+      while ((node = wheel_->pop_expired(now_)) != nullptr) {
+        insert(static_cast<int>(node - &wheel_nodes_[0]));
+      }
+    } else {
+      while (!heap_.empty() && heap_.top_key() < now_) {
+        insert(static_cast<int>(heap_.pop() - &heap_nodes_[0]));
+      }
+    }
+  }
+};
+
+// sets timeouts for random keys of a MultiTimeout with 1M active keys, like MessagesManager does for dialogs
+class MultiTimeoutBench final : public td::Benchmark {
+ public:
+  td::string get_description() const final {
+    return PSTRING() << "MultiTimeout with " << ACTIVE_TIMEOUT_COUNT << " active keys";
+  }
+
+  void start_up() final {
+    scheduler_ = td::make_unique<td::ConcurrentScheduler>(0, 0);
+    scheduler_->start();
+    auto guard = scheduler_->get_main_guard();
+    multi_timeout_ = td::make_unique<td::MultiTimeout>("MultiTimeoutBench");
+    multi_timeout_->set_callback([](void *, td::int64) {});
+    multi_timeout_->set_callback_data(nullptr);
+    for (int i = 0; i < ACTIVE_TIMEOUT_COUNT; i++) {
+      multi_timeout_->set_timeout_in(i, random_timeout());
+    }
+  }
+
+  void run(int n) final {
+    auto guard = scheduler_->get_main_guard();
+    for (int i = 0; i < n; i++) {
+      auto key = rnd_.fast(0, ACTIVE_TIMEOUT_COUNT - 1);
+      if (i % 4 == 0) {
+        multi_timeout_->cancel_timeout(key);
+        multi_timeout_->add_timeout_in(key, random_timeout());
+      } else {
+        multi_timeout_->set_timeout_in(key, random_timeout());
+      }
+    }
+  }
+
+  void tear_down() final {
+    {
+      auto guard = scheduler_->get_main_guard();
+      multi_timeout_.reset();
+    }
+    scheduler_->finish();
+    scheduler_.reset();
+  }
+
+ private:
+  td::Random::Xorshift128plus rnd_{123};
+  td::unique_ptr<td::ConcurrentScheduler> scheduler_;
+  td::unique_ptr<td::MultiTimeout> multi_timeout_;
+
+  double random_timeout() {
+    return rnd_.fast(1000, 86400000) * 0.001;
+  }
+};
+
 int main() {
   td::init_openssl_threads();
 
@@ -346,4 +659,17 @@ int main() {
   bench(RingBench<0>(504, 2));
   bench(RingBench<1>(504, 2));
   bench(RingBench<2>(504, 2));
+  bench(RingBench<0>(2, 2));  // ping-pong between two threads
+  bench(RingBench<1>(2, 2));
+  bench(FanOutBench(16, 2));
+  bench(FanOutBench(16, 4));
+  bench(FanOutBench(256, 4));
+  bench(WorkStealingBench<false>(4));
+  bench(WorkStealingBench<true>(1));
+  bench(WorkStealingBench<true>(2));
+  bench(WorkStealingBench<true>(4));
+  bench(WorkStealingBench<true>(8));
+  bench(TimeoutQueueBench<false>());
+  bench(TimeoutQueueBench<true>());
+  bench(MultiTimeoutBench());
 }
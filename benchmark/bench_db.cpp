@@ -89,11 +89,12 @@ class TdKvBench final : public td::Benchmark {
   }
 };
 
-template <bool is_encrypted = false>
+template <bool is_encrypted = false, bool use_server_options = false>
 class SqliteKVBench final : public td::Benchmark {
   td::SqliteDb db;
   td::string get_description() const final {
-    return PSTRING() << "SqliteKV " << td::tag("is_encrypted", is_encrypted);
+    return PSTRING() << "SqliteKV " << td::tag("is_encrypted", is_encrypted)
+                     << td::tag("use_server_options", use_server_options);
   }
   void start_up() final {
     td::string path = "testdb.sqlite";
@@ -107,6 +108,9 @@ class SqliteKVBench final : public td::Benchmark {
     db.exec("PRAGMA synchronous=NORMAL").ensure();
     db.exec("PRAGMA journal_mode=WAL").ensure();
     db.exec("PRAGMA temp_store=MEMORY").ensure();
+    if (use_server_options) {
+      db.set_options(td::SqliteOptions::server()).ensure();
+    }
     db.exec("DROP TABLE IF EXISTS KV").ensure();
     db.exec("CREATE TABLE IF NOT EXISTS KV (k BLOB PRIMARY KEY, v BLOB)").ensure();
   }
@@ -128,6 +132,10 @@ class SqliteKVBench final : public td::Benchmark {
       }
     }
     db.exec("COMMIT TRANSACTION").ensure();
+    if (use_server_options) {
+      // automatic checkpoints are disabled
+      db.checkpoint().ensure();
+    }
   }
 };
 
@@ -239,6 +247,8 @@ int main() {
   bench(BinlogKeyValueBench<false>());
   bench(SqliteKVBench<false>());
   bench(SqliteKVBench<true>());
+  bench(SqliteKVBench<false, true>());
+  bench(SqliteKVBench<true, true>());
   bench(SqliteKeyValueAsyncBench());
   bench(SeqKvBench());
 }
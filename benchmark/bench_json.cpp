@@ -0,0 +1,75 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/td_api.h"
+#include "td/telegram/td_api_json.h"
+
+#include "td/utils/benchmark.h"
+#include "td/utils/common.h"
+#include "td/utils/JsonBuilder.h"
+#include "td/utils/logging.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
+
+#include <utility>
+
+static const td::string send_message_request =
+    "{\"@type\":\"sendMessage\",\"chat_id\":-1001234567890,\"message_thread_id\":0,\"reply_to\":{\"@type\":"
+    "\"inputMessageReplyToMessage\",\"message_id\":1048576,\"quote\":null},\"options\":{\"@type\":"
+    "\"messageSendOptions\",\"disable_notification\":false,\"from_background\":false,\"protect_content\":false,"
+    "\"update_order_of_installed_sticker_sets\":false,\"scheduling_state\":null,\"effect_id\":\"0\",\"sending_id\":"
+    "0,\"only_preview\":false},\"reply_markup\":null,\"input_message_content\":{\"@type\":\"inputMessageText\","
+    "\"text\":{\"@type\":\"formattedText\",\"text\":\"Hello,"
+    " world! \\u041f\\u0440\\u0438\\u0432\\u0435\\u0442! Check out https://telegram.org and @telegram\","
+    "\"entities\":[{\"@type\":\"textEntity\",\"offset\":0,\"length\":5,\"type\":{\"@type\":"
+    "\"textEntityTypeBold\"}},{\"@type\":\"textEntity\",\"offset\":33,\"length\":20,\"type\":{\"@type\":"
+    "\"textEntityTypeUrl\"}},{\"@type\":\"textEntity\",\"offset\":58,\"length\":9,\"type\":{\"@type\":"
+    "\"textEntityTypeMention\"}}]},\"link_preview_options\":null,\"clear_draft\":true},\"@extra\":{\"request_id\":"
+    "\"a1b2c3d4\",\"attempt\":1}}";
+
+static const td::string get_chat_history_request =
+    "{\"@type\":\"getChatHistory\",\"chat_id\":123456789,\"from_message_id\":0,\"offset\":0,\"limit\":100,"
+    "\"only_local\":false,\"@extra\":42}";
+
+class JsonRequestBench final : public td::Benchmark {
+ public:
+  JsonRequestBench(td::string name, td::string request, bool use_json_value)
+      : name_(std::move(name)), request_(std::move(request)), use_json_value_(use_json_value) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "JsonRequestBench(" << name_ << ", " << (use_json_value_ ? "JsonValue" : "JsonParser") << ')';
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      auto request = request_;
+      td::td_api::object_ptr<td::td_api::Function> function;
+      if (use_json_value_) {
+        auto value = td::json_decode(request).move_as_ok();
+        td::td_api::from_json(function, std::move(value)).ensure();
+      } else {
+        td::JsonParser parser(request);
+        td::td_api::from_json(function, parser).ensure();
+        parser.finish().ensure();
+      }
+      CHECK(function != nullptr);
+    }
+  }
+
+ private:
+  td::string name_;
+  td::string request_;
+  bool use_json_value_;
+};
+
+int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
+  for (auto use_json_value : {true, false}) {
+    td::bench(JsonRequestBench("sendMessage", send_message_request, use_json_value));
+    td::bench(JsonRequestBench("getChatHistory", get_chat_history_request, use_json_value));
+  }
+}
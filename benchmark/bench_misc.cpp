@@ -11,6 +11,9 @@
 #include "td/utils/algorithm.h"
 #include "td/utils/benchmark.h"
 #include "td/utils/common.h"
+#include "td/utils/CompactHints.h"
+#include "td/utils/format.h"
+#include "td/utils/Hints.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/Clocks.h"
 #include "td/utils/port/EventFd.h"
@@ -26,6 +29,7 @@
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/ThreadSafeCounter.h"
+#include "td/utils/utf8.h"
 
 #if !TD_WINDOWS
 #include <unistd.h>
@@ -752,9 +756,82 @@ BENCH(AnyOfTd, "any_of td") {
   td::do_not_optimize_away(res);
 }
 
+template <class HintsT>
+class HintsSearchBench final : public td::Benchmark {
+ public:
+  HintsSearchBench(td::string name, const td::vector<td::string> &names, const td::vector<td::string> &queries)
+      : name_(std::move(name)), key_count_(names.size()), queries_(queries) {
+    auto memory_before = td::mem_stat().ok().resident_size_;
+    for (size_t i = 0; i < names.size(); i++) {
+      hints_.add(static_cast<td::int64>(i + 1), names[i]);
+      hints_.set_rating(static_cast<td::int64>(i + 1), td::Random::fast(0, 1000000));
+    }
+    auto memory_after = td::mem_stat().ok().resident_size_;
+    LOG(WARNING) << name_ << " with " << key_count_ << " keys uses "
+                 << td::format::as_size(memory_after - memory_before);
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << name_ << " search with " << key_count_ << " keys";
+  }
+
+  void run(int n) final {
+    size_t total_size = 0;
+    for (int i = 0; i < n; i++) {
+      total_size += hints_.search(queries_[i % queries_.size()], 10).first;
+    }
+    td::do_not_optimize_away(total_size);
+  }
+
+ private:
+  td::string name_;
+  size_t key_count_;
+  HintsT hints_;
+  td::vector<td::string> queries_;
+};
+
+static void bench_hints_search(int key_count) {
+  auto get_random_word = [] {
+    td::string word;
+    auto is_cyrillic = td::Random::fast_bool();
+    for (int i = td::Random::fast(3, 10); i > 0; i--) {
+      if (is_cyrillic) {
+        td::append_utf8_character(word, static_cast<td::uint32>(td::Random::fast(0x430, 0x44F)));
+      } else {
+        word += static_cast<char>(td::Random::fast('a', 'z'));
+      }
+    }
+    return word;
+  };
+
+  td::vector<td::string> names;
+  td::vector<td::string> queries;
+  for (int i = 0; i < key_count; i++) {
+    td::string name;
+    for (int j = td::Random::fast(1, 3); j > 0; j--) {
+      auto word = get_random_word();
+      if (queries.size() < 1000) {
+        queries.push_back(td::utf8_truncate(word, static_cast<size_t>(td::Random::fast(1, 4))));
+      }
+      name += word;
+      name += ' ';
+    }
+    names.push_back(std::move(name));
+  }
+
+  // both objects are kept alive, so memory freed by one of them isn't reused by another
+  HintsSearchBench<td::Hints> hints_bench("Hints", names, queries);
+  HintsSearchBench<td::CompactHints> compact_hints_bench("CompactHints", names, queries);
+  td::bench(hints_bench);
+  td::bench(compact_hints_bench);
+}
+
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(DEBUG));
 
+  bench_hints_search(1000);
+  bench_hints_search(100000);
+
   td::bench(AnyOfStdBench());
   td::bench(AnyOfTdBench());
 
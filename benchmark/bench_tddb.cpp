@@ -11,10 +11,13 @@
 #include "td/telegram/ServerMessageId.h"
 #include "td/telegram/UserId.h"
 
+#include "td/db/binlog/Binlog.h"
+#include "td/db/binlog/ConcurrentBinlog.h"
 #include "td/db/DbKey.h"
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 
+#include "td/actor/actor.h"
 #include "td/actor/ConcurrentScheduler.h"
 
 #include "td/utils/benchmark.h"
@@ -23,8 +26,12 @@
 #include "td/utils/logging.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Random.h"
+#include "td/utils/SliceBuilder.h"
 #include "td/utils/Status.h"
+#include "td/utils/Storer.h"
+#include "td/utils/Time.h"
 
+#include <algorithm>
 #include <memory>
 
 static td::Status init_db(td::SqliteDb &db) {
@@ -107,7 +114,284 @@ class MessageDbBench final : public td::Benchmark {
   }
 };
 
+// measures latency of short message reads while long full-text searches are running concurrently
+class MessageDbReadLatencyBench final : public td::Actor {
+ public:
+  MessageDbReadLatencyBench(std::shared_ptr<td::SqliteConnectionSafe> sql_connection,
+                            td::vector<td::int32> read_scheduler_ids, int searcher_count, double duration)
+      : sql_connection_(std::move(sql_connection))
+      , read_scheduler_ids_(std::move(read_scheduler_ids))
+      , searcher_count_(searcher_count)
+      , duration_(duration) {
+  }
+
+ private:
+  static constexpr int DIALOG_COUNT = 100;
+  static constexpr int MESSAGE_COUNT = 100000;
+
+  std::shared_ptr<td::SqliteConnectionSafe> sql_connection_;
+  td::vector<td::int32> read_scheduler_ids_;
+  int searcher_count_;
+  double duration_;
+  double start_time_ = 0;
+  int running_query_count_ = 0;
+  td::vector<double> latencies_;
+  std::shared_ptr<td::MessageDbSyncSafeInterface> message_db_sync_safe_;
+  std::shared_ptr<td::MessageDbAsyncInterface> message_db_async_;
+
+  void start_up() final {
+    message_db_sync_safe_ = td::create_message_db_sync(sql_connection_);
+    auto &message_db = message_db_sync_safe_->get();
+    message_db.begin_write_transaction().ensure();
+    for (int i = 1; i <= MESSAGE_COUNT; i++) {
+      auto dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(i % DIALOG_COUNT + 1)));
+      auto message_id = td::MessageId(td::ServerMessageId(i));
+      auto text = PSTRING() << "message " << td::Random::fast(1, 1000) << " text " << td::Random::fast(1, 1000);
+      message_db.add_message({dialog_id, message_id}, td::ServerMessageId(), dialog_id, 0, 0, 0, i, std::move(text),
+                             td::NotificationId(), td::MessageId(), td::BufferSlice(td::Random::fast(100, 299)));
+    }
+    message_db.commit_transaction().ensure();
+    message_db_async_ = td::create_message_db_async(message_db_sync_safe_, -1, read_scheduler_ids_);
+
+    start_time_ = td::Time::now();
+    running_query_count_ = searcher_count_ + 1;
+    for (int i = 0; i < searcher_count_; i++) {
+      search_messages();
+    }
+    get_messages();
+  }
+
+  bool on_query_finished() {
+    if (td::Time::now() > start_time_ + duration_) {
+      if (--running_query_count_ == 0) {
+        on_finished();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  void search_messages() {
+    if (on_query_finished()) {
+      return;
+    }
+    td::MessageDbFtsQuery query;
+    query.query = PSTRING() << "text " << td::Random::fast(1, 1000);
+    query.limit = 1000;
+    message_db_async_->get_messages_fts(std::move(query), td::PromiseCreator::lambda([actor_id = actor_id(this)](
+                                                                                         td::MessageDbFtsResult) {
+                                          send_closure(actor_id, &MessageDbReadLatencyBench::search_messages);
+                                        }));
+  }
+
+  void get_messages() {
+    if (on_query_finished()) {
+      return;
+    }
+    td::MessageDbMessagesQuery query;
+    query.dialog_id = td::DialogId(td::UserId(static_cast<td::int64>(td::Random::fast(1, DIALOG_COUNT))));
+    query.from_message_id = td::MessageId::max();
+    query.limit = 20;
+    message_db_async_->get_messages(
+        std::move(query), td::PromiseCreator::lambda([actor_id = actor_id(this), query_start_time = td::Time::now()](
+                                                         td::vector<td::MessageDbDialogMessage>) {
+          send_closure(actor_id, &MessageDbReadLatencyBench::on_get_messages, td::Time::now() - query_start_time);
+        }));
+  }
+
+  void on_get_messages(double latency) {
+    latencies_.push_back(latency);
+    get_messages();
+  }
+
+  void on_finished() {
+    std::sort(latencies_.begin(), latencies_.end());
+    auto get_percentile = [&](size_t percent) {
+      return latencies_[td::min(latencies_.size() - 1, latencies_.size() * percent / 100)] * 1e3;
+    };
+    LOG(WARNING) << "MessageDb get_messages with " << searcher_count_ << " concurrent searches and "
+                 << read_scheduler_ids_.size() << " read threads: " << latencies_.size() << " queries, p50 "
+                 << get_percentile(50) << " ms, p99 " << get_percentile(99) << " ms";
+    message_db_async_->close(td::PromiseCreator::lambda(
+        [actor_id = actor_id(this)](td::Unit) { send_closure(actor_id, &MessageDbReadLatencyBench::on_closed); }));
+  }
+
+  void on_closed() {
+    message_db_async_.reset();
+    message_db_sync_safe_.reset();
+    sql_connection_.reset();
+    td::Scheduler::instance()->finish();
+    stop();
+  }
+};
+
+static void bench_message_db_read_latency(int read_thread_count, int searcher_count) {
+  td::ConcurrentScheduler scheduler(read_thread_count, 0);
+  {
+    auto guard = scheduler.get_main_guard();
+    td::string sql_db_name = "testdb_read.sqlite";
+    td::SqliteDb::destroy(sql_db_name).ignore();
+    auto sql_connection = std::make_shared<td::SqliteConnectionSafe>(sql_db_name, td::DbKey::empty());
+    auto &db = sql_connection->get();
+    init_db(db).ensure();
+    db.exec("BEGIN TRANSACTION").ensure();
+    init_message_db(db, 0).ensure();
+    db.exec("COMMIT TRANSACTION").ensure();
+
+    td::vector<td::int32> read_scheduler_ids;
+    for (int i = 1; i <= read_thread_count; i++) {
+      read_scheduler_ids.push_back(i);
+    }
+    td::create_actor<MessageDbReadLatencyBench>("MessageDbReadLatencyBench", std::move(sql_connection),
+                                                std::move(read_scheduler_ids), searcher_count, 2.0)
+        .release();
+  }
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+  td::SqliteDb::destroy("testdb_read.sqlite").ignore();
+}
+
+// every producer adds an event and waits until it is synced before adding the next one
+class BinlogForceSyncBench final : public td::Actor {
+ public:
+  BinlogForceSyncBench(int producer_count, bool use_group_commit, double duration)
+      : producer_count_(producer_count), use_group_commit_(use_group_commit), duration_(duration) {
+  }
+
+ private:
+  int producer_count_;
+  bool use_group_commit_;
+  double duration_;
+  int running_producer_count_ = 0;
+  double start_time_ = 0;
+  std::shared_ptr<td::ConcurrentBinlog> binlog_;
+  td::string data_ = td::string(64, 'a');
+
+  void start_up() final {
+    td::string binlog_name = "test_binlog_sync";
+    td::Binlog::destroy(binlog_name).ignore();
+    binlog_ = std::make_shared<td::ConcurrentBinlog>();
+    binlog_->init(binlog_name, [](const td::BinlogEvent &) {}, td::DbKey::empty(), td::DbKey::empty(), 1).ensure();
+    if (use_group_commit_) {
+      binlog_->enable_group_commit(0.0);
+    }
+
+    start_time_ = td::Time::now();
+    running_producer_count_ = producer_count_;
+    for (int i = 0; i < producer_count_; i++) {
+      add_event(i);
+    }
+  }
+
+  void add_event(int producer_id) {
+    if (td::Time::now() > start_time_ + duration_) {
+      if (--running_producer_count_ == 0) {
+        on_finished();
+      }
+      return;
+    }
+    binlog_->add(1, td::create_storer(data_), td::Promise<td::Unit>());
+    binlog_->force_sync(td::PromiseCreator::lambda([actor_id = actor_id(this), producer_id](td::Unit) {
+                          send_closure(actor_id, &BinlogForceSyncBench::add_event, producer_id);
+                        }),
+                        "bench");
+  }
+
+  void on_finished() {
+    binlog_->get_stats(td::PromiseCreator::lambda([actor_id = actor_id(this)](td::Result<td::BinlogStats> r_stats) {
+      send_closure(actor_id, &BinlogForceSyncBench::on_get_stats, r_stats.move_as_ok());
+    }));
+  }
+
+  void on_get_stats(td::BinlogStats stats) {
+    auto passed_time = td::Time::now() - start_time_;
+    LOG(WARNING) << "ConcurrentBinlog force_sync with " << producer_count_ << " producers"
+                 << (use_group_commit_ ? " and group commit" : "") << ": "
+                 << static_cast<double>(stats.event_count) / passed_time << " events/s, "
+                 << static_cast<double>(stats.sync_count) / passed_time << " fsyncs/s";
+    binlog_->close_and_destroy(td::PromiseCreator::lambda(
+        [actor_id = actor_id(this)](td::Unit) { send_closure(actor_id, &BinlogForceSyncBench::on_closed); }));
+  }
+
+  void on_closed() {
+    binlog_.reset();
+    td::Scheduler::instance()->finish();
+    stop();
+  }
+};
+
+static void bench_binlog_force_sync(int producer_count, bool use_group_commit) {
+  td::ConcurrentScheduler scheduler(1, 0);
+  scheduler.create_actor_unsafe<BinlogForceSyncBench>(0, "BinlogForceSyncBench", producer_count, use_group_commit, 1.0)
+      .release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+}
+
+// measures time needed to open a binlog with many live events on startup
+class BinlogLoadBench final : public td::Benchmark {
+ public:
+  BinlogLoadBench(int event_count, bool is_encrypted) : event_count_(event_count), is_encrypted_(is_encrypted) {
+  }
+
+  td::string get_description() const final {
+    return PSTRING() << "BinlogLoad(" << event_count_ << " events" << (is_encrypted_ ? ", encrypted" : "") << ')';
+  }
+
+  void start_up() final {
+    td::Binlog::destroy(binlog_name_).ignore();
+    td::Binlog binlog;
+    binlog.init(binlog_name_, [](const td::BinlogEvent &) {}, get_db_key()).ensure();
+    for (int i = 0; i < event_count_; i++) {
+      auto data = td::string(td::Random::fast(1, 64) * 4, 'a');
+      binlog.add(1, td::create_storer(data));
+    }
+    binlog.close().ensure();
+  }
+
+  void run(int n) final {
+    for (int i = 0; i < n; i++) {
+      int loaded_event_count = 0;
+      td::Binlog binlog;
+      binlog.init(binlog_name_, [&](const td::BinlogEvent &) { loaded_event_count++; }, get_db_key()).ensure();
+      CHECK(loaded_event_count == event_count_);
+      binlog.close(false).ensure();
+    }
+  }
+
+  void tear_down() final {
+    td::Binlog::destroy(binlog_name_).ignore();
+  }
+
+ private:
+  int event_count_;
+  bool is_encrypted_;
+  td::string binlog_name_ = "test_binlog_load";
+
+  td::DbKey get_db_key() const {
+    return is_encrypted_ ? td::DbKey::raw_key(td::string(32, 'k')) : td::DbKey::empty();
+  }
+};
+
 int main() {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
   td::bench(MessageDbBench());
+
+  for (auto is_encrypted : {false, true}) {
+    td::bench(BinlogLoadBench(300000, is_encrypted));
+  }
+
+  for (auto read_thread_count : {0, 3}) {
+    bench_message_db_read_latency(read_thread_count, 4);
+  }
+
+  for (auto producer_count : {1, 16, 256}) {
+    for (auto use_group_commit : {false, true}) {
+      bench_binlog_force_sync(producer_count, use_group_commit);
+    }
+  }
 }
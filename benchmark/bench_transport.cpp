@@ -0,0 +1,133 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/mtproto/ProxySecret.h"
+#include "td/mtproto/TcpTransport.h"
+
+#include "td/utils/benchmark.h"
+#include "td/utils/buffer.h"
+#include "td/utils/BufferedFd.h"
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/port/detail/PollableFd.h"
+#include "td/utils/port/IPAddress.h"
+#include "td/utils/port/PollFlags.h"
+#include "td/utils/port/ServerSocketFd.h"
+#include "td/utils/port/SocketFd.h"
+#include "td/utils/port/sleep.h"
+#include "td/utils/port/thread.h"
+#include "td/utils/Random.h"
+#include "td/utils/Slice.h"
+#include "td/utils/SliceBuilder.h"
+
+#include <atomic>
+
+#if !TD_THREAD_UNSUPPORTED
+
+// sends packets of the given size in bursts through ObfuscatedTransport to a loopback TCP connection,
+// which is drained by a separate thread
+class TransportWriteBench final : public td::Benchmark {
+ public:
+  TransportWriteBench(size_t packet_size, int burst_size, bool emulate_tls)
+      : packet_size_(packet_size), burst_size_(burst_size), emulate_tls_(emulate_tls) {
+  }
+
+ private:
+  size_t packet_size_;
+  int burst_size_;
+  bool emulate_tls_;
+
+  td::unique_ptr<td::mtproto::tcp::ObfuscatedTransport> transport_;
+  td::BufferedFd<td::SocketFd> fd_;
+  td::thread reader_thread_;
+  std::atomic<bool> is_closed_{false};
+
+  td::string get_description() const final {
+    return PSTRING() << "ObfuscatedTransport" << (emulate_tls_ ? " with TLS" : "") << " write of " << packet_size_
+                     << "-byte packets in bursts of " << burst_size_;
+  }
+
+  void start_up() final {
+    td::ServerSocketFd server_fd;
+    td::int32 port = 0;
+    for (int i = 0; i < 100 && server_fd.empty(); i++) {
+      port = td::Random::fast(20000, 60000);
+      auto r_server_fd = td::ServerSocketFd::open(port, "127.0.0.1");
+      if (r_server_fd.is_ok()) {
+        server_fd = r_server_fd.move_as_ok();
+      }
+    }
+    CHECK(!server_fd.empty());
+
+    td::IPAddress address;
+    address.init_ipv4_port("127.0.0.1", port).ensure();
+    fd_ = td::BufferedFd<td::SocketFd>(td::SocketFd::open(address).move_as_ok());
+
+    td::SocketFd peer_fd;
+    while (peer_fd.empty()) {
+      server_fd.get_poll_info().add_flags(td::PollFlags::Read());
+      auto r_peer_fd = server_fd.accept();
+      if (r_peer_fd.is_ok()) {
+        peer_fd = r_peer_fd.move_as_ok();
+      }
+    }
+
+    is_closed_ = false;
+    reader_thread_ = td::thread([peer_fd = std::move(peer_fd), &is_closed = is_closed_]() mutable {
+      td::string buf(1 << 16, '\0');
+      while (!is_closed.load(std::memory_order_relaxed)) {
+        peer_fd.get_poll_info().add_flags(td::PollFlags::Read());
+        auto r_size = peer_fd.read(buf);
+        if (r_size.is_error()) {
+          break;
+        }
+        if (r_size.ok() == 0) {
+          td::usleep_for(1);
+        }
+      }
+    });
+
+    auto secret = emulate_tls_ ? td::mtproto::ProxySecret::from_raw(td::string(17, '\xee') + "example.com")
+                               : td::mtproto::ProxySecret();
+    transport_ = td::make_unique<td::mtproto::tcp::ObfuscatedTransport>(static_cast<td::int16>(2), std::move(secret));
+    transport_->init(&fd_.input_buffer(), &fd_.output_buffer());
+  }
+
+  void run(int n) final {
+    td::string data(packet_size_, 'a');
+    for (int i = 0; i < n; i += burst_size_) {
+      for (int j = 0; j < burst_size_; j++) {
+        transport_->write(
+            td::BufferWriter(data, transport_->max_prepend_size(), transport_->max_append_size()), false);
+      }
+      transport_->flush_write();
+      while (fd_.need_flush_write()) {
+        fd_.get_poll_info().add_flags(td::PollFlags::Write());
+        fd_.flush_write().ensure();
+      }
+    }
+  }
+
+  void tear_down() final {
+    is_closed_ = true;
+    reader_thread_.join();
+    transport_ = nullptr;
+    fd_.close();
+  }
+};
+
+#endif
+
+int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+#if !TD_THREAD_UNSUPPORTED
+  for (auto emulate_tls : {false, true}) {
+    for (auto burst_size : {1, 16}) {
+      td::bench(TransportWriteBench(64, burst_size, emulate_tls));
+    }
+  }
+#endif
+}
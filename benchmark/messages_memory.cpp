@@ -0,0 +1,112 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/MessageId.h"
+#include "td/telegram/OrderedMessage.h"
+
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/Stat.h"
+#include "td/utils/Random.h"
+#include "td/utils/Slice.h"
+#include "td/utils/StringBuilder.h"
+
+static int mem_stat_i = -1;
+static int mem_stat_cur = 0;
+
+static bool use_os_memory() {
+  return mem_stat_i >= 0;
+}
+
+static td::uint64 get_memory() {
+  if (!use_os_memory()) {
+    return 0;
+  }
+  return td::mem_stat().ok().resident_size_;
+}
+
+enum class InsertOrder : td::int32 { Ascending, Descending, Random };
+
+static td::Slice get_insert_order_name(InsertOrder order) {
+  switch (order) {
+    case InsertOrder::Ascending:
+      return td::Slice("ascending");
+    case InsertOrder::Descending:
+      return td::Slice("descending");
+    case InsertOrder::Random:
+      return td::Slice("random");
+    default:
+      UNREACHABLE();
+      return td::Slice();
+  }
+}
+
+static td::vector<td::MessageId> gen_message_ids(std::size_t size, InsertOrder order) {
+  td::vector<td::MessageId> message_ids;
+  message_ids.reserve(size);
+  for (std::size_t i = 0; i < size; i++) {
+    auto server_message_id = order == InsertOrder::Descending ? size - i : i + 1;
+    message_ids.push_back(td::MessageId(static_cast<td::int64>(server_message_id) << 20));
+  }
+  if (order == InsertOrder::Random) {
+    td::Random::shuffle(message_ids);
+  }
+  return message_ids;
+}
+
+// measures the number of bytes used per cached message in dialog_count dialogs with message_count messages each
+static void measure(td::StringBuilder &sb, std::size_t dialog_count, std::size_t message_count, InsertOrder order) {
+  mem_stat_cur++;
+  if (mem_stat_i >= 0 && mem_stat_cur != mem_stat_i) {
+    return;
+  }
+  auto message_ids = gen_message_ids(message_count, order);
+  auto start_mem = get_memory();
+  td::vector<td::OrderedMessages> dialogs(dialog_count);
+  for (auto &ordered_messages : dialogs) {
+    for (auto message_id : message_ids) {
+      ordered_messages.insert(message_id, order != InsertOrder::Random, td::MessageId(), "measure");
+    }
+  }
+  auto used_mem = get_memory() - start_mem;
+
+  std::size_t allocated_mem = 0;
+  for (auto &ordered_messages : dialogs) {
+    allocated_mem += sizeof(ordered_messages) + ordered_messages.get_memory_usage();
+  }
+  auto total_message_count = static_cast<double>(dialog_count * message_count);
+  sb << "OrderedMessages " << get_insert_order_name(order) << " " << dialog_count << "x" << message_count
+     << ": allocated = " << static_cast<double>(allocated_mem) / total_message_count;
+  if (use_os_memory()) {
+    sb << ", os = " << static_cast<double>(used_mem) / total_message_count;
+  }
+  sb << ", ideal = " << sizeof(td::MessageId) << '\n';
+}
+
+int main(int argc, const char *argv[]) {
+  // Usage:
+  //  % benchmark/memory-ordered-messages
+  //  Number of benchmarks = 12
+  //  % for i in {1..12}; do ./benchmark/memory-ordered-messages $i; done
+  // resident memory size is measured only if a single benchmark is run, because freed memory isn't returned to OS
+  if (argc > 1) {
+    mem_stat_i = td::to_integer<td::int32>(td::Slice(argv[1]));
+  }
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  td::string big_buff(1 << 16, '\0');
+  td::StringBuilder sb(big_buff, false);
+  for (auto order : {InsertOrder::Ascending, InsertOrder::Descending, InsertOrder::Random}) {
+    measure(sb, 100000, 10, order);
+    measure(sb, 10000, 100, order);
+    measure(sb, 1000, 1000, order);
+    measure(sb, 1, 1000000, order);
+  }
+  LOG(PLAIN) << '\n' << sb.as_cslice() << '\n';
+  if (mem_stat_i <= 0) {
+    LOG(PLAIN) << "Number of benchmarks = " << mem_stat_cur << "\n";
+  }
+}
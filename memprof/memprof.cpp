@@ -151,6 +151,12 @@ std::size_t get_ht_size() {
   return ht_size.load();
 }
 
+static std::atomic<std::size_t> allocation_count{0};
+
+std::size_t get_allocation_count() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
 std::int32_t get_ht_pos(const Backtrace &bt, bool force = false) {
   auto hash = get_hash(bt);
   auto pos = static_cast<std::int32_t>(hash % ht.size());
@@ -228,6 +234,7 @@ static void *malloc_with_frame(std::size_t size, const Backtrace &frame) {
   info->magic = MALLOC_INFO_MAGIC;
   info->size = static_cast<std::int32_t>(size);
   info->ht_pos = get_ht_pos(frame);
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
 
   register_xalloc(info, +1);
 
@@ -319,6 +326,9 @@ double get_fast_backtrace_success_rate() {
 std::size_t get_ht_size() {
   return 0;
 }
+std::size_t get_allocation_count() {
+  return 0;
+}
 #endif
 
 std::size_t get_used_memory_size() {
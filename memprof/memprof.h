@@ -22,6 +22,7 @@ struct AllocInfo {
 
 bool is_memprof_on();
 std::size_t get_ht_size();
+std::size_t get_allocation_count();  // total number of allocations since start of the program
 double get_fast_backtrace_success_rate();
 void dump_alloc(const std::function<void(const AllocInfo &)> &func);
 std::size_t get_used_memory_size();
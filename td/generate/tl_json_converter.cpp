@@ -111,6 +111,36 @@ void gen_from_json_constructor(StringBuilder &sb, const T *constructor, bool is_
   }
 }
 
+template <class T>
+void gen_from_json_parser_constructor(StringBuilder &sb, const T *constructor, bool is_header) {
+  sb << "Status from_json(td_api::" << tl::simple::gen_cpp_name(constructor->name) << " &to, JsonParser &from)";
+  if (is_header) {
+    sb << ";\n\n";
+  } else {
+    sb << " {\n";
+    // the first value of a repeated field is used, as in JsonObject::extract_field
+    auto arg_count = constructor->args.size();
+    if (arg_count != 0) {
+      sb << "  bool is_parsed[" << arg_count << "] = {};\n";
+    }
+    sb << "  return from.read_object([&](Slice name) {\n";
+    for (size_t i = 0; i < arg_count; i++) {
+      auto &arg = constructor->args[i];
+      sb << "    if (name == \"" << tl::simple::gen_cpp_name(arg.name) << "\") {\n";
+      sb << "      if (is_parsed[" << i << "]) {\n";
+      sb << "        return from.skip_value();\n";
+      sb << "      }\n";
+      sb << "      is_parsed[" << i << "] = true;\n";
+      sb << "      return from_json" << (arg.type->type == tl::simple::Type::Bytes ? "_bytes" : "") << "(to."
+         << tl::simple::gen_cpp_field_name(arg.name) << ", from);\n";
+      sb << "    }\n";
+    }
+    sb << "    return from.skip_value();\n";
+    sb << "  });\n";
+    sb << "}\n\n";
+  }
+}
+
 void gen_from_json(StringBuilder &sb, const tl::simple::Schema &schema, bool is_header, Mode mode) {
   for (auto *custom_type : schema.custom_types) {
     if (!((custom_type->is_query_ && mode != Mode::Client) || (custom_type->is_result_ && mode != Mode::Server))) {
@@ -118,6 +148,7 @@ void gen_from_json(StringBuilder &sb, const tl::simple::Schema &schema, bool is_
     }
     for (auto *constructor : custom_type->constructors) {
       gen_from_json_constructor(sb, constructor, is_header);
+      gen_from_json_parser_constructor(sb, constructor, is_header);
     }
   }
   if (mode == Mode::Client) {
@@ -125,12 +156,13 @@ void gen_from_json(StringBuilder &sb, const tl::simple::Schema &schema, bool is_
   }
   for (auto *function : schema.functions) {
     gen_from_json_constructor(sb, function, is_header);
+    gen_from_json_parser_constructor(sb, function, is_header);
   }
 }
 
 using Vec = std::vector<std::pair<int32, std::string>>;
 void gen_tl_constructor_from_string(StringBuilder &sb, Slice name, const Vec &vec, bool is_header) {
-  sb << "Result<int32> tl_constructor_from_string(td_api::" << name << " *object, const std::string &str)";
+  sb << "Result<int32> tl_constructor_from_string(td_api::" << name << " *object, Slice str)";
   if (is_header) {
     sb << ";\n\n";
     return;
@@ -204,6 +236,7 @@ void gen_json_converter_file(const tl::simple::Schema &schema, const std::string
     sb << "#include \"td/telegram/td_api.h\"\n\n";
 
     sb << "#include \"td/utils/JsonBuilder.h\"\n";
+    sb << "#include \"td/utils/Slice.h\"\n";
     sb << "#include \"td/utils/Status.h\"\n\n";
   } else {
     sb << "#include \"" << file_name_base << ".h\"\n\n";
@@ -225,6 +258,7 @@ void gen_json_converter_file(const tl::simple::Schema &schema, const std::string
   if (is_header) {
     sb << "\nvoid to_json(JsonValueScope &jv, const tl_object_ptr<Object> &value);\n";
     sb << "\nStatus from_json(tl_object_ptr<Function> &to, td::JsonValue from);\n";
+    sb << "\nStatus from_json(tl_object_ptr<Function> &to, td::JsonParser &from);\n";
     sb << "\nvoid to_json(JsonValueScope &jv, const Object &object);\n";
     sb << "\nvoid to_json(JsonValueScope &jv, const Function &object);\n\n";
   } else {
@@ -237,6 +271,10 @@ Status from_json(tl_object_ptr<Function> &to, td::JsonValue from) {
   return td::from_json(to, std::move(from));
 }
 
+Status from_json(tl_object_ptr<Function> &to, td::JsonParser &from) {
+  return td::from_json(to, from);
+}
+
 template <class T>
 auto lazy_to_json(JsonValueScope &jv, const T &t) -> decltype(td_api::to_json(jv, t)) {
   return td_api::to_json(jv, t);
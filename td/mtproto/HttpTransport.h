@@ -32,6 +32,8 @@ class Transport final : public IStreamTransport {
     return false;
   }
   void write(BufferWriter &&message, bool quick_ack) final;
+  void flush_write() final {
+  }
   bool can_read() const final;
   bool can_write() const final;
   void init(ChainBufferReader *input, ChainBufferWriter *output) final {
@@ -25,6 +25,7 @@ class IStreamTransport {
   virtual Result<size_t> read_next(BufferSlice *message, uint32 *quick_ack) = 0;
   virtual bool support_quick_ack() const = 0;
   virtual void write(BufferWriter &&message, bool quick_ack) = 0;
+  virtual void flush_write() = 0;  // writes all buffered messages to the output stream
   virtual bool can_read() const = 0;
   virtual bool can_write() const = 0;
   virtual void init(ChainBufferReader *input, ChainBufferWriter *output) = 0;
@@ -125,6 +125,9 @@ class PingConnectionPingPong final
   void on_server_time_difference_updated(bool force) final {
   }
 
+  void on_min_gzipped_size_updated(size_t min_gzipped_size) final {
+  }
+
   void on_new_session_created(uint64 unique_id, MessageId first_message_id) final {
   }
 
@@ -0,0 +1,58 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/mtproto/QueryPackingPolicy.h"
+
+#include "td/utils/misc.h"
+
+namespace td {
+namespace mtproto {
+
+void QueryPackingPolicy::on_read(size_t size, double now) {
+  if (now - last_read_at_ > MAX_BURST_PAUSE) {
+    // the first packet of a burst could have been received long ago, so only the time after it is measured
+    burst_start_at_ = now;
+    burst_size_ = 0;
+  } else {
+    burst_size_ += size;
+    auto elapsed_time = now - burst_start_at_;
+    if (burst_size_ >= MIN_MEASURED_SIZE && elapsed_time >= MIN_MEASURED_TIME) {
+      auto speed = static_cast<double>(burst_size_) / elapsed_time;
+      bandwidth_ = bandwidth_ == 0.0 ? speed : 0.75 * bandwidth_ + 0.25 * speed;
+      burst_start_at_ = now;
+      burst_size_ = 0;
+    }
+  }
+  last_read_at_ = now;
+}
+
+double QueryPackingPolicy::get_flush_delay(double rtt) const {
+  // waiting for a small fraction of RTT is unnoticeable, but allows to send more queries in one packet
+  return clamp(rtt * options_.flush_delay_rtt_ratio, options_.min_flush_delay, options_.max_flush_delay);
+}
+
+size_t QueryPackingPolicy::get_max_container_size(double rtt) const {
+  if (bandwidth_ == 0.0 || rtt <= 0.0) {
+    return options_.default_container_size;
+  }
+  // a container must be sent in a quarter of RTT, otherwise the first query answer will be noticeably delayed
+  auto size = static_cast<size_t>(min(bandwidth_ * rtt * 0.25, static_cast<double>(options_.max_container_size)));
+  return clamp(size, options_.min_container_size, options_.max_container_size);
+}
+
+size_t QueryPackingPolicy::get_min_gzipped_size() const {
+  if (bandwidth_ == 0.0) {
+    return options_.min_gzipped_size;
+  }
+  // compression saves at least a half of the query size, i.e. size / 2 / bandwidth seconds,
+  // so it is worth only if the saved time is bigger than the fixed compression cost
+  auto size = static_cast<size_t>(min(2 * options_.gzip_fixed_cost * bandwidth_,
+                                      static_cast<double>(options_.max_gzipped_size)));
+  return clamp(size, options_.min_gzipped_size, options_.max_gzipped_size);
+}
+
+}  // namespace mtproto
+}  // namespace td
@@ -0,0 +1,64 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+namespace td {
+namespace mtproto {
+
+// Chooses how outgoing queries are packed into containers from RTT and download speed of a connection.
+// Download speed is estimated from bursts of received data, so it is a lower bound of the link bandwidth.
+class QueryPackingPolicy {
+ public:
+  struct Options {
+    double min_flush_delay = 0.001;  // delay before sending of the first query in a container
+    double max_flush_delay = 0.005;
+    double flush_delay_rtt_ratio = 0.005;
+
+    size_t min_container_size = 1 << 13;  // maximum total size of queries in a container
+    size_t max_container_size = 1 << 16;
+    size_t default_container_size = 1 << 15;  // used while bandwidth isn't known
+
+    size_t min_gzipped_size = 128;  // minimum size of a query, which is worth compressing
+    size_t max_gzipped_size = 1 << 14;
+    double gzip_fixed_cost = 5e-5;  // compression overhead, which doesn't depend on the query size, in seconds
+  };
+
+  QueryPackingPolicy() = default;
+
+  explicit QueryPackingPolicy(Options options) : options_(options) {
+  }
+
+  void on_read(size_t size, double now);
+
+  // returns estimated download speed in bytes per second or 0 if unknown
+  double get_bandwidth() const {
+    return bandwidth_;
+  }
+
+  double get_flush_delay(double rtt) const;
+
+  size_t get_max_container_size(double rtt) const;
+
+  size_t get_min_gzipped_size() const;
+
+ private:
+  static constexpr double MAX_BURST_PAUSE = 0.05;
+  static constexpr double MIN_MEASURED_TIME = 0.05;
+  static constexpr size_t MIN_MEASURED_SIZE = 1 << 16;
+
+  Options options_;
+
+  double bandwidth_ = 0.0;
+  double last_read_at_ = 0.0;
+  double burst_start_at_ = 0.0;
+  size_t burst_size_ = 0;
+};
+
+}  // namespace mtproto
+}  // namespace td
@@ -249,6 +249,7 @@ class RawConnectionDefault final : public RawConnection {
   }
 
   Status flush_write() {
+    transport_->flush_write();
     TRY_RESULT(size, socket_fd_.flush_write());
     if (size > 0 && stats_callback_) {
       stats_callback_->on_write(size);
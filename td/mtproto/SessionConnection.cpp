@@ -752,6 +752,7 @@ void SessionConnection::on_read(size_t size) {
   last_read_at_ = Time::now_cached();
   real_last_read_at_ = last_read_at_;
   last_read_size_ += size;
+  packing_policy_.on_read(size, last_read_at_);
 }
 
 SessionConnection::SessionConnection(Mode mode, unique_ptr<RawConnection> raw_connection, AuthData *auth_data)
@@ -817,7 +818,7 @@ Result<MessageId> SessionConnection::send_query(BufferSlice buffer, bool gzip_fl
   }
   auto seq_no = auth_data_->next_seq_no(true);
   if (to_send_.empty()) {
-    send_before(Time::now_cached() + QUERY_DELAY);
+    send_before(Time::now_cached() + packing_policy_.get_flush_delay(raw_connection_->extra().rtt));
   }
   to_send_.push_back(MtprotoQuery{message_id, seq_no, std::move(buffer), gzip_flag, std::move(invoke_after_message_ids),
                                   use_quick_ack});
@@ -949,8 +950,9 @@ void SessionConnection::flush_packet() {
   size_t send_till = 0;
   size_t send_size = 0;
   if (has_salt) {
-    // send at most MAX_QUERY_COUNT queries, of total size up to 2^15
-    while (send_till < to_send_.size() && send_till < MAX_QUERY_COUNT && send_size < (1 << 15)) {
+    // send at most MAX_QUERY_COUNT queries, of total size up to the size chosen by the packing policy
+    auto max_send_size = packing_policy_.get_max_container_size(raw_connection_->extra().rtt);
+    while (send_till < to_send_.size() && send_till < MAX_QUERY_COUNT && send_size < max_send_size) {
       send_size += to_send_[send_till].packet.size();
       send_till++;
     }
@@ -1095,6 +1097,13 @@ Status SessionConnection::do_flush() {
   if (result.is_error()) {
     return result;
   }
+  if (is_main_ && last_read_size_ != 0) {
+    auto min_gzipped_size = packing_policy_.get_min_gzipped_size();
+    if (min_gzipped_size != reported_min_gzipped_size_) {
+      reported_min_gzipped_size_ = min_gzipped_size;
+      callback_->on_min_gzipped_size_updated(min_gzipped_size);
+    }
+  }
 
   if (last_pong_at_ + ping_disconnect_delay() < Time::now_cached()) {
     auto stats_callback = raw_connection_->stats_callback();
@@ -9,6 +9,7 @@
 #include "td/mtproto/MessageId.h"
 #include "td/mtproto/MtprotoQuery.h"
 #include "td/mtproto/PacketInfo.h"
+#include "td/mtproto/QueryPackingPolicy.h"
 #include "td/mtproto/RawConnection.h"
 
 #include "td/utils/buffer.h"
@@ -94,6 +95,9 @@ class SessionConnection final
     virtual void on_server_salt_updated() = 0;
     virtual void on_server_time_difference_updated(bool force) = 0;
 
+    // called by main connections only
+    virtual void on_min_gzipped_size_updated(size_t min_gzipped_size) = 0;
+
     virtual void on_new_session_created(uint64 unique_id, MessageId first_message_id) = 0;
     virtual void on_session_failed(Status status) = 0;
 
@@ -119,7 +123,6 @@ class SessionConnection final
 
  private:
   static constexpr int ACK_DELAY = 30;                  // 30s
-  static constexpr double QUERY_DELAY = 0.001;          // 0.001s
   static constexpr double RESEND_ANSWER_DELAY = 0.001;  // 0.001s
 
   struct MsgInfo {
@@ -163,6 +166,8 @@ class SessionConnection final
   vector<MtprotoQuery> to_send_;
   vector<MessageId> to_ack_message_ids_;
   double force_send_at_ = 0;
+  QueryPackingPolicy packing_policy_;
+  size_t reported_min_gzipped_size_ = 0;
 
   struct ServiceQuery {
     enum Type { GetStateInfo, ResendAnswer } type_;
@@ -153,6 +153,44 @@ Result<size_t> ObfuscatedTransport::read_next(BufferSlice *message, uint32 *quic
 
 void ObfuscatedTransport::write(BufferWriter &&message, bool quick_ack) {
   impl_.write_prepare_inplace(&message, quick_ack);
+  if (message.size() > MAX_COALESCED_MESSAGE_SIZE) {
+    flush_write();
+    return do_write_encrypted(std::move(message));
+  }
+
+  if (pending_size_ + message.size() > MAX_COALESCED_BATCH_SIZE) {
+    flush_write();
+  }
+  pending_size_ += message.size();
+  pending_messages_.push_back(std::move(message));
+}
+
+void ObfuscatedTransport::flush_write() {
+  if (pending_messages_.empty()) {
+    return;
+  }
+  if (pending_messages_.size() == 1) {
+    auto message = std::move(pending_messages_[0]);
+    pending_messages_.clear();
+    pending_size_ = 0;
+    return do_write_encrypted(std::move(message));
+  }
+
+  // the messages are copied into one buffer to encrypt them in one pass and to write them in a minimum number
+  // of TLS records
+  BufferWriter batch(pending_size_, max_prepend_size(), 0);
+  auto data = batch.as_mutable_slice();
+  for (auto &message : pending_messages_) {
+    data.copy_from(message.as_slice());
+    data.remove_prefix(message.size());
+  }
+  CHECK(data.empty());
+  pending_messages_.clear();
+  pending_size_ = 0;
+  do_write_encrypted(std::move(batch));
+}
+
+void ObfuscatedTransport::do_write_encrypted(BufferWriter &&message) {
   output_state_.encrypt(message.as_slice(), message.as_mutable_slice());
   if (secret_.emulate_tls()) {
     do_write_tls(std::move(message));
@@ -63,6 +63,8 @@ class OldTransport final : public IStreamTransport {
     impl_.write_prepare_inplace(&message, quick_ack);
     output_->append(message.as_buffer_slice());
   }
+  void flush_write() final {
+  }
   void init(ChainBufferReader *input, ChainBufferWriter *output) final {
     input_ = input;
     output_ = output;
@@ -111,6 +113,8 @@ class ObfuscatedTransport final : public IStreamTransport {
 
   void write(BufferWriter &&message, bool quick_ack) final;
 
+  void flush_write() final;
+
   void init(ChainBufferReader *input, ChainBufferWriter *output) final;
 
   bool can_read() const final {
@@ -161,6 +165,12 @@ class ObfuscatedTransport final : public IStreamTransport {
 
   static constexpr int32 MAX_TLS_PACKET_LENGTH = 2878;
 
+  // small messages are buffered until flush_write, and then are encrypted and written together
+  static constexpr size_t MAX_COALESCED_MESSAGE_SIZE = 1 << 12;
+  static constexpr size_t MAX_COALESCED_BATCH_SIZE = 1 << 16;
+  vector<BufferWriter> pending_messages_;
+  size_t pending_size_ = 0;
+
   // TODO: use ByteFlow?
   // One problem is that BufferedFd owns output_buffer_
   // The other problem is that first 56 bytes must be sent unencrypted.
@@ -168,6 +178,7 @@ class ObfuscatedTransport final : public IStreamTransport {
   AesCtrState output_state_;
   ChainBufferWriter *output_ = nullptr;
 
+  void do_write_encrypted(BufferWriter &&message);
   void do_write_tls(BufferWriter &&message);
   void do_write_tls(BufferBuilder &&builder);
   void do_write_main(BufferWriter &&message);
@@ -37,6 +37,8 @@
 
 namespace td {
 
+static std::atomic<bool> is_work_stealing_enabled{false};
+
 #if TD_THREAD_UNSUPPORTED || TD_EVENTFD_UNSUPPORTED
 class TdReceiver {
  public:
@@ -171,6 +173,30 @@ class ClientManager::Impl final {
     return response;
   }
 
+  bool set_thread_pool_options(ThreadPoolOptions options) {
+    return false;
+  }
+
+  bool set_client_thread_pool(ClientId client_id, int32 pool_id) {
+    return false;
+  }
+
+  vector<ThreadPoolStats> get_thread_pool_stats() {
+    return {};
+  }
+
+  vector<Response> receive_batch(int32 max_count, double timeout) {
+    vector<Response> responses;
+    while (static_cast<int32>(responses.size()) < max_count) {
+      auto response = receive(responses.empty() ? timeout : 0.0);
+      if (response.object == nullptr) {
+        break;
+      }
+      responses.push_back(std::move(response));
+    }
+    return responses;
+  }
+
   Impl() = default;
   Impl(const Impl &) = delete;
   Impl &operator=(const Impl &) = delete;
@@ -278,23 +304,31 @@ class TdReceiver {
 
   ClientManager::Response receive(double timeout, bool from_manager) {
     VLOG(td_requests) << "Begin to wait for updates with timeout " << timeout;
-    auto is_locked = receive_lock_.exchange(true);
-    if (is_locked) {
-      if (from_manager) {
-        LOG(FATAL) << "Receive must not be called simultaneously from two different threads, but this has just "
-                      "happened. Call it from a fixed thread, dedicated for updates and response processing.";
-      } else {
-        LOG(FATAL) << "Receive is called after Client destroy, or simultaneously from different threads";
-      }
-    }
+    lock_receive(from_manager);
     auto response = receive_unlocked(clamp(timeout, 0.0, 1000000.0));
-    is_locked = receive_lock_.exchange(false);
-    CHECK(is_locked);
+    unlock_receive();
     VLOG(td_requests) << "End to wait for updates, returning object " << response.request_id << ' '
                       << response.object.get();
     return response;
   }
 
+  vector<ClientManager::Response> receive_batch(int32 max_count, double timeout, bool from_manager) {
+    VLOG(td_requests) << "Begin to wait for at most " << max_count << " updates with timeout " << timeout;
+    vector<ClientManager::Response> responses;
+    lock_receive(from_manager);
+    auto response = receive_unlocked(clamp(timeout, 0.0, 1000000.0));
+    while (response.client_id != 0 || response.object != nullptr) {
+      responses.push_back(std::move(response));
+      if (static_cast<int32>(responses.size()) >= max_count) {
+        break;
+      }
+      response = receive_unlocked(0);
+    }
+    unlock_receive();
+    VLOG(td_requests) << "End to wait for updates, returning " << responses.size() << " objects";
+    return responses;
+  }
+
   unique_ptr<TdCallback> create_callback(ClientManager::ClientId client_id) {
     class Callback final : public TdCallback {
      public:
@@ -332,6 +366,23 @@ class TdReceiver {
   int output_queue_ready_cnt_{0};
   std::atomic<bool> receive_lock_{false};
 
+  void lock_receive(bool from_manager) {
+    auto is_locked = receive_lock_.exchange(true);
+    if (is_locked) {
+      if (from_manager) {
+        LOG(FATAL) << "Receive must not be called simultaneously from two different threads, but this has just "
+                      "happened. Call it from a fixed thread, dedicated for updates and response processing.";
+      } else {
+        LOG(FATAL) << "Receive is called after Client destroy, or simultaneously from different threads";
+      }
+    }
+  }
+
+  void unlock_receive() {
+    auto is_locked = receive_lock_.exchange(false);
+    CHECK(is_locked);
+  }
+
   ClientManager::Response receive_unlocked(double timeout) {
     if (output_queue_ready_cnt_ == 0) {
       output_queue_ready_cnt_ = output_queue_->reader_wait_nonblock();
@@ -352,8 +403,10 @@ class MultiImpl {
  public:
   static constexpr int32 ADDITIONAL_THREAD_COUNT = 3;
 
-  explicit MultiImpl(std::shared_ptr<NetQueryStats> net_query_stats) {
-    concurrent_scheduler_ = std::make_shared<ConcurrentScheduler>(ADDITIONAL_THREAD_COUNT, 0);
+  MultiImpl(std::shared_ptr<NetQueryStats> net_query_stats, int32 additional_thread_count, uint64 thread_affinity_mask)
+      : additional_thread_count_(additional_thread_count) {
+    concurrent_scheduler_ = std::make_shared<ConcurrentScheduler>(additional_thread_count, thread_affinity_mask,
+                                                                  is_work_stealing_enabled.load());
     concurrent_scheduler_->start();
 
     {
@@ -363,7 +416,14 @@ class MultiImpl {
       multi_td_ = create_actor<MultiTd>("MultiTd", std::move(options));
     }
 
-    scheduler_thread_ = thread([concurrent_scheduler = concurrent_scheduler_] {
+    scheduler_thread_ = thread([concurrent_scheduler = concurrent_scheduler_, thread_affinity_mask] {
+#if TD_HAVE_THREAD_AFFINITY
+      if (thread_affinity_mask != 0) {
+        thread::set_affinity_mask(this_thread::get_id(), thread_affinity_mask).ignore();
+      }
+#else
+      (void)thread_affinity_mask;
+#endif
       while (concurrent_scheduler->run_main(10)) {
       }
     });
@@ -391,6 +451,7 @@ class MultiImpl {
 
   void send(ClientManager::ClientId client_id, ClientManager::RequestId request_id,
             td_api::object_ptr<td_api::Function> &&request) {
+    request_count_.fetch_add(1, std::memory_order_relaxed);
     auto guard = concurrent_scheduler_->get_send_guard();
     send_closure(multi_td_, &MultiTd::send, client_id, request_id, std::move(request));
   }
@@ -401,6 +462,18 @@ class MultiImpl {
     send_closure(multi_td_, &MultiTd::close, client_id);
   }
 
+  int32 get_thread_count() const {
+    return get_thread_count(additional_thread_count_);
+  }
+
+  static int32 get_thread_count(int32 additional_thread_count) {
+    return 1 + additional_thread_count + 1 /* IOCP */;
+  }
+
+  uint64 get_request_count() const {
+    return request_count_.load(std::memory_order_relaxed);
+  }
+
   ~MultiImpl() {
     {
       auto guard = concurrent_scheduler_->get_send_guard();
@@ -416,6 +489,8 @@ class MultiImpl {
   }
 
  private:
+  int32 additional_thread_count_;
+  std::atomic<uint64> request_count_{0};
   std::shared_ptr<ConcurrentScheduler> concurrent_scheduler_;
   thread scheduler_thread_;
   ActorOwn<MultiTd> multi_td_;
@@ -428,30 +503,97 @@ std::atomic<uint32> MultiImpl::current_id_{1};
 
 class MultiImplPool {
  public:
-  std::shared_ptr<MultiImpl> get() {
+  // the pool is chosen automatically
+  static constexpr int32 ANY_POOL = -2;
+
+  bool set_options(ClientManager::ThreadPoolOptions options) {
+    if (options.pool_count < 0 || options.additional_thread_count < 0) {
+      return false;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!impls_.empty()) {
+      return false;
+    }
+    options_ = std::move(options);
+    return true;
+  }
+
+  bool is_valid_pool_id(int32 pool_id) {
+    if (pool_id == ClientManager::DEDICATED_THREAD_POOL) {
+      return true;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    return 0 <= pool_id && pool_id < get_pool_count();
+  }
+
+  std::shared_ptr<MultiImpl> get(int32 pool_id = ANY_POOL) {
     std::unique_lock<std::mutex> lock(mutex_);
     if (impls_.empty()) {
       init_openssl_threads();
 
-      auto max_client_threads = clamp(thread::hardware_concurrency(), 8u, 20u) * 5 / 4;
-#if TD_OPENBSD
-      max_client_threads = td::min(max_client_threads, 4u);
-#endif
-      impls_.resize(max_client_threads);
-      CHECK(impls_.size() * (1 + MultiImpl::ADDITIONAL_THREAD_COUNT + 1 /* IOCP */) < 128);
-
+      impls_.resize(get_pool_count());
       net_query_stats_ = std::make_shared<NetQueryStats>();
     }
-    auto &impl = *std::min_element(impls_.begin(), impls_.end(),
-                                   [](auto &a, auto &b) { return a.lock().use_count() < b.lock().use_count(); });
+
+    if (pool_id == ClientManager::DEDICATED_THREAD_POOL) {
+      td::remove_if(dedicated_impls_, [](const auto &dedicated_impl) { return dedicated_impl.second.expired(); });
+      auto additional_thread_count = get_additional_thread_count();
+      auto thread_count = MultiImpl::get_thread_count(additional_thread_count) * static_cast<int32>(impls_.size());
+      for (auto &dedicated_impl : dedicated_impls_) {
+        auto impl = dedicated_impl.second.lock();
+        if (impl != nullptr) {
+          thread_count += impl->get_thread_count();
+        }
+      }
+      if (thread_count + MultiImpl::get_thread_count(additional_thread_count) < MAX_THREAD_COUNT) {
+        auto dedicated_pool_id = static_cast<int32>(impls_.size()) + next_dedicated_pool_id_++;
+        auto result = std::make_shared<MultiImpl>(net_query_stats_, additional_thread_count,
+                                                  get_thread_affinity_mask(dedicated_pool_id));
+        dedicated_impls_.emplace_back(dedicated_pool_id, result);
+        return result;
+      }
+      LOG(WARNING) << "Can't create a dedicated thread pool, because there are too many threads";
+    }
+
+    auto &impl = 0 <= pool_id && static_cast<size_t>(pool_id) < impls_.size()
+                     ? impls_[pool_id]
+                     : *std::min_element(impls_.begin(), impls_.end(), [](auto &a, auto &b) {
+                         return a.lock().use_count() < b.lock().use_count();
+                       });
     auto result = impl.lock();
     if (!result) {
-      result = std::make_shared<MultiImpl>(net_query_stats_);
+      auto impl_pool_id = static_cast<int32>(&impl - &impls_[0]);
+      result = std::make_shared<MultiImpl>(net_query_stats_, get_additional_thread_count(),
+                                           get_thread_affinity_mask(impl_pool_id));
       impl = result;
     }
     return result;
   }
 
+  vector<ClientManager::ThreadPoolStats> get_stats() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    vector<ClientManager::ThreadPoolStats> result;
+    auto add_stats = [&result](int32 pool_id, bool is_dedicated, const std::weak_ptr<MultiImpl> &weak_impl) {
+      ClientManager::ThreadPoolStats stats{pool_id, is_dedicated, 0, 0, 0};
+      auto impl = weak_impl.lock();
+      if (impl != nullptr) {
+        stats.thread_count = impl->get_thread_count();
+        stats.client_count = narrow_cast<int32>(impl.use_count() - 1);
+        stats.request_count = impl->get_request_count();
+      }
+      result.push_back(stats);
+    };
+    for (size_t i = 0; i < impls_.size(); i++) {
+      add_stats(static_cast<int32>(i), false, impls_[i]);
+    }
+    for (auto &dedicated_impl : dedicated_impls_) {
+      if (!dedicated_impl.second.expired()) {
+        add_stats(dedicated_impl.first, true, dedicated_impl.second);
+      }
+    }
+    return result;
+  }
+
   void try_clear() {
     std::unique_lock<std::mutex> lock(mutex_);
     if (impls_.empty()) {
@@ -463,7 +605,14 @@ class MultiImplPool {
         return;
       }
     }
+    for (auto &dedicated_impl : dedicated_impls_) {
+      if (!dedicated_impl.second.expired()) {
+        return;
+      }
+    }
     reset_to_empty(impls_);
+    reset_to_empty(dedicated_impls_);
+    next_dedicated_pool_id_ = 0;
 
     CHECK(net_query_stats_.use_count() == 1);
     CHECK(net_query_stats_->get_count() == 0);
@@ -471,11 +620,45 @@ class MultiImplPool {
   }
 
  private:
+  static constexpr int32 MAX_THREAD_COUNT = 128;
+
   std::mutex mutex_;
+  ClientManager::ThreadPoolOptions options_;
   std::vector<std::weak_ptr<MultiImpl>> impls_;
+  std::vector<std::pair<int32, std::weak_ptr<MultiImpl>>> dedicated_impls_;
+  int32 next_dedicated_pool_id_ = 0;
   std::shared_ptr<NetQueryStats> net_query_stats_;
+
+  int32 get_additional_thread_count() const {
+    if (options_.additional_thread_count > 0) {
+      return td::min(options_.additional_thread_count, MAX_THREAD_COUNT / 2);
+    }
+    return MultiImpl::ADDITIONAL_THREAD_COUNT;
+  }
+
+  int32 get_pool_count() const {
+    auto pool_count = options_.pool_count;
+    if (pool_count <= 0) {
+      pool_count = static_cast<int32>(clamp(thread::hardware_concurrency(), 8u, 20u) * 5 / 4);
+#if TD_OPENBSD
+      pool_count = td::min(pool_count, 4);
+#endif
+    }
+    auto max_pool_count = (MAX_THREAD_COUNT - 1) / MultiImpl::get_thread_count(get_additional_thread_count());
+    return clamp(pool_count, 1, max_pool_count);
+  }
+
+  uint64 get_thread_affinity_mask(int32 pool_id) const {
+    if (options_.thread_affinity_masks.empty()) {
+      return 0;
+    }
+    return options_.thread_affinity_masks[static_cast<size_t>(pool_id) % options_.thread_affinity_masks.size()];
+  }
 };
 
+constexpr int32 MultiImplPool::ANY_POOL;
+constexpr int32 MultiImplPool::MAX_THREAD_COUNT;
+
 class ClientManager::Impl final {
  public:
   ClientId create_client_id() {
@@ -503,7 +686,7 @@ class ClientManager::Impl final {
       auto write_lock = impls_mutex_.lock_write().move_as_ok();
       it = impls_.find(client_id);
       if (it != impls_.end() && it->second.impl == nullptr) {
-        it->second.impl = pool_.get();
+        it->second.impl = pool_.get(it->second.pool_id);
         it->second.impl->create(client_id, receiver_.create_callback(client_id));
       }
       write_lock.reset();
@@ -518,8 +701,43 @@ class ClientManager::Impl final {
     it->second.impl->send(client_id, request_id, std::move(request));
   }
 
+  bool set_thread_pool_options(ThreadPoolOptions options) {
+    return pool_.set_options(std::move(options));
+  }
+
+  bool set_client_thread_pool(ClientId client_id, int32 pool_id) {
+    if (!pool_.is_valid_pool_id(pool_id)) {
+      return false;
+    }
+    auto lock = impls_mutex_.lock_write().move_as_ok();
+    auto it = impls_.find(client_id);
+    if (it == impls_.end() || it->second.impl != nullptr || it->second.is_closed) {
+      return false;
+    }
+    it->second.pool_id = pool_id;
+    return true;
+  }
+
+  vector<ThreadPoolStats> get_thread_pool_stats() {
+    return pool_.get_stats();
+  }
+
   Response receive(double timeout) {
     auto response = receiver_.receive(timeout, true);
+    on_response(response);
+    return response;
+  }
+
+  vector<Response> receive_batch(int32 max_count, double timeout) {
+    auto responses = receiver_.receive_batch(max_count, timeout, true);
+    for (auto &response : responses) {
+      on_response(response);
+    }
+    td::remove_if(responses, [](const Response &response) { return response.object == nullptr; });
+    return responses;
+  }
+
+  void on_response(Response &response) {
     if (response.request_id == 0 && response.object != nullptr &&
         response.object->get_id() == td_api::updateAuthorizationState::ID &&
         static_cast<const td_api::updateAuthorizationState *>(response.object.get())->authorization_state_->get_id() ==
@@ -546,7 +764,6 @@ class ClientManager::Impl final {
         pool_.try_clear();
       }
     }
-    return response;
   }
 
   void close_impl(ClientId client_id) {
@@ -585,6 +802,7 @@ class ClientManager::Impl final {
   RwMutex impls_mutex_;
   struct MultiImplInfo {
     std::shared_ptr<MultiImpl> impl;
+    int32 pool_id = MultiImplPool::ANY_POOL;
     bool is_closed = false;
   };
   FlatHashMap<ClientId, MultiImplInfo> impls_;
@@ -679,6 +897,11 @@ ClientManager::Response ClientManager::receive(double timeout) {
   return impl_->receive(timeout);
 }
 
+std::vector<ClientManager::Response> ClientManager::receive_batch(int32 max_count, double timeout) {
+  CHECK(max_count > 0);
+  return impl_->receive_batch(max_count, timeout);
+}
+
 td_api::object_ptr<td_api::Object> ClientManager::execute(td_api::object_ptr<td_api::Function> &&request) {
   return Td::static_request(std::move(request));
 }
@@ -713,6 +936,24 @@ void ClientManager::set_log_message_callback(int max_verbosity_level, LogMessage
   }
 }
 
+void ClientManager::set_work_stealing_enabled(bool is_enabled) {
+  is_work_stealing_enabled = is_enabled;
+}
+
+bool ClientManager::set_thread_pool_options(ThreadPoolOptions options) {
+  return impl_->set_thread_pool_options(std::move(options));
+}
+
+constexpr int32 ClientManager::DEDICATED_THREAD_POOL;
+
+bool ClientManager::set_client_thread_pool(ClientId client_id, int32 pool_id) {
+  return impl_->set_client_thread_pool(client_id, pool_id);
+}
+
+std::vector<ClientManager::ThreadPoolStats> ClientManager::get_thread_pool_stats() {
+  return impl_->get_thread_pool_stats();
+}
+
 ClientManager::ClientManager(ClientManager &&) noexcept = default;
 ClientManager &ClientManager::operator=(ClientManager &&) noexcept = default;
 ClientManager::~ClientManager() = default;
@@ -13,6 +13,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace td {
 
@@ -115,6 +116,16 @@ class ClientManager final {
    */
   Response receive(double timeout);
 
+  /**
+   * Receives several incoming updates and responses to requests from TDLib at once. May be called from any thread, but
+   * must not be called simultaneously with ClientManager::receive or ClientManager::receive_batch from another thread.
+   * Waits only for the first response; all other already received responses are returned without waiting.
+   * \param[in] max_count The maximum number of responses to return. Must be positive.
+   * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+   * \return Incoming updates and responses to requests in the order they were received. Empty if the timeout expires.
+   */
+  std::vector<Response> receive_batch(std::int32_t max_count, double timeout);
+
   /**
    * Synchronously executes a TDLib request.
    * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
@@ -144,6 +155,98 @@ class ClientManager final {
    */
   static void set_log_message_callback(int max_verbosity_level, LogMessageCallbackPtr callback);
 
+  /**
+   * Enables or disables running of stateless work, for example, parsing of received updates, on any idle TDLib thread
+   * instead of the thread of the TDLib instance. Changes only threads, which will be started after the call.
+   * By default the work stealing is disabled.
+   *
+   * \param[in] is_enabled Pass true to enable work stealing between TDLib threads.
+   */
+  static void set_work_stealing_enabled(bool is_enabled);
+
+  /**
+   * Options of thread pools, between which TDLib instances are distributed.
+   */
+  struct ThreadPoolOptions {
+    /**
+     * The number of shared thread pools. Pass 0 to choose it automatically based on the number of CPU cores.
+     */
+    std::int32_t pool_count = 0;
+
+    /**
+     * The number of threads in every thread pool in addition to the main thread. Pass 0 to use the default value.
+     */
+    std::int32_t additional_thread_count = 0;
+
+    /**
+     * CPU affinity masks for threads of thread pools. Threads of the i-th thread pool will be allowed to run only on
+     * CPUs from thread_affinity_masks[i % thread_affinity_masks.size()]. Zero mask and empty list mean no restrictions.
+     */
+    std::vector<std::uint64_t> thread_affinity_masks;
+  };
+
+  /**
+   * Changes options of thread pools used by TDLib instances of the client manager. Must be called before the first
+   * request is sent to any TDLib instance or after all TDLib instances are closed.
+   * The total number of threads in all thread pools is limited, so the number of thread pools can be decreased.
+   * \param[in] options New options of thread pools.
+   * \return True, if the options were changed.
+   */
+  bool set_thread_pool_options(ThreadPoolOptions options);
+
+  /**
+   * Special thread pool identifier, which can be passed to ClientManager::set_client_thread_pool to create a new thread
+   * pool, which will be used only by the TDLib instance.
+   */
+  static constexpr std::int32_t DEDICATED_THREAD_POOL = -1;
+
+  /**
+   * Chooses a thread pool, in which a TDLib instance will run. By default, the least loaded shared thread pool is
+   * chosen. Must be called before the first request is sent to the TDLib instance, because running TDLib instances
+   * can't be moved between thread pools. To move a running TDLib instance, close it and create it again.
+   * \param[in] client_id TDLib client instance identifier.
+   * \param[in] pool_id Identifier of a shared thread pool from 0 to pool_count - 1 or DEDICATED_THREAD_POOL.
+   * \return True, if the thread pool was chosen.
+   */
+  bool set_client_thread_pool(ClientId client_id, std::int32_t pool_id);
+
+  /**
+   * Load statistics of a thread pool.
+   */
+  struct ThreadPoolStats {
+    /**
+     * Thread pool identifier. Dedicated thread pools have identifiers greater than or equal to pool_count.
+     */
+    std::int32_t pool_id;
+
+    /**
+     * True, if the thread pool is dedicated to a single TDLib instance.
+     */
+    bool is_dedicated;
+
+    /**
+     * The number of running threads of the thread pool. Threads of a thread pool are started with its first TDLib
+     * instance and are stopped after all TDLib instances of the client manager are closed.
+     */
+    std::int32_t thread_count;
+
+    /**
+     * The number of TDLib instances, which run in the thread pool.
+     */
+    std::int32_t client_count;
+
+    /**
+     * The total number of requests sent to TDLib instances in the thread pool.
+     */
+    std::uint64_t request_count;
+  };
+
+  /**
+   * Returns load statistics of thread pools of the client manager. May be called from any thread.
+   * \return Statistics of all shared and dedicated thread pools.
+   */
+  std::vector<ThreadPoolStats> get_thread_pool_stats();
+
   /**
    * Destroys the client manager and all TDLib client instances managed by it.
    */
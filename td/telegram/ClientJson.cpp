@@ -12,6 +12,7 @@
 #include "td/utils/common.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/JsonBuilder.h"
+#include "td/utils/misc.h"
 #include "td/utils/port/thread_local.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/StackAllocator.h"
@@ -26,8 +27,38 @@ static td_api::object_ptr<td_api::Function> get_return_error_function(Slice erro
   return td_api::make_object<td_api::testReturnError>(std::move(error));
 }
 
+// parses the request without creation of intermediate JsonValue
+static Status to_request_fast(MutableSlice request, td_api::object_ptr<td_api::Function> &func, string &extra) {
+  JsonParser parser(request);
+  if (parser.peek_type() != JsonValue::Type::Object) {
+    return Status::Error("Expected a JSON object");
+  }
+  parser.set_captured_field_name("@extra");
+  TRY_STATUS(from_json(func, parser));
+  TRY_STATUS(parser.finish());
+
+  auto extra_json = parser.get_captured_field_value();
+  if (!extra_json.empty()) {
+    // the value was skipped, so it is still unchanged
+    auto extra_str = extra_json.str();
+    TRY_RESULT(extra_value, json_decode(extra_str));
+    extra = json_encode<string>(extra_value);
+  }
+  return Status::OK();
+}
+
 static std::pair<td_api::object_ptr<td_api::Function>, string> to_request(Slice request) {
   auto request_str = request.str();
+  {
+    td_api::object_ptr<td_api::Function> func;
+    string extra;
+    if (to_request_fast(request_str, func, extra).is_ok()) {
+      return std::make_pair(std::move(func), std::move(extra));
+    }
+  }
+
+  // the request is invalid or uses rare JSON features; parse it once more through JsonValue
+  request_str = request.str();
   auto r_json_value = json_decode(request_str);
   if (r_json_value.is_error()) {
     return {get_return_error_function(PSLICE()
@@ -53,11 +84,12 @@ static std::pair<td_api::object_ptr<td_api::Function>, string> to_request(Slice
   return std::make_pair(std::move(func), std::move(extra));
 }
 
-static string from_response(const td_api::Object &object, const string &extra, int client_id) {
-  auto buf = StackAllocator::alloc(1 << 18);
-  JsonBuilder jb(StringBuilder(buf.as_slice(), true), -1);
+static void store_response(JsonBuilder &jb, const td_api::Object &object, const string &extra, int client_id) {
   jb.enter_value() << ToJson(object);
   auto &sb = jb.string_builder();
+  if (sb.is_error()) {
+    return;
+  }
   auto slice = sb.as_cslice();
   CHECK(!slice.empty() && slice.back() == '}');
   sb.pop_back();
@@ -68,7 +100,41 @@ static string from_response(const td_api::Object &object, const string &extra, i
     sb << ",\"@client_id\":" << client_id;
   }
   sb << '}';
-  return sb.as_cslice().str();
+}
+
+static string from_response(const td_api::Object &object, const string &extra, int client_id) {
+  auto buf = StackAllocator::alloc(1 << 18);
+  JsonBuilder jb(StringBuilder(buf.as_slice(), true), -1);
+  store_response(jb, object, extra, client_id);
+  return jb.string_builder().as_cslice().str();
+}
+
+// serializes the response directly to the buffer; if the buffer is too small, then the response is stored
+// in pending_response and negative required buffer size is returned
+static int from_response(const td_api::Object &object, const string &extra, int client_id, MutableSlice buffer,
+                         string &pending_response) {
+  if (buffer.size() > 100) {
+    JsonBuilder jb(StringBuilder(buffer, false), -1);
+    store_response(jb, object, extra, client_id);
+    auto &sb = jb.string_builder();
+    if (!sb.is_error()) {
+      return narrow_cast<int>(sb.as_cslice().size());
+    }
+  }
+
+  pending_response = from_response(object, extra, client_id);
+  return -narrow_cast<int>(pending_response.size() + 1);
+}
+
+static int store_pending_response(string &pending_response, MutableSlice buffer) {
+  auto size = pending_response.size();
+  if (buffer.size() <= size) {
+    return -narrow_cast<int>(size + 1);
+  }
+  buffer.copy_from(pending_response);
+  buffer[size] = '\0';
+  pending_response.clear();
+  return narrow_cast<int>(size);
 }
 
 static TD_THREAD_LOCAL string *current_output;
@@ -90,21 +156,44 @@ void ClientJson::send(Slice request) {
 }
 
 const char *ClientJson::receive(double timeout) {
+  if (!pending_response_.empty()) {
+    auto result = std::move(pending_response_);
+    pending_response_.clear();
+    return store_string(std::move(result));
+  }
+
   auto response = client_.receive(timeout);
   if (response.object == nullptr) {
     return nullptr;
   }
 
+  return store_string(from_response(*response.object, get_extra(response.id), 0));
+}
+
+int ClientJson::receive(double timeout, MutableSlice buffer) {
+  if (!pending_response_.empty()) {
+    return store_pending_response(pending_response_, buffer);
+  }
+
+  auto response = client_.receive(timeout);
+  if (response.object == nullptr) {
+    return 0;
+  }
+
+  return from_response(*response.object, get_extra(response.id), 0, buffer, pending_response_);
+}
+
+string ClientJson::get_extra(std::uint64_t request_id) {
   string extra;
-  if (response.id != 0) {
+  if (request_id != 0) {
     std::lock_guard<std::mutex> guard(mutex_);
-    auto it = extra_.find(response.id);
+    auto it = extra_.find(request_id);
     if (it != extra_.end()) {
       extra = std::move(it->second);
       extra_.erase(it);
     }
   }
-  return store_string(from_response(*response.object, extra, 0));
+  return extra;
 }
 
 const char *ClientJson::execute(Slice request) {
@@ -135,22 +224,80 @@ void json_send(int client_id, Slice request) {
   get_manager()->send(client_id, request_id, std::move(parsed_request.first));
 }
 
-const char *json_receive(double timeout) {
-  auto response = get_manager()->receive(timeout);
-  if (!response.object) {
-    return nullptr;
-  }
+static string pending_response;
 
+static string get_extra(uint64 request_id) {
   string extra_str;
-  if (response.request_id != 0) {
+  if (request_id != 0) {
     std::lock_guard<std::mutex> guard(extra_mutex);
-    auto it = extra.find(response.request_id);
+    auto it = extra.find(request_id);
     if (it != extra.end()) {
       extra_str = std::move(it->second);
       extra.erase(it);
     }
   }
-  return store_string(from_response(*response.object, extra_str, response.client_id));
+  return extra_str;
+}
+
+const char *json_receive(double timeout) {
+  if (!pending_response.empty()) {
+    auto result = std::move(pending_response);
+    pending_response.clear();
+    return store_string(std::move(result));
+  }
+
+  auto response = get_manager()->receive(timeout);
+  if (!response.object) {
+    return nullptr;
+  }
+
+  return store_string(from_response(*response.object, get_extra(response.request_id), response.client_id));
+}
+
+int json_receive(double timeout, MutableSlice buffer) {
+  if (!pending_response.empty()) {
+    return store_pending_response(pending_response, buffer);
+  }
+
+  auto response = get_manager()->receive(timeout);
+  if (!response.object) {
+    return 0;
+  }
+
+  return from_response(*response.object, get_extra(response.request_id), response.client_id, buffer,
+                       pending_response);
+}
+
+const char *json_receive_batch(int max_count, double timeout) {
+  vector<ClientManager::Response> responses;
+  string first_response;
+  if (!pending_response.empty()) {
+    first_response = std::move(pending_response);
+    pending_response.clear();
+    if (max_count > 1) {
+      responses = get_manager()->receive_batch(max_count - 1, 0.0);
+    }
+  } else {
+    responses = get_manager()->receive_batch(max_count, timeout);
+    if (responses.empty()) {
+      return nullptr;
+    }
+  }
+
+  auto buf = StackAllocator::alloc(1 << 18);
+  JsonBuilder jb(StringBuilder(buf.as_slice(), true), -1);
+  auto &sb = jb.string_builder();
+  sb << '[' << first_response;
+  bool is_first = first_response.empty();
+  for (auto &response : responses) {
+    if (!is_first) {
+      sb << ',';
+    }
+    is_first = false;
+    store_response(jb, *response.object, get_extra(response.request_id), response.client_id);
+  }
+  sb << ']';
+  return store_string(sb.as_cslice().str());
 }
 
 const char *json_execute(Slice request) {
@@ -25,6 +25,8 @@ class ClientJson final {
 
   const char *receive(double timeout);
 
+  int receive(double timeout, MutableSlice buffer);
+
   static const char *execute(Slice request);
 
  private:
@@ -32,6 +34,9 @@ class ClientJson final {
   std::mutex mutex_;  // for extra_
   FlatHashMap<std::int64_t, std::string> extra_;
   std::atomic<std::uint64_t> extra_id_{1};
+  std::string pending_response_;  // response, which didn't fit in the buffer provided by the caller
+
+  std::string get_extra(std::uint64_t request_id);
 };
 
 int json_create_client_id();
@@ -40,6 +45,10 @@ void json_send(int client_id, Slice request);
 
 const char *json_receive(double timeout);
 
+int json_receive(double timeout, MutableSlice buffer);
+
+const char *json_receive_batch(int max_count, double timeout);
+
 const char *json_execute(Slice request);
 
 }  // namespace td
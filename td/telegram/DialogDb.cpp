@@ -10,7 +10,9 @@
 
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
+#include "td/db/SqliteReadPool.h"
 #include "td/db/SqliteStatement.h"
+#include "td/db/SqliteTransactionBatcher.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/SchedulerLocalStorage.h"
@@ -328,8 +330,10 @@ std::shared_ptr<DialogDbSyncSafeInterface> create_dialog_db_sync(
 
 class DialogDbAsync final : public DialogDbAsyncInterface {
  public:
-  DialogDbAsync(std::shared_ptr<DialogDbSyncSafeInterface> sync_db, int32 scheduler_id) {
-    impl_ = create_actor_on_scheduler<Impl>("DialogDbActor", scheduler_id, std::move(sync_db));
+  DialogDbAsync(std::shared_ptr<DialogDbSyncSafeInterface> sync_db, int32 scheduler_id,
+                vector<int32> read_scheduler_ids) {
+    impl_ = create_actor_on_scheduler<Impl>("DialogDbActor", scheduler_id, std::move(sync_db),
+                                            std::move(read_scheduler_ids));
   }
 
   void add_dialog(DialogId dialog_id, FolderId folder_id, int64 order, BufferSlice data,
@@ -372,7 +376,8 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
  private:
   class Impl final : public Actor {
    public:
-    explicit Impl(std::shared_ptr<DialogDbSyncSafeInterface> sync_db_safe) : sync_db_safe_(std::move(sync_db_safe)) {
+    Impl(std::shared_ptr<DialogDbSyncSafeInterface> sync_db_safe, vector<int32> read_scheduler_ids)
+        : sync_db_safe_(std::move(sync_db_safe)), read_scheduler_ids_(std::move(read_scheduler_ids)) {
     }
 
     void add_dialog(DialogId dialog_id, FolderId folder_id, int64 order, BufferSlice data,
@@ -391,36 +396,42 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
 
     void get_notification_groups_by_last_notification_date(NotificationGroupKey notification_group_key, int32 limit,
                                                            Promise<vector<NotificationGroupKey>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_notification_groups_by_last_notification_date(notification_group_key, limit));
+      run_read_query([notification_group_key, limit, promise = std::move(promise)](DialogDbSyncInterface &db) mutable {
+        promise.set_value(db.get_notification_groups_by_last_notification_date(notification_group_key, limit));
+      });
     }
 
     void get_notification_group(NotificationGroupId notification_group_id, Promise<NotificationGroupKey> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_notification_group(notification_group_id));
+      run_read_query([notification_group_id, promise = std::move(promise)](DialogDbSyncInterface &db) mutable {
+        promise.set_result(db.get_notification_group(notification_group_id));
+      });
     }
 
     void get_secret_chat_count(FolderId folder_id, Promise<int32> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_secret_chat_count(folder_id));
+      run_read_query([folder_id, promise = std::move(promise)](DialogDbSyncInterface &db) mutable {
+        promise.set_value(db.get_secret_chat_count(folder_id));
+      });
     }
 
     void get_dialog(DialogId dialog_id, Promise<BufferSlice> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_dialog(dialog_id));
+      run_read_query([dialog_id, promise = std::move(promise)](DialogDbSyncInterface &db) mutable {
+        promise.set_result(db.get_dialog(dialog_id));
+      });
     }
 
     void get_dialogs(FolderId folder_id, int64 order, DialogId dialog_id, int32 limit,
                      Promise<DialogDbGetDialogsResult> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_dialogs(folder_id, order, dialog_id, limit));
+      run_read_query([folder_id, order, dialog_id, limit,
+                      promise = std::move(promise)](DialogDbSyncInterface &db) mutable {
+        promise.set_value(db.get_dialogs(folder_id, order, dialog_id, limit));
+      });
     }
 
     void close(Promise<Unit> promise) {
       do_flush();
       sync_db_safe_.reset();
       sync_db_ = nullptr;
-      promise.set_value(Unit());
+      read_pool_.close(std::move(promise));
       stop();
     }
 
@@ -432,31 +443,38 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
    private:
     std::shared_ptr<DialogDbSyncSafeInterface> sync_db_safe_;
     DialogDbSyncInterface *sync_db_ = nullptr;
+    vector<int32> read_scheduler_ids_;
+    SqliteReadPool read_pool_;
 
-    static constexpr size_t MAX_PENDING_QUERIES_COUNT{50};
-    static constexpr double MAX_PENDING_QUERIES_DELAY{0.01};
+    SqliteTransactionBatcher write_batcher_{"DialogDb"};
 
     //NB: order is important, destructor of pending_writes_ will change finished_writes_
     vector<Promise<Unit>> finished_writes_;
     vector<Promise<Unit>> pending_writes_;  // TODO use Action
-    double wakeup_at_ = 0;
 
     template <class F>
     void add_write_query(F &&f) {
       pending_writes_.push_back(PromiseCreator::lambda(std::forward<F>(f)));
-      if (pending_writes_.size() > MAX_PENDING_QUERIES_COUNT) {
+      if (write_batcher_.on_query_added()) {
         do_flush();
-        wakeup_at_ = 0;
-      } else if (wakeup_at_ == 0) {
-        wakeup_at_ = Time::now_cached() + MAX_PENDING_QUERIES_DELAY;
-      }
-      if (wakeup_at_ != 0) {
-        set_timeout_at(wakeup_at_);
+      } else {
+        set_timeout_at(write_batcher_.get_commit_time());
       }
     }
 
-    void add_read_query() {
+    // the query sees results of all previous writes, because they are committed before it is started
+    template <class F>
+    void run_read_query(F &&f) {
       do_flush();
+      if (read_pool_.empty()) {
+        return f(*sync_db_);
+      }
+      read_pool_.run(PromiseCreator::lambda(
+          [sync_db_safe = sync_db_safe_, f = std::forward<F>(f)](Result<Unit> result) mutable {
+            if (result.is_ok()) {
+              f(sync_db_safe->get());
+            }
+          }));
     }
 
     void do_flush() {
@@ -465,7 +483,9 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
       }
       sync_db_->begin_write_transaction().ensure();
       set_promises(pending_writes_);
+      auto commit_start_time = Time::now();
       sync_db_->commit_transaction().ensure();
+      write_batcher_.on_committed(Time::now() - commit_start_time);
       set_promises(finished_writes_);
       cancel_timeout();
     }
@@ -476,14 +496,17 @@ class DialogDbAsync final : public DialogDbAsyncInterface {
 
     void start_up() final {
       sync_db_ = &sync_db_safe_->get();
+      if (!read_scheduler_ids_.empty()) {
+        read_pool_ = SqliteReadPool(read_scheduler_ids_);
+      }
     }
   };
   ActorOwn<Impl> impl_;
 };
 
 std::shared_ptr<DialogDbAsyncInterface> create_dialog_db_async(std::shared_ptr<DialogDbSyncSafeInterface> sync_db,
-                                                               int32 scheduler_id) {
-  return std::make_shared<DialogDbAsync>(std::move(sync_db), scheduler_id);
+                                                               int32 scheduler_id, vector<int32> read_scheduler_ids) {
+  return std::make_shared<DialogDbAsync>(std::move(sync_db), scheduler_id, std::move(read_scheduler_ids));
 }
 
 }  // namespace td
@@ -105,6 +105,7 @@ std::shared_ptr<DialogDbSyncSafeInterface> create_dialog_db_sync(
     std::shared_ptr<SqliteConnectionSafe> sqlite_connection);
 
 std::shared_ptr<DialogDbAsyncInterface> create_dialog_db_async(std::shared_ptr<DialogDbSyncSafeInterface> sync_db,
-                                                               int32 scheduler_id = -1);
+                                                               int32 scheduler_id = -1,
+                                                               vector<int32> read_scheduler_ids = {});
 
 }  // namespace td
@@ -0,0 +1,69 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/EmojiKeywordIndex.h"
+
+#include "td/utils/misc.h"
+
+#include <algorithm>
+
+namespace td {
+
+EmojiKeywordIndex::EmojiKeywordIndex(vector<std::pair<string, string>> keyword_emojis) {
+  std::stable_sort(keyword_emojis.begin(), keyword_emojis.end(),
+                   [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+  entries_.reserve(keyword_emojis.size());
+  for (auto &it : keyword_emojis) {
+    if (!entries_.empty() && entries_.back().keyword_ == it.first) {
+      entries_.pop_back();
+    }
+    if (!it.second.empty()) {
+      entries_.push_back({std::move(it.first), std::move(it.second)});
+    }
+  }
+  entries_.shrink_to_fit();
+}
+
+vector<EmojiKeywordIndex::Entry>::const_iterator EmojiKeywordIndex::lower_bound(Slice keyword) const {
+  return std::lower_bound(entries_.begin(), entries_.end(), keyword,
+                          [](const Entry &entry, Slice keyword) { return Slice(entry.keyword_) < keyword; });
+}
+
+vector<string> EmojiKeywordIndex::get_emojis(Slice keyword) const {
+  auto it = lower_bound(keyword);
+  if (it == entries_.end() || it->keyword_ != keyword) {
+    return {};
+  }
+  return full_split(it->emojis_, '$');
+}
+
+void EmojiKeywordIndex::set_emojis(Slice keyword, const vector<string> &emojis) {
+  auto it = entries_.begin() + (lower_bound(keyword) - entries_.begin());
+  bool is_found = it != entries_.end() && it->keyword_ == keyword;
+  if (emojis.empty()) {
+    if (is_found) {
+      entries_.erase(it);
+    }
+    return;
+  }
+  if (is_found) {
+    it->emojis_ = implode(emojis, '$');
+  } else {
+    entries_.insert(it, {keyword.str(), implode(emojis, '$')});
+  }
+}
+
+vector<std::pair<string, string>> EmojiKeywordIndex::search(Slice prefix) const {
+  vector<std::pair<string, string>> result;
+  for (auto it = lower_bound(prefix); it != entries_.end() && begins_with(it->keyword_, prefix); ++it) {
+    for (auto emoji : full_split(Slice(it->emojis_), '$')) {
+      result.emplace_back(emoji.str(), it->keyword_);
+    }
+  }
+  return result;
+}
+
+}  // namespace td
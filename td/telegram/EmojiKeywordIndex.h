@@ -0,0 +1,45 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+#include <utility>
+
+namespace td {
+
+// emoji keywords of one language, sorted by keyword to allow search by a keyword prefix
+class EmojiKeywordIndex {
+ public:
+  EmojiKeywordIndex() = default;
+
+  // keyword_emojis contains pairs of a keyword and its emojis, joined with '$'; the last pair wins for equal keywords
+  explicit EmojiKeywordIndex(vector<std::pair<string, string>> keyword_emojis);
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+  vector<string> get_emojis(Slice keyword) const;
+
+  void set_emojis(Slice keyword, const vector<string> &emojis);
+
+  // returns pairs of an emoji and a keyword, beginning with the prefix
+  vector<std::pair<string, string>> search(Slice prefix) const;
+
+ private:
+  struct Entry {
+    string keyword_;
+    string emojis_;
+  };
+  vector<Entry> entries_;
+
+  vector<Entry>::const_iterator lower_bound(Slice keyword) const;
+};
+
+}  // namespace td
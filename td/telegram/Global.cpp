@@ -32,6 +32,9 @@ Global::Global() {
   database_scheduler_id_ = min(current_scheduler_id + 1, max_scheduler_id);
   gc_scheduler_id_ = min(current_scheduler_id + 2, max_scheduler_id);
   slow_net_scheduler_id_ = min(current_scheduler_id + 3, max_scheduler_id);
+  for (auto scheduler_id = current_scheduler_id + 4; scheduler_id <= max_scheduler_id; scheduler_id++) {
+    database_read_scheduler_ids_.push_back(scheduler_id);
+  }
 }
 
 Global::~Global() = default;
@@ -184,6 +184,15 @@ class Global final : public ActorContext {
 
   double get_dns_time_difference() const;
 
+  // minimum size of a query, which is worth compressing, reported by the main session; 0 if unknown
+  size_t get_min_gzipped_query_size() const {
+    return min_gzipped_query_size_.load(std::memory_order_relaxed);
+  }
+
+  void set_min_gzipped_query_size(size_t min_gzipped_size) {
+    min_gzipped_query_size_.store(min_gzipped_size, std::memory_order_relaxed);
+  }
+
   ActorId<StateManager> state_manager() const {
     return state_manager_;
   }
@@ -590,6 +599,11 @@ class Global final : public ActorContext {
     return slow_net_scheduler_id_;
   }
 
+  // schedulers for parallel read-only database queries; empty if there are no additional threads for them
+  const vector<int32> &get_database_read_scheduler_ids() const {
+    return database_read_scheduler_ids_;
+  }
+
   DcId get_webfile_dc_id() const;
 
   std::shared_ptr<DhConfig> get_dh_config() {
@@ -736,6 +750,7 @@ class Global final : public ActorContext {
   int32 database_scheduler_id_ = 0;
   int32 gc_scheduler_id_ = 0;
   int32 slow_net_scheduler_id_ = 0;
+  vector<int32> database_read_scheduler_ids_;
 
   std::atomic<bool> store_all_files_in_files_directory_{false};
 
@@ -743,6 +758,7 @@ class Global final : public ActorContext {
   std::atomic<bool> server_time_difference_was_updated_{false};
   std::atomic<double> dns_time_difference_{0.0};
   std::atomic<bool> dns_time_difference_was_updated_{false};
+  std::atomic<size_t> min_gzipped_query_size_{0};
   std::atomic<bool> close_flag_{false};
   std::atomic<double> system_time_saved_at_{-1e10};
   double saved_diff_ = 0.0;
@@ -12,11 +12,14 @@
 
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
+#include "td/db/SqliteReadPool.h"
 #include "td/db/SqliteStatement.h"
+#include "td/db/SqliteTransactionBatcher.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/SchedulerLocalStorage.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
 #include "td/utils/ScopeGuard.h"
@@ -26,6 +29,7 @@
 #include "td/utils/StringBuilder.h"
 #include "td/utils/Time.h"
 #include "td/utils/tl_helpers.h"
+#include "td/utils/translit.h"
 #include "td/utils/unicode.h"
 #include "td/utils/utf8.h"
 
@@ -41,8 +45,143 @@ namespace td {
 static constexpr int32 MESSAGE_DB_INDEX_COUNT = 30;
 static constexpr int32 MESSAGE_DB_INDEX_COUNT_OLD = 9;
 
+// search text of a message is followed by service words, starting with '\a', which are used for filtering
+static Slice get_search_text_without_service_words(Slice text) {
+  for (size_t i = 1; i < text.size(); i++) {
+    if (text[i] == '\a' && text[i - 1] == ' ') {
+      return text.substr(0, i - 1);
+    }
+  }
+  return text;
+}
+
+static vector<Slice> get_word_trigrams(Slice word) {
+  vector<size_t> positions;
+  for (size_t i = 0; i < word.size(); i++) {
+    if (is_utf8_character_first_code_unit(static_cast<unsigned char>(word[i]))) {
+      positions.push_back(i);
+    }
+  }
+  positions.push_back(word.size());
+
+  vector<Slice> result;
+  for (size_t i = 0; i + 3 < positions.size(); i++) {
+    result.push_back(word.substr(positions[i], positions[i + 3] - positions[i]));
+  }
+  return result;
+}
+
+// each normalized word is indexed along with all its trigrams to allow search by any part of a word
+static string get_trigram_search_text(Slice text) {
+  auto main_text = get_search_text_without_service_words(text);
+  string result;
+  for (auto &word : utf8_get_search_words(main_text)) {
+    result += word;
+    for (auto trigram : get_word_trigrams(word)) {
+      result += ' ';
+      result.append(trigram.begin(), trigram.size());
+    }
+    result += ' ';
+  }
+  result.append(text.begin() + main_text.size(), text.size() - main_text.size());
+  return result;
+}
+
+static vector<string> get_query_word_variants(const string &word) {
+  vector<string> result{word};
+  for (auto &transliteration : get_word_transliterations(word, false)) {
+    for (auto &variant : utf8_get_search_words(transliteration)) {
+      if (!td::contains(result, variant)) {
+        result.push_back(std::move(variant));
+      }
+    }
+  }
+  return result;
+}
+
+// every query word or its transliteration must be a part of some word of the message
+static string get_trigram_search_query(Slice query) {
+  const size_t MAX_QUERY_SIZE = 1024;
+  string result;
+  for (auto &word : utf8_get_search_words(utf8_truncate(query, MAX_QUERY_SIZE))) {
+    if (!result.empty()) {
+      result += " AND ";
+    }
+    result += '(';
+    bool is_first_variant = true;
+    for (auto &variant : get_query_word_variants(word)) {
+      if (!is_first_variant) {
+        result += " OR ";
+      }
+      is_first_variant = false;
+
+      auto trigrams = get_word_trigrams(variant);
+      if (trigrams.empty()) {
+        // the word is too short; find words starting with it
+        result += PSTRING() << '"' << variant << "\"*";
+        continue;
+      }
+      result += '(';
+      for (size_t i = 0; i < trigrams.size(); i++) {
+        if (i != 0) {
+          result += " AND ";
+        }
+        result += PSTRING() << '"' << trigrams[i] << '"';
+      }
+      result += ')';
+    }
+    result += ')';
+  }
+  return result;
+}
+
+// returns UTF-16 offsets of words in the search text, which contain a query word as a substring or as a prefix
+static vector<MessageDbFtsMatch> get_search_text_matches(Slice text, const vector<string> &query_words,
+                                                         bool allow_substring) {
+  vector<MessageDbFtsMatch> result;
+  text = get_search_text_without_service_words(text);
+  string word;
+  int32 utf16_offset = 0;
+  int32 word_offset = 0;
+  auto on_word_end = [&] {
+    if (word.empty()) {
+      return;
+    }
+    for (auto &query_word : query_words) {
+      auto pos = word.find(query_word);
+      if (pos == 0 || (allow_substring && pos != string::npos)) {
+        result.push_back(MessageDbFtsMatch{word_offset, utf16_offset - word_offset});
+        break;
+      }
+    }
+    word.clear();
+  };
+  for (auto ptr = text.ubegin(), end = text.uend(); ptr < end;) {
+    uint32 code;
+    ptr = next_utf8_unsafe(ptr, &code);
+    auto search_code = prepare_search_character(code);
+    if (search_code == ' ') {
+      on_word_end();
+    } else if (search_code != 0) {
+      if (word.empty()) {
+        word_offset = utf16_offset;
+      }
+      append_utf8_character(word, remove_diacritics(search_code));
+    }
+    utf16_offset += code >= 0x10000 ? 2 : 1;
+  }
+  on_word_end();
+  return result;
+}
+
+static Status drop_trigram_fts(SqliteDb &db) {
+  TRY_STATUS(db.exec("DROP TRIGGER IF EXISTS trigger_fts_trigram_delete"));
+  TRY_STATUS(db.exec("DROP TABLE IF EXISTS messages_fts_trigram_state"));
+  return db.exec("DROP TABLE IF EXISTS messages_fts_trigram");
+}
+
 // NB: must happen inside a transaction
-Status init_message_db(SqliteDb &db, int32 version) {
+Status init_message_db(SqliteDb &db, int32 version, bool use_trigram_index) {
   LOG(INFO) << "Init message database " << tag("version", version);
 
   // Check if database exists
@@ -87,6 +226,21 @@ Status init_message_db(SqliteDb &db, int32 version) {
 
     return Status::OK();
   };
+  // the index is filled by MessageDbImpl, because trigrams can't be computed in SQL,
+  // and is built for old messages in background by build_trigram_index
+  auto add_trigram_fts = [&db] {
+    TRY_STATUS(
+        db.exec("CREATE VIRTUAL TABLE IF NOT EXISTS messages_fts_trigram USING fts5(text, "
+                "tokenize = \"unicode61 remove_diacritics 0 tokenchars '\a'\")"));
+    TRY_STATUS(db.exec("CREATE TABLE IF NOT EXISTS messages_fts_trigram_state (next_search_id INT8)"));
+    TRY_STATUS(
+        db.exec("INSERT INTO messages_fts_trigram_state SELECT 9223372036854775807 WHERE NOT EXISTS "
+                "(SELECT 1 FROM messages_fts_trigram_state)"));
+    TRY_STATUS(db.exec(
+        "CREATE TRIGGER IF NOT EXISTS trigger_fts_trigram_delete BEFORE DELETE ON messages WHEN OLD.search_id IS NOT "
+        "NULL BEGIN DELETE FROM messages_fts_trigram WHERE rowid = OLD.search_id; END"));
+    return Status::OK();
+  };
   auto add_call_index = [&db] {
     for (int i = static_cast<int>(MessageSearchFilter::Call) - 1; i < static_cast<int>(MessageSearchFilter::MissedCall);
          i++) {
@@ -167,6 +321,11 @@ Status init_message_db(SqliteDb &db, int32 version) {
   if (version < static_cast<int32>(DbVersion::AddMessageThreadSupport)) {
     TRY_STATUS(db.exec("ALTER TABLE messages ADD COLUMN top_thread_message_id INT8"));
   }
+  if (use_trigram_index) {
+    TRY_STATUS(add_trigram_fts());
+  } else {
+    TRY_STATUS(drop_trigram_fts(db));
+  }
   return Status::OK();
 }
 
@@ -174,6 +333,7 @@ Status init_message_db(SqliteDb &db, int32 version) {
 Status drop_message_db(SqliteDb &db, int32 version) {
   LOG(WARNING) << "Drop message database " << tag("version", version)
                << tag("current_db_version", current_db_version());
+  TRY_STATUS(drop_trigram_fts(db));
   return db.exec("DROP TABLE IF EXISTS messages");
 }
 
@@ -220,10 +380,34 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     TRY_RESULT_ASSIGN(get_messages_from_notification_id_stmt_,
                       db_.get_statement("SELECT data, message_id FROM messages WHERE dialog_id = ?1 AND "
                                         "notification_id < ?2 ORDER BY notification_id DESC LIMIT ?3"));
-    TRY_RESULT_ASSIGN(get_messages_fts_stmt_,
-                      db_.get_statement("SELECT dialog_id, message_id, data, search_id FROM messages WHERE search_id "
-                                        "IN (SELECT rowid FROM messages_fts WHERE messages_fts MATCH ?1 AND rowid < ?2 "
-                                        "ORDER BY rowid DESC LIMIT ?3) ORDER BY search_id DESC"));
+    TRY_RESULT(has_trigram_index, db_.has_table("messages_fts_trigram"));
+    has_trigram_index_ = has_trigram_index;
+    for (int use_trigram_index = 0; use_trigram_index < (has_trigram_index_ ? 2 : 1); use_trigram_index++) {
+      Slice fts_table = use_trigram_index ? Slice("messages_fts_trigram") : Slice("messages_fts");
+      TRY_RESULT_ASSIGN(get_messages_fts_stmts_[use_trigram_index].by_search_id_stmt_,
+                        db_.get_statement(PSLICE() << "SELECT dialog_id, message_id, data, search_id, text FROM "
+                                                      "messages WHERE search_id IN (SELECT rowid FROM "
+                                                   << fts_table << " WHERE " << fts_table
+                                                   << " MATCH ?1 AND rowid < ?2 ORDER BY rowid DESC LIMIT ?3) "
+                                                      "ORDER BY search_id DESC"));
+      TRY_RESULT_ASSIGN(get_messages_fts_stmts_[use_trigram_index].by_rank_stmt_,
+                        db_.get_statement(PSLICE() << "SELECT m.dialog_id, m.message_id, m.data, m.search_id, m.text "
+                                                      "FROM (SELECT rowid, rank FROM "
+                                                   << fts_table << " WHERE " << fts_table
+                                                   << " MATCH ?1 ORDER BY rank LIMIT ?3 OFFSET ?2) AS f JOIN messages "
+                                                      "AS m ON m.search_id = f.rowid ORDER BY f.rank"));
+    }
+    if (has_trigram_index_) {
+      TRY_RESULT_ASSIGN(add_trigram_text_stmt_,
+                        db_.get_statement("INSERT OR REPLACE INTO messages_fts_trigram(rowid, text) VALUES(?1, ?2)"));
+      TRY_RESULT_ASSIGN(get_trigram_index_state_stmt_,
+                        db_.get_statement("SELECT next_search_id FROM messages_fts_trigram_state"));
+      TRY_RESULT_ASSIGN(set_trigram_index_state_stmt_,
+                        db_.get_statement("UPDATE messages_fts_trigram_state SET next_search_id = ?1"));
+      TRY_RESULT_ASSIGN(get_messages_for_trigram_index_stmt_,
+                        db_.get_statement("SELECT search_id, text FROM messages WHERE search_id < ?1 ORDER BY "
+                                          "search_id DESC LIMIT ?2"));
+    }
 
     for (int32 i = 0; i < MESSAGE_DB_INDEX_COUNT; i++) {
       TRY_RESULT_ASSIGN(
@@ -364,6 +548,10 @@ class MessageDbImpl final : public MessageDbSyncInterface {
     }
 
     add_message_stmt_.step().ensure();
+
+    if (has_trigram_index_ && search_id != 0) {
+      add_trigram_text(search_id, text);
+    }
   }
 
   void add_scheduled_message(MessageFullId message_full_id, BufferSlice data) final {
@@ -736,32 +924,56 @@ class MessageDbImpl final : public MessageDbSyncInterface {
   }
 
   MessageDbFtsResult get_messages_fts(MessageDbFtsQuery query) final {
+    auto use_trigram_index = is_trigram_index_ready();
+    auto &stmt = query.order_by_rank ? get_messages_fts_stmts_[use_trigram_index].by_rank_stmt_
+                                     : get_messages_fts_stmts_[use_trigram_index].by_search_id_stmt_;
     SCOPE_EXIT {
-      get_messages_fts_stmt_.reset();
+      stmt.reset();
     };
 
     LOG(INFO) << tag("query", query.query) << query.dialog_id << tag("filter", query.filter)
-              << tag("from_search_id", query.from_search_id) << tag("limit", query.limit);
-    string words = prepare_query(query.query);
+              << tag("from_search_id", query.from_search_id) << tag("limit", query.limit)
+              << tag("order_by_rank", query.order_by_rank) << tag("offset", query.offset)
+              << tag("use_trigram_index", use_trigram_index);
+    string words = use_trigram_index ? get_trigram_search_query(query.query) : prepare_query(query.query);
     LOG(INFO) << tag("from", query.query) << tag("to", words);
 
+    auto add_condition = [&words](Slice condition) {
+      if (!words.empty()) {
+        words += " AND ";
+      }
+      words += condition.str();
+    };
+
     // dialog_id kludge
     if (query.dialog_id.is_valid()) {
-      words += PSTRING() << " \"\a" << query.dialog_id.get() << "\"";
+      add_condition(PSLICE() << "\"\a" << query.dialog_id.get() << "\"");
     }
 
     // index_mask kludge
     if (query.filter != MessageSearchFilter::Empty) {
-      words += PSTRING() << " \"\a\a" << message_search_filter_index(query.filter) << "\"";
+      add_condition(PSLICE() << "\"\a\a" << message_search_filter_index(query.filter) << "\"");
     }
 
-    auto &stmt = get_messages_fts_stmt_;
     stmt.bind_string(1, words).ensure();
-    if (query.from_search_id == 0) {
-      query.from_search_id = std::numeric_limits<int64>::max();
+    if (query.order_by_rank) {
+      query.offset = max(query.offset, 0);
+      stmt.bind_int32(2, query.offset).ensure();
+    } else {
+      if (query.from_search_id == 0) {
+        query.from_search_id = std::numeric_limits<int64>::max();
+      }
+      stmt.bind_int64(2, query.from_search_id).ensure();
     }
-    stmt.bind_int64(2, query.from_search_id).ensure();
     stmt.bind_int32(3, query.limit).ensure();
+
+    vector<string> query_words;
+    if (query.order_by_rank) {
+      for (auto &word : utf8_get_search_words(query.query)) {
+        append(query_words, get_query_word_variants(word));
+      }
+    }
+
     MessageDbFtsResult result;
     auto status = stmt.step();
     if (status.is_error()) {
@@ -775,11 +987,54 @@ class MessageDbImpl final : public MessageDbSyncInterface {
       auto search_id = stmt.view_int64(3);
       result.next_search_id = search_id;
       result.messages.push_back(MessageDbMessage{dialog_id, message_id, BufferSlice(data_slice)});
+      if (query.order_by_rank) {
+        result.matches.push_back(get_search_text_matches(stmt.view_string(4), query_words, use_trigram_index));
+      }
       stmt.step().ensure();
     }
+    result.next_offset = query.offset + narrow_cast<int32>(result.messages.size());
     return result;
   }
 
+  bool build_trigram_index(int32 limit) final {
+    if (!has_trigram_index_) {
+      return true;
+    }
+    auto next_search_id = get_trigram_index_next_search_id();
+    if (next_search_id == 0) {
+      return true;
+    }
+
+    int32 added_message_count = 0;
+    {
+      auto &stmt = get_messages_for_trigram_index_stmt_;
+      SCOPE_EXIT {
+        stmt.reset();
+      };
+      stmt.bind_int64(1, next_search_id).ensure();
+      stmt.bind_int32(2, limit).ensure();
+      stmt.step().ensure();
+      while (stmt.has_row()) {
+        next_search_id = stmt.view_int64(0);
+        add_trigram_text(next_search_id, stmt.view_string(1));
+        added_message_count++;
+        stmt.step().ensure();
+      }
+    }
+    if (added_message_count < limit) {
+      next_search_id = 0;
+    }
+    LOG(INFO) << "Add " << added_message_count << " messages to trigram search index";
+
+    auto &stmt = set_trigram_index_state_stmt_;
+    SCOPE_EXIT {
+      stmt.reset();
+    };
+    stmt.bind_int64(1, next_search_id).ensure();
+    stmt.step().ensure();
+    return next_search_id == 0;
+  }
+
   vector<MessageDbDialogMessage> get_messages_from_index(DialogId dialog_id, MessageId from_message_id,
                                                          MessageSearchFilter filter, int32 offset, int32 limit) {
     auto &stmt = get_messages_from_index_stmts_[message_search_filter_index(filter)];
@@ -849,7 +1104,47 @@ class MessageDbImpl final : public MessageDbSyncInterface {
   std::array<GetMessagesStmt, MESSAGE_DB_INDEX_COUNT> get_messages_from_index_stmts_;
   std::array<SqliteStatement, 2> get_calls_stmts_;
 
-  SqliteStatement get_messages_fts_stmt_;
+  struct GetMessagesFtsStmt {
+    SqliteStatement by_search_id_stmt_;
+    SqliteStatement by_rank_stmt_;
+  };
+  std::array<GetMessagesFtsStmt, 2> get_messages_fts_stmts_;  // without and with trigram index
+
+  bool has_trigram_index_ = false;
+  bool is_trigram_index_ready_ = false;
+  SqliteStatement add_trigram_text_stmt_;
+  SqliteStatement get_trigram_index_state_stmt_;
+  SqliteStatement set_trigram_index_state_stmt_;
+  SqliteStatement get_messages_for_trigram_index_stmt_;
+
+  void add_trigram_text(int64 search_id, Slice text) {
+    auto &stmt = add_trigram_text_stmt_;
+    SCOPE_EXIT {
+      stmt.reset();
+    };
+    auto trigram_text = get_trigram_search_text(text);
+    stmt.bind_int64(1, search_id).ensure();
+    stmt.bind_string(2, trigram_text).ensure();
+    stmt.step().ensure();
+  }
+
+  // returns 0 if the trigram index is complete
+  int64 get_trigram_index_next_search_id() {
+    auto &stmt = get_trigram_index_state_stmt_;
+    SCOPE_EXIT {
+      stmt.reset();
+    };
+    stmt.step().ensure();
+    return stmt.has_row() ? stmt.view_int64(0) : 0;
+  }
+
+  // the trigram index is used only after it is built for all messages
+  bool is_trigram_index_ready() {
+    if (has_trigram_index_ && !is_trigram_index_ready_) {
+      is_trigram_index_ready_ = get_trigram_index_next_search_id() == 0;
+    }
+    return is_trigram_index_ready_;
+  }
 
   SqliteStatement add_scheduled_message_stmt_;
   SqliteStatement get_scheduled_message_stmt_;
@@ -984,8 +1279,10 @@ std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
 
 class MessageDbAsync final : public MessageDbAsyncInterface {
  public:
-  MessageDbAsync(std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id) {
-    impl_ = create_actor_on_scheduler<Impl>("MessageDbActor", scheduler_id, std::move(sync_db));
+  MessageDbAsync(std::shared_ptr<MessageDbSyncSafeInterface> sync_db, int32 scheduler_id,
+                 vector<int32> read_scheduler_ids) {
+    impl_ = create_actor_on_scheduler<Impl>("MessageDbActor", scheduler_id, std::move(sync_db),
+                                            std::move(read_scheduler_ids));
   }
 
   void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
@@ -1066,7 +1363,8 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
  private:
   class Impl final : public Actor {
    public:
-    explicit Impl(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe) : sync_db_safe_(std::move(sync_db_safe)) {
+    Impl(std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe, vector<int32> read_scheduler_ids)
+        : sync_db_safe_(std::move(sync_db_safe)), read_scheduler_ids_(std::move(read_scheduler_ids)) {
     }
     void add_message(MessageFullId message_full_id, ServerMessageId unique_message_id, DialogId sender_dialog_id,
                      int64 random_id, int32 ttl_expires_at, int32 index_mask, int64 search_id, string text,
@@ -1113,65 +1411,79 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
     }
 
     void get_message(MessageFullId message_full_id, Promise<MessageDbDialogMessage> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_message(message_full_id));
+      run_read_query([message_full_id, promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_result(db.get_message(message_full_id));
+      });
     }
     void get_message_by_unique_message_id(ServerMessageId unique_message_id, Promise<MessageDbMessage> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_message_by_unique_message_id(unique_message_id));
+      run_read_query([unique_message_id, promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_result(db.get_message_by_unique_message_id(unique_message_id));
+      });
     }
     void get_message_by_random_id(DialogId dialog_id, int64 random_id, Promise<MessageDbDialogMessage> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_message_by_random_id(dialog_id, random_id));
+      run_read_query([dialog_id, random_id, promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_result(db.get_message_by_random_id(dialog_id, random_id));
+      });
     }
     void get_dialog_message_by_date(DialogId dialog_id, MessageId first_message_id, MessageId last_message_id,
                                     int32 date, Promise<MessageDbDialogMessage> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_dialog_message_by_date(dialog_id, first_message_id, last_message_id, date));
+      run_read_query([dialog_id, first_message_id, last_message_id, date,
+                      promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_result(db.get_dialog_message_by_date(dialog_id, first_message_id, last_message_id, date));
+      });
     }
 
     void get_dialog_message_calendar(MessageDbDialogCalendarQuery query, Promise<MessageDbCalendar> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_dialog_message_calendar(std::move(query)));
+      run_read_query([query = std::move(query), promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_value(db.get_dialog_message_calendar(std::move(query)));
+      });
     }
 
     void get_dialog_sparse_message_positions(MessageDbGetDialogSparseMessagePositionsQuery query,
                                              Promise<MessageDbMessagePositions> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_dialog_sparse_message_positions(std::move(query)));
+      run_read_query([query = std::move(query), promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_result(db.get_dialog_sparse_message_positions(std::move(query)));
+      });
     }
 
     void get_messages(MessageDbMessagesQuery query, Promise<vector<MessageDbDialogMessage>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_messages(std::move(query)));
+      run_read_query([query = std::move(query), promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_value(db.get_messages(std::move(query)));
+      });
     }
     void get_scheduled_messages(DialogId dialog_id, int32 limit, Promise<vector<MessageDbDialogMessage>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_scheduled_messages(dialog_id, limit));
+      run_read_query([dialog_id, limit, promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_value(db.get_scheduled_messages(dialog_id, limit));
+      });
     }
     void get_messages_from_notification_id(DialogId dialog_id, NotificationId from_notification_id, int32 limit,
                                            Promise<vector<MessageDbDialogMessage>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_messages_from_notification_id(dialog_id, from_notification_id, limit));
+      run_read_query([dialog_id, from_notification_id, limit,
+                      promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_value(db.get_messages_from_notification_id(dialog_id, from_notification_id, limit));
+      });
     }
     void get_calls(MessageDbCallsQuery query, Promise<MessageDbCallsResult> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_calls(std::move(query)));
+      run_read_query([query = std::move(query), promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_value(db.get_calls(std::move(query)));
+      });
     }
     void get_messages_fts(MessageDbFtsQuery query, Promise<MessageDbFtsResult> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_messages_fts(std::move(query)));
+      run_read_query([query = std::move(query), promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_value(db.get_messages_fts(std::move(query)));
+      });
     }
     void get_expiring_messages(int32 expires_till, int32 limit, Promise<vector<MessageDbMessage>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_expiring_messages(expires_till, limit));
+      run_read_query([expires_till, limit, promise = std::move(promise)](MessageDbSyncInterface &db) mutable {
+        promise.set_value(db.get_expiring_messages(expires_till, limit));
+      });
     }
 
     void close(Promise<> promise) {
       do_flush();
       sync_db_safe_.reset();
       sync_db_ = nullptr;
-      promise.set_value(Unit());
+      read_pool_.close(std::move(promise));
       stop();
     }
 
@@ -1180,41 +1492,66 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
       LOG(INFO) << "MessageDb flushed";
     }
 
+    // builds the trigram index in small transactions to not block other queries
+    void build_trigram_index() {
+      do_flush();
+      sync_db_->begin_write_transaction().ensure();
+      auto is_built = sync_db_->build_trigram_index(TRIGRAM_INDEX_BATCH_SIZE);
+      sync_db_->commit_transaction().ensure();
+      if (!is_built) {
+        send_closure_later(actor_id(this), &Impl::build_trigram_index);
+      }
+    }
+
    private:
     std::shared_ptr<MessageDbSyncSafeInterface> sync_db_safe_;
     MessageDbSyncInterface *sync_db_ = nullptr;
+    vector<int32> read_scheduler_ids_;
+    SqliteReadPool read_pool_;
 
-    static constexpr size_t MAX_PENDING_QUERIES_COUNT{50};
-    static constexpr double MAX_PENDING_QUERIES_DELAY{0.01};
+    SqliteTransactionBatcher write_batcher_{"MessageDb"};
+    static constexpr int32 TRIGRAM_INDEX_BATCH_SIZE = 200;
 
     //NB: order is important, destructor of pending_writes_ will change finished_writes_
     vector<Promise<Unit>> finished_writes_;
     vector<Promise<Unit>> pending_writes_;  // TODO use Action
-    double wakeup_at_ = 0;
 
     template <class F>
     void add_write_query(F &&f) {
       pending_writes_.push_back(PromiseCreator::lambda(std::forward<F>(f)));
-      if (pending_writes_.size() > MAX_PENDING_QUERIES_COUNT) {
+      if (write_batcher_.on_query_added()) {
         do_flush();
-        wakeup_at_ = 0;
-      } else if (wakeup_at_ == 0) {
-        wakeup_at_ = Time::now_cached() + MAX_PENDING_QUERIES_DELAY;
-      }
-      if (wakeup_at_ != 0) {
-        set_timeout_at(wakeup_at_);
+      } else {
+        set_timeout_at(write_batcher_.get_commit_time());
       }
     }
     void add_read_query() {
       do_flush();
     }
+
+    // the query sees results of all previous writes, because they are committed before it is started
+    template <class F>
+    void run_read_query(F &&f) {
+      do_flush();
+      if (read_pool_.empty()) {
+        return f(*sync_db_);
+      }
+      read_pool_.run(PromiseCreator::lambda(
+          [sync_db_safe = sync_db_safe_, f = std::forward<F>(f)](Result<Unit> result) mutable {
+            if (result.is_ok()) {
+              f(sync_db_safe->get());
+            }
+          }));
+    }
     void do_flush() {
       if (pending_writes_.empty()) {
         return;
       }
       sync_db_->begin_write_transaction().ensure();
       set_promises(pending_writes_);
+      auto commit_start_time = Time::now();
       sync_db_->commit_transaction().ensure();
+      write_batcher_.on_committed(Time::now() - commit_start_time);
       set_promises(finished_writes_);
       cancel_timeout();
     }
@@ -1224,14 +1561,18 @@ class MessageDbAsync final : public MessageDbAsyncInterface {
 
     void start_up() final {
       sync_db_ = &sync_db_safe_->get();
+      if (!read_scheduler_ids_.empty()) {
+        read_pool_ = SqliteReadPool(read_scheduler_ids_);
+      }
+      send_closure_later(actor_id(this), &Impl::build_trigram_index);
     }
   };
   ActorOwn<Impl> impl_;
 };
 
 std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(std::shared_ptr<MessageDbSyncSafeInterface> sync_db,
-                                                                 int32 scheduler_id) {
-  return std::make_shared<MessageDbAsync>(std::move(sync_db), scheduler_id);
+                                                                 int32 scheduler_id, vector<int32> read_scheduler_ids) {
+  return std::make_shared<MessageDbAsync>(std::move(sync_db), scheduler_id, std::move(read_scheduler_ids));
 }
 
 }  // namespace td
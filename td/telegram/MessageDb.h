@@ -81,10 +81,18 @@ struct MessageDbFtsQuery {
   MessageSearchFilter filter{MessageSearchFilter::Empty};
   int64 from_search_id{0};
   int32 limit{100};
+  bool order_by_rank{false};  // if true, messages are sorted by relevance and offset is used instead of from_search_id
+  int32 offset{0};
+};
+struct MessageDbFtsMatch {
+  int32 offset;  // in UTF-16 code units of the message search text
+  int32 length;
 };
 struct MessageDbFtsResult {
   vector<MessageDbMessage> messages;
+  vector<vector<MessageDbFtsMatch>> matches;  // matched words for each message; returned only for ranked search
   int64 next_search_id{1};
+  int32 next_offset{0};
 };
 
 struct MessageDbCallsQuery {
@@ -134,6 +142,9 @@ class MessageDbSyncInterface {
   virtual MessageDbCallsResult get_calls(MessageDbCallsQuery query) = 0;
   virtual MessageDbFtsResult get_messages_fts(MessageDbFtsQuery query) = 0;
 
+  // adds up to limit old messages to the trigram search index; returns true if the index is complete
+  virtual bool build_trigram_index(int32 limit) = 0;
+
   virtual Status begin_write_transaction() = 0;
   virtual Status commit_transaction() = 0;
 };
@@ -193,13 +204,14 @@ class MessageDbAsyncInterface {
   virtual void force_flush() = 0;
 };
 
-Status init_message_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
+Status init_message_db(SqliteDb &db, int version, bool use_trigram_index = false) TD_WARN_UNUSED_RESULT;
 Status drop_message_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 
 std::shared_ptr<MessageDbSyncSafeInterface> create_message_db_sync(
     std::shared_ptr<SqliteConnectionSafe> sqlite_connection);
 
 std::shared_ptr<MessageDbAsyncInterface> create_message_db_async(std::shared_ptr<MessageDbSyncSafeInterface> sync_db,
-                                                                 int32 scheduler_id = -1);
+                                                                 int32 scheduler_id = -1,
+                                                                 vector<int32> read_scheduler_ids = {});
 
 }  // namespace td
@@ -11,6 +11,7 @@
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteStatement.h"
+#include "td/db/SqliteTransactionBatcher.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/SchedulerLocalStorage.h"
@@ -287,25 +288,19 @@ class MessageThreadDbAsync final : public MessageThreadDbAsyncInterface {
     std::shared_ptr<MessageThreadDbSyncSafeInterface> sync_db_safe_;
     MessageThreadDbSyncInterface *sync_db_ = nullptr;
 
-    static constexpr size_t MAX_PENDING_QUERIES_COUNT{50};
-    static constexpr double MAX_PENDING_QUERIES_DELAY{0.01};
+    SqliteTransactionBatcher write_batcher_{"MessageThreadDb"};
 
     //NB: order is important, destructor of pending_writes_ will change finished_writes_
     vector<Promise<Unit>> finished_writes_;
     vector<Promise<Unit>> pending_writes_;  // TODO use Action
-    double wakeup_at_ = 0;
 
     template <class F>
     void add_write_query(F &&f) {
       pending_writes_.push_back(PromiseCreator::lambda(std::forward<F>(f)));
-      if (pending_writes_.size() > MAX_PENDING_QUERIES_COUNT) {
+      if (write_batcher_.on_query_added()) {
         do_flush();
-        wakeup_at_ = 0;
-      } else if (wakeup_at_ == 0) {
-        wakeup_at_ = Time::now_cached() + MAX_PENDING_QUERIES_DELAY;
-      }
-      if (wakeup_at_ != 0) {
-        set_timeout_at(wakeup_at_);
+      } else {
+        set_timeout_at(write_batcher_.get_commit_time());
       }
     }
 
@@ -319,7 +314,9 @@ class MessageThreadDbAsync final : public MessageThreadDbAsyncInterface {
       }
       sync_db_->begin_write_transaction().ensure();
       set_promises(pending_writes_);
+      auto commit_start_time = Time::now();
       sync_db_->commit_transaction().ensure();
+      write_batcher_.on_committed(Time::now() - commit_start_time);
       set_promises(finished_writes_);
       cancel_timeout();
     }
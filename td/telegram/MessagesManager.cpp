@@ -107,6 +107,7 @@
 
 #include "td/utils/algorithm.h"
 #include "td/utils/format.h"
+#include "td/utils/Hints.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/Random.h"
@@ -21453,6 +21454,104 @@ void MessagesManager::on_message_db_fts_result(Result<MessageDbFtsResult> result
   promise.set_value(get_found_messages_object(found_messages, "on_message_db_fts_result"));
 }
 
+void MessagesManager::offline_search_messages_by_relevance(
+    DialogId dialog_id, const string &query, const string &offset, int32 limit, MessageSearchFilter filter,
+    Promise<td_api::object_ptr<td_api::foundRelevantMessages>> &&promise) {
+  if (!G()->use_message_database()) {
+    return promise.set_error(Status::Error(400, "Message database is required to search messages in secret chats"));
+  }
+  if (query.empty()) {
+    return promise.set_value(td_api::make_object<td_api::foundRelevantMessages>());
+  }
+  if (dialog_id != DialogId() && !have_dialog_force(dialog_id, "offline_search_messages_by_relevance")) {
+    return promise.set_error(Status::Error(400, "Chat not found"));
+  }
+  if (limit <= 0) {
+    return promise.set_error(Status::Error(400, "Limit must be positive"));
+  }
+  if (limit > MAX_SEARCH_MESSAGES) {
+    limit = MAX_SEARCH_MESSAGES;
+  }
+
+  MessageDbFtsQuery fts_query;
+  fts_query.query = query;
+  fts_query.dialog_id = dialog_id;
+  fts_query.filter = filter;
+  fts_query.order_by_rank = true;
+  if (!offset.empty()) {
+    auto r_offset = to_integer_safe<int32>(offset);
+    if (r_offset.is_error() || r_offset.ok() < 0) {
+      return promise.set_error(Status::Error(400, "Invalid offset specified"));
+    }
+    fts_query.offset = r_offset.ok();
+  }
+  fts_query.limit = limit;
+
+  G()->td_db()->get_message_db_async()->get_messages_fts(
+      std::move(fts_query),
+      PromiseCreator::lambda([limit, promise = std::move(promise)](Result<MessageDbFtsResult> fts_result) mutable {
+        send_closure(G()->messages_manager(), &MessagesManager::on_message_db_fts_relevance_result,
+                     std::move(fts_result), limit, std::move(promise));
+      }));
+}
+
+vector<td_api::object_ptr<td_api::messageTextMatch>> MessagesManager::get_message_text_match_objects(
+    const Message *m, const vector<MessageDbFtsMatch> &matches) const {
+  vector<td_api::object_ptr<td_api::messageTextMatch>> result;
+  const auto *text = get_message_content_text(m->content.get());
+  if (text == nullptr || text->text.empty()) {
+    return result;
+  }
+
+  // the matches are found in the message search text, which begins with the message text or ends with the caption
+  auto search_text = get_message_search_text(m);
+  int32 text_offset = 0;
+  if (!begins_with(search_text, text->text)) {
+    if (!ends_with(search_text, text->text)) {
+      return result;
+    }
+    text_offset =
+        narrow_cast<int32>(utf8_utf16_length(Slice(search_text).substr(0, search_text.size() - text->text.size())));
+  }
+  auto text_length = narrow_cast<int32>(utf8_utf16_length(text->text));
+  for (auto &match : matches) {
+    if (text_offset <= match.offset && match.offset + match.length <= text_offset + text_length) {
+      result.push_back(td_api::make_object<td_api::messageTextMatch>(match.offset - text_offset, match.length));
+    }
+  }
+  return result;
+}
+
+void MessagesManager::on_message_db_fts_relevance_result(
+    Result<MessageDbFtsResult> result, int32 limit,
+    Promise<td_api::object_ptr<td_api::foundRelevantMessages>> &&promise) {
+  G()->ignore_result_if_closing(result);
+  if (result.is_error()) {
+    return promise.set_error(result.move_as_error());
+  }
+  auto fts_result = result.move_as_ok();
+  CHECK(fts_result.matches.size() == fts_result.messages.size());
+
+  auto found_messages = td_api::make_object<td_api::foundRelevantMessages>();
+  for (size_t i = 0; i < fts_result.messages.size(); i++) {
+    const auto &message = fts_result.messages[i];
+    auto m = on_get_message_from_database(message, false, "on_message_db_fts_relevance_result");
+    if (m == nullptr) {
+      continue;
+    }
+    auto message_object = get_message_object(message.dialog_id, m, "on_message_db_fts_relevance_result");
+    if (message_object == nullptr) {
+      continue;
+    }
+    found_messages->messages_.push_back(td_api::make_object<td_api::foundRelevantMessage>(
+        std::move(message_object), get_message_text_match_objects(m, fts_result.matches[i])));
+  }
+  if (fts_result.messages.size() >= static_cast<size_t>(limit)) {
+    found_messages->next_offset_ = to_string(fts_result.next_offset);
+  }
+  promise.set_value(std::move(found_messages));
+}
+
 void MessagesManager::on_message_db_calls_result(Result<MessageDbCallsResult> result, MessageId first_db_message_id,
                                                  MessageId offset_message_id, int32 limit, MessageSearchFilter filter,
                                                  Promise<td_api::object_ptr<td_api::foundMessages>> &&promise) {
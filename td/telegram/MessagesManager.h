@@ -83,11 +83,11 @@
 #include "td/utils/buffer.h"
 #include "td/utils/ChangesProcessor.h"
 #include "td/utils/common.h"
+#include "td/utils/CompactHints.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/FlatHashSet.h"
 #include "td/utils/HashTableUtils.h"
 #include "td/utils/Heap.h"
-#include "td/utils/Hints.h"
 #include "td/utils/List.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
@@ -739,6 +739,10 @@ class MessagesManager final : public Actor {
                                MessageSearchFilter filter,
                                Promise<td_api::object_ptr<td_api::foundMessages>> &&promise);
 
+  void offline_search_messages_by_relevance(DialogId dialog_id, const string &query, const string &offset, int32 limit,
+                                            MessageSearchFilter filter,
+                                            Promise<td_api::object_ptr<td_api::foundRelevantMessages>> &&promise);
+
   void search_messages(DialogListId dialog_list_id, bool ignore_folder_id, bool broadcasts_only, const string &query,
                        const string &offset_str, int32 limit, MessageSearchFilter filter, int32 min_date,
                        int32 max_date, Promise<td_api::object_ptr<td_api::foundMessages>> &&promise);
@@ -2893,6 +2897,12 @@ class MessagesManager final : public Actor {
   void on_message_db_fts_result(Result<MessageDbFtsResult> result, string offset, int32 limit,
                                 Promise<td_api::object_ptr<td_api::foundMessages>> &&promise);
 
+  vector<td_api::object_ptr<td_api::messageTextMatch>> get_message_text_match_objects(
+      const Message *m, const vector<MessageDbFtsMatch> &matches) const;
+
+  void on_message_db_fts_relevance_result(Result<MessageDbFtsResult> result, int32 limit,
+                                          Promise<td_api::object_ptr<td_api::foundRelevantMessages>> &&promise);
+
   void on_message_db_calls_result(Result<MessageDbCallsResult> result, MessageId first_db_message_id,
                                   MessageId offset_message_id, int32 limit, MessageSearchFilter filter,
                                   Promise<td_api::object_ptr<td_api::foundMessages>> &&promise);
@@ -3407,7 +3417,7 @@ class MessagesManager final : public Actor {
 
   Timeout live_location_expire_timeout_;
 
-  Hints dialogs_hints_;  // search dialogs by title and usernames
+  CompactHints dialogs_hints_;  // search dialogs by title and usernames
 
   FlatHashSet<MessageFullId, MessageFullIdHash> active_live_location_message_full_ids_;
   bool are_active_live_location_messages_loaded_ = false;
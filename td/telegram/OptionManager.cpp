@@ -976,6 +976,9 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       }
       break;
     case 'u':
+      if (set_boolean_option("use_file_preallocation")) {
+        return;
+      }
       if (set_boolean_option("use_pfs")) {
         return;
       }
@@ -985,6 +988,9 @@ void OptionManager::set_option(const string &name, td_api::object_ptr<td_api::Op
       if (set_boolean_option("use_storage_optimizer")) {
         return;
       }
+      if (set_boolean_option("use_storage_statistics_snapshot")) {
+        return;
+      }
       if (set_integer_option("utc_time_offset", -12 * 60 * 60, 14 * 60 * 60)) {
         return;
       }
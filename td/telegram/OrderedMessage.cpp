@@ -6,30 +6,89 @@
 //
 #include "td/telegram/OrderedMessage.h"
 
+#include "td/utils/algorithm.h"
 #include "td/utils/logging.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace td {
 
-void OrderedMessages::insert(MessageId message_id, bool auto_attach, MessageId old_last_message_id,
-                             const char *source) {
-  auto random_y = static_cast<int32>(static_cast<uint32>(message_id.get() * 2101234567u));
-  unique_ptr<OrderedMessage> *v = &messages_;
-  while (*v != nullptr && (*v)->random_y_ >= random_y) {
-    if ((*v)->message_id_.get() < message_id.get()) {
-      v = &(*v)->right_;
-    } else if ((*v)->message_id_ == message_id) {
+bool OrderedMessages::find_position(const vector<Chunk> &chunks, MessageId message_id, Position &position) {
+  auto id = message_id.get();
+  auto chunk_it = std::upper_bound(chunks.begin(), chunks.end(), id,
+                                   [](int64 lhs, const Chunk &chunk) { return lhs < chunk[0].message_id_.get(); });
+  if (chunk_it == chunks.begin()) {
+    return false;
+  }
+  --chunk_it;
+  auto it = std::upper_bound(chunk_it->begin(), chunk_it->end(), id,
+                             [](int64 lhs, const OrderedMessage &message) { return lhs < message.message_id_.get(); });
+  CHECK(it != chunk_it->begin());
+  position.chunk_pos = static_cast<size_t>(chunk_it - chunks.begin());
+  position.pos = static_cast<size_t>(it - chunk_it->begin()) - 1;
+  return true;
+}
+
+OrderedMessage *OrderedMessages::get_next_message(MessageId message_id) {
+  Position position;
+  if (!find_position(chunks_, message_id, position)) {
+    return chunks_.empty() ? nullptr : &chunks_[0][0];
+  }
+  if (++position.pos == chunks_[position.chunk_pos].size()) {
+    position.pos = 0;
+    if (++position.chunk_pos == chunks_.size()) {
+      return nullptr;
+    }
+  }
+  return &chunks_[position.chunk_pos][position.pos];
+}
+
+void OrderedMessages::do_insert(const OrderedMessage &message) {
+  if (chunks_.empty()) {
+    chunks_.emplace_back();
+    chunks_[0].push_back(message);
+    return;
+  }
+
+  Position position;
+  if (find_position(chunks_, message.message_id_, position)) {
+    if (chunks_[position.chunk_pos][position.pos].message_id_ == message.message_id_) {
       UNREACHABLE();
-    } else {
-      v = &(*v)->left_;
     }
+    position.pos++;
   }
 
-  auto message = make_unique<OrderedMessage>();
-  message->message_id_ = message_id;
-  message->random_y_ = random_y;
+  auto *chunk = &chunks_[position.chunk_pos];
+  if (chunk->size() == MAX_CHUNK_SIZE) {
+    // messages are usually added to the ends of the history, so the chunks are kept full in that case
+    if (position.pos == MAX_CHUNK_SIZE || position.pos == 0) {
+      auto new_chunk_pos = position.pos == 0 ? position.chunk_pos : position.chunk_pos + 1;
+      auto new_chunk_it = chunks_.emplace(chunks_.begin() + new_chunk_pos);
+      new_chunk_it->push_back(message);
+      return;
+    }
+
+    auto half = MAX_CHUNK_SIZE / 2;
+    Chunk new_chunk(chunk->begin() + half, chunk->end());
+    chunk->erase(chunk->begin() + half, chunk->end());
+    chunks_.insert(chunks_.begin() + position.chunk_pos + 1, std::move(new_chunk));
+    if (position.pos > half) {
+      position.chunk_pos++;
+      position.pos -= half;
+    }
+    chunk = &chunks_[position.chunk_pos];
+  }
+  chunk->insert(chunk->begin() + position.pos, message);
+}
+
+void OrderedMessages::insert(MessageId message_id, bool auto_attach, MessageId old_last_message_id,
+                             const char *source) {
+  OrderedMessage message;
+  message.message_id_ = message_id;
 
   if (auto_attach) {
-    auto_attach_message(message.get(), old_last_message_id, source);
+    auto_attach_message(&message, old_last_message_id, source);
   } else {
     auto it = get_iterator(message_id);
     if (*it != nullptr && (*it)->have_next_) {
@@ -46,72 +105,53 @@ void OrderedMessages::insert(MessageId message_id, bool auto_attach, MessageId o
     }
   }
 
-  unique_ptr<OrderedMessage> *left = &message->left_;
-  unique_ptr<OrderedMessage> *right = &message->right_;
-
-  unique_ptr<OrderedMessage> cur = std::move(*v);
-  while (cur != nullptr) {
-    if (cur->message_id_.get() < message_id.get()) {
-      *left = std::move(cur);
-      left = &((*left)->right_);
-      cur = std::move(*left);
-    } else {
-      *right = std::move(cur);
-      right = &((*right)->left_);
-      cur = std::move(*right);
-    }
-  }
-  CHECK(*left == nullptr);
-  CHECK(*right == nullptr);
-  *v = std::move(message);
+  do_insert(message);
 }
 
 void OrderedMessages::erase(MessageId message_id, bool only_from_memory) {
-  unique_ptr<OrderedMessage> *v = &messages_;
-  while (*v != nullptr) {
-    if ((*v)->message_id_.get() < message_id.get()) {
-      v = &(*v)->right_;
-    } else if ((*v)->message_id_.get() > message_id.get()) {
-      v = &(*v)->left_;
-    } else {
-      break;
-    }
-  }
-
-  CHECK(*v != nullptr);
-  if ((*v)->have_previous_ && (only_from_memory || !(*v)->have_next_)) {
+  Position position;
+  CHECK(find_position(chunks_, message_id, position));
+  auto *chunk = &chunks_[position.chunk_pos];
+  const auto &message = (*chunk)[position.pos];
+  CHECK(message.message_id_ == message_id);
+  if (message.have_previous_ && (only_from_memory || !message.have_next_)) {
     auto it = get_iterator(message_id);
-    CHECK(*it == v->get());
     --it;
     OrderedMessage *prev_m = *it;
     CHECK(prev_m != nullptr);
     prev_m->have_next_ = false;
   }
-  if ((*v)->have_next_ && (only_from_memory || !(*v)->have_previous_)) {
+  if (message.have_next_ && (only_from_memory || !message.have_previous_)) {
     auto it = get_iterator(message_id);
-    CHECK(*it == v->get());
     ++it;
     OrderedMessage *next_m = *it;
     CHECK(next_m != nullptr);
     next_m->have_previous_ = false;
   }
 
-  unique_ptr<OrderedMessage> result = std::move(*v);
-  unique_ptr<OrderedMessage> left = std::move(result->left_);
-  unique_ptr<OrderedMessage> right = std::move(result->right_);
-
-  while (left != nullptr || right != nullptr) {
-    if (left == nullptr || (right != nullptr && right->random_y_ > left->random_y_)) {
-      *v = std::move(right);
-      v = &((*v)->left_);
-      right = std::move(*v);
-    } else {
-      *v = std::move(left);
-      v = &((*v)->right_);
-      left = std::move(*v);
+  chunk->erase(chunk->begin() + position.pos);
+  if (chunk->empty()) {
+    chunks_.erase(chunks_.begin() + position.chunk_pos);
+    return;
+  }
+
+  // merge sparse neighbouring chunks to keep the number of chunks proportional to the number of messages
+  if (chunk->size() < MAX_CHUNK_SIZE / 4) {
+    auto merge_pos = position.chunk_pos;
+    if (merge_pos + 1 == chunks_.size() ||
+        (merge_pos > 0 && chunks_[merge_pos - 1].size() < chunks_[merge_pos + 1].size())) {
+      if (merge_pos == 0) {
+        return;
+      }
+      merge_pos--;
+    }
+    auto &left = chunks_[merge_pos];
+    auto &right = chunks_[merge_pos + 1];
+    if (left.size() + right.size() <= MAX_CHUNK_SIZE / 2) {
+      append(left, std::move(right));
+      chunks_.erase(chunks_.begin() + merge_pos + 1);
     }
   }
-  CHECK(*v == nullptr);
 }
 
 void OrderedMessages::attach_message_to_previous(MessageId message_id, const char *source) {
@@ -181,16 +221,7 @@ void OrderedMessages::auto_attach_message(OrderedMessage *message, MessageId las
   }
   if (!message_id.is_yet_unsent()) {
     // message may be attached to the next message if there is no previous message
-    OrderedMessage *cur = messages_.get();
-    OrderedMessage *next_message = nullptr;
-    while (cur != nullptr) {
-      if (cur->message_id_ < message_id) {
-        cur = cur->right_.get();
-      } else {
-        next_message = cur;
-        cur = cur->left_.get();
-      }
-    }
+    OrderedMessage *next_message = get_next_message(message_id);
     if (next_message != nullptr) {
       CHECK(!next_message->have_previous_);
       LOG(INFO) << "Attach " << message_id << " to the next " << next_message->message_id_ << " from " << source;
@@ -203,117 +234,98 @@ void OrderedMessages::auto_attach_message(OrderedMessage *message, MessageId las
   LOG(INFO) << "Can't auto-attach " << message_id << " from " << source;
 }
 
-void OrderedMessages::do_find_older_messages(const OrderedMessage *ordered_message, MessageId max_message_id,
-                                             vector<MessageId> &message_ids) {
-  if (ordered_message == nullptr) {
-    return;
-  }
-
-  do_find_older_messages(ordered_message->left_.get(), max_message_id, message_ids);
-
-  if (ordered_message->message_id_ <= max_message_id) {
-    message_ids.push_back(ordered_message->message_id_);
-
-    do_find_older_messages(ordered_message->right_.get(), max_message_id, message_ids);
-  }
-}
-
 vector<MessageId> OrderedMessages::find_older_messages(MessageId max_message_id) const {
   vector<MessageId> message_ids;
-  do_find_older_messages(messages_.get(), max_message_id, message_ids);
-  return message_ids;
-}
-
-void OrderedMessages::do_find_newer_messages(const OrderedMessage *ordered_message, MessageId min_message_id,
-                                             vector<MessageId> &message_ids) {
-  if (ordered_message == nullptr) {
-    return;
-  }
-
-  if (ordered_message->message_id_ > min_message_id) {
-    do_find_newer_messages(ordered_message->left_.get(), min_message_id, message_ids);
-
-    message_ids.push_back(ordered_message->message_id_);
+  for (const auto &chunk : chunks_) {
+    for (const auto &message : chunk) {
+      if (message.message_id_ > max_message_id) {
+        return message_ids;
+      }
+      message_ids.push_back(message.message_id_);
+    }
   }
-
-  do_find_newer_messages(ordered_message->right_.get(), min_message_id, message_ids);
+  return message_ids;
 }
 
 vector<MessageId> OrderedMessages::find_newer_messages(MessageId min_message_id) const {
   vector<MessageId> message_ids;
-  do_find_newer_messages(messages_.get(), min_message_id, message_ids);
-  return message_ids;
-}
-
-MessageId OrderedMessages::do_find_message_by_date(const OrderedMessage *ordered_message, int32 date,
-                                                   const std::function<int32(MessageId)> &get_message_date) {
-  if (ordered_message == nullptr) {
-    return MessageId();
-  }
-
-  auto message_date = get_message_date(ordered_message->message_id_);
-  if (message_date > date) {
-    return do_find_message_by_date(ordered_message->left_.get(), date, get_message_date);
+  Position position;
+  if (find_position(chunks_, min_message_id, position)) {
+    position.pos++;
   }
-
-  auto message_id = do_find_message_by_date(ordered_message->right_.get(), date, get_message_date);
-  if (message_id.is_valid()) {
-    return message_id;
+  for (size_t chunk_pos = position.chunk_pos; chunk_pos < chunks_.size(); chunk_pos++) {
+    const auto &chunk = chunks_[chunk_pos];
+    for (size_t pos = chunk_pos == position.chunk_pos ? position.pos : 0; pos < chunk.size(); pos++) {
+      message_ids.push_back(chunk[pos].message_id_);
+    }
   }
-
-  return ordered_message->message_id_;
+  return message_ids;
 }
 
 MessageId OrderedMessages::find_message_by_date(int32 date,
                                                 const std::function<int32(MessageId)> &get_message_date) const {
-  return do_find_message_by_date(messages_.get(), date, get_message_date);
-}
-
-void OrderedMessages::do_find_messages_by_date(const OrderedMessage *ordered_message, int32 min_date, int32 max_date,
-                                               const std::function<int32(MessageId)> &get_message_date,
-                                               vector<MessageId> &message_ids) {
-  if (ordered_message == nullptr) {
-    return;
-  }
-
-  auto message_date = get_message_date(ordered_message->message_id_);
-  if (message_date >= min_date) {
-    do_find_messages_by_date(ordered_message->left_.get(), min_date, max_date, get_message_date, message_ids);
-    if (message_date <= max_date) {
-      message_ids.push_back(ordered_message->message_id_);
-    }
-  }
-  if (message_date <= max_date) {
-    do_find_messages_by_date(ordered_message->right_.get(), min_date, max_date, get_message_date, message_ids);
+  // message dates are expected to be non-decreasing, so the last message with date not greater than date is found
+  auto chunk_it = std::upper_bound(chunks_.begin(), chunks_.end(), date, [&](int32 lhs, const Chunk &chunk) {
+    return lhs < get_message_date(chunk[0].message_id_);
+  });
+  if (chunk_it == chunks_.begin()) {
+    return MessageId();
   }
+  --chunk_it;
+  auto it = std::upper_bound(chunk_it->begin() + 1, chunk_it->end(), date,
+                             [&](int32 lhs, const OrderedMessage &message) {
+                               return lhs < get_message_date(message.message_id_);
+                             });
+  --it;
+  return it->message_id_;
 }
 
 vector<MessageId> OrderedMessages::find_messages_by_date(
     int32 min_date, int32 max_date, const std::function<int32(MessageId)> &get_message_date) const {
   vector<MessageId> message_ids;
-  do_find_messages_by_date(messages_.get(), min_date, max_date, get_message_date, message_ids);
-  return message_ids;
-}
-
-void OrderedMessages::do_traverse_messages(const OrderedMessage *ordered_message,
-                                           const std::function<bool(MessageId)> &need_scan_older,
-                                           const std::function<bool(MessageId)> &need_scan_newer) {
-  if (ordered_message == nullptr) {
-    return;
+  auto chunk_it = std::lower_bound(chunks_.begin(), chunks_.end(), min_date, [&](const Chunk &chunk, int32 rhs) {
+    return get_message_date(chunk.back().message_id_) < rhs;
+  });
+  if (chunk_it == chunks_.end()) {
+    return message_ids;
   }
-
-  if (need_scan_older(ordered_message->message_id_)) {
-    do_traverse_messages(ordered_message->left_.get(), need_scan_older, need_scan_newer);
+  auto it = std::lower_bound(chunk_it->begin(), chunk_it->end(), min_date,
+                             [&](const OrderedMessage &message, int32 rhs) {
+                               return get_message_date(message.message_id_) < rhs;
+                             });
+  while (true) {
+    if (it == chunk_it->end()) {
+      if (++chunk_it == chunks_.end()) {
+        break;
+      }
+      it = chunk_it->begin();
+    }
+    auto message_date = get_message_date(it->message_id_);
+    if (message_date > max_date) {
+      break;
+    }
+    if (message_date >= min_date) {
+      message_ids.push_back(it->message_id_);
+    }
+    ++it;
   }
+  return message_ids;
+}
 
-  if (need_scan_newer(ordered_message->message_id_)) {
-    do_traverse_messages(ordered_message->right_.get(), need_scan_older, need_scan_newer);
+size_t OrderedMessages::size() const {
+  size_t result = 0;
+  for (const auto &chunk : chunks_) {
+    result += chunk.size();
   }
+  return result;
 }
 
-void OrderedMessages::traverse_messages(const std::function<bool(MessageId)> &need_scan_older,
-                                        const std::function<bool(MessageId)> &need_scan_newer) const {
-  do_traverse_messages(messages_.get(), need_scan_older, need_scan_newer);
+size_t OrderedMessages::get_memory_usage() const {
+  size_t result = chunks_.capacity() * sizeof(Chunk);
+  for (const auto &chunk : chunks_) {
+    result += chunk.capacity() * sizeof(OrderedMessage);
+  }
+  return result;
 }
 
 vector<MessageId> OrderedMessages::get_history(MessageId last_message_id, MessageId &from_message_id, int32 &offset,
@@ -341,14 +353,8 @@ vector<MessageId> OrderedMessages::get_history(MessageId last_message_id, Messag
     bool have_a_gap = false;
     if (*it == nullptr) {
       // there is no gap if from_message_id is less than the first message
-      if (force && offset < 0 && messages_ != nullptr) {
-        MessageId min_message_id;
-        traverse_messages(
-            [&](MessageId message_id) {
-              min_message_id = message_id;
-              return true;
-            },
-            [](MessageId) { return false; });
+      if (force && offset < 0 && !chunks_.empty()) {
+        auto min_message_id = chunks_[0][0].message_id_;
         CHECK(min_message_id > from_message_id);
         from_message_id = min_message_id;
         it = get_const_iterator(from_message_id);
@@ -25,46 +25,48 @@ class OrderedMessage {
   }
 
  private:
-  int32 random_y_ = 0;
+  MessageId message_id_;
 
   bool have_previous_ = false;
   bool have_next_ = false;
 
-  MessageId message_id_;
-
-  unique_ptr<OrderedMessage> left_;
-  unique_ptr<OrderedMessage> right_;
-
   friend class OrderedMessages;
 };
 
 class OrderedMessages {
+  // messages are stored sorted by identifier in contiguous chunks of at most MAX_CHUNK_SIZE elements
+  // to avoid a heap allocation per message and pointer chasing during traversals
+  static constexpr size_t MAX_CHUNK_SIZE = 256;
+
+  using Chunk = vector<OrderedMessage>;
+
+  struct Position {
+    size_t chunk_pos = 0;
+    size_t pos = 0;
+  };
+
+  // finds position of the message with the greatest identifier which is less or equal than message_id
+  static bool find_position(const vector<Chunk> &chunks, MessageId message_id, Position &position);
+
  public:
   class IteratorBase {
-    vector<const OrderedMessage *> stack_;
+    const vector<Chunk> *chunks_ = nullptr;
+    Position position_;
 
    protected:
     IteratorBase() = default;
 
     // points iterator to message with greatest identifier which is less or equal than message_id
-    IteratorBase(const OrderedMessage *root, MessageId message_id) {
+    IteratorBase(const vector<Chunk> *chunks, MessageId message_id) {
       CHECK(!message_id.is_scheduled());
 
-      size_t last_right_pos = 0;
-      while (root != nullptr) {
-        stack_.push_back(root);
-        if (root->message_id_ <= message_id) {
-          last_right_pos = stack_.size();
-          root = root->right_.get();
-        } else {
-          root = root->left_.get();
-        }
+      if (find_position(*chunks, message_id, position_)) {
+        chunks_ = chunks;
       }
-      stack_.resize(last_right_pos);
     }
 
     const OrderedMessage *operator*() const {
-      return stack_.empty() ? nullptr : stack_.back();
+      return chunks_ == nullptr ? nullptr : &(*chunks_)[position_.chunk_pos][position_.pos];
     }
 
     ~IteratorBase() = default;
@@ -76,69 +78,45 @@ class OrderedMessages {
     IteratorBase &operator=(IteratorBase &&) = default;
 
     void operator++() {
-      if (stack_.empty()) {
+      if (chunks_ == nullptr) {
         return;
       }
 
-      const OrderedMessage *cur = stack_.back();
-      if (!cur->have_next_) {
-        stack_.clear();
+      const auto &chunk = (*chunks_)[position_.chunk_pos];
+      if (!chunk[position_.pos].have_next_) {
+        clear();
         return;
       }
-      if (cur->right_ == nullptr) {
-        while (true) {
-          stack_.pop_back();
-          if (stack_.empty()) {
-            return;
-          }
-          const OrderedMessage *new_cur = stack_.back();
-          if (new_cur->left_.get() == cur) {
-            return;
-          }
-          cur = new_cur;
+      if (++position_.pos == chunk.size()) {
+        position_.pos = 0;
+        if (++position_.chunk_pos == chunks_->size()) {
+          clear();
         }
       }
-
-      cur = cur->right_.get();
-      while (cur != nullptr) {
-        stack_.push_back(cur);
-        cur = cur->left_.get();
-      }
     }
 
     void operator--() {
-      if (stack_.empty()) {
+      if (chunks_ == nullptr) {
         return;
       }
 
-      const OrderedMessage *cur = stack_.back();
-      if (!cur->have_previous_) {
-        stack_.clear();
+      if (!(*chunks_)[position_.chunk_pos][position_.pos].have_previous_) {
+        clear();
         return;
       }
-      if (cur->left_ == nullptr) {
-        while (true) {
-          stack_.pop_back();
-          if (stack_.empty()) {
-            return;
-          }
-          const OrderedMessage *new_cur = stack_.back();
-          if (new_cur->right_.get() == cur) {
-            return;
-          }
-          cur = new_cur;
+      if (position_.pos == 0) {
+        if (position_.chunk_pos == 0) {
+          clear();
+          return;
         }
+        position_.chunk_pos--;
+        position_.pos = (*chunks_)[position_.chunk_pos].size();
       }
-
-      cur = cur->left_.get();
-      while (cur != nullptr) {
-        stack_.push_back(cur);
-        cur = cur->right_.get();
-      }
+      position_.pos--;
     }
 
     void clear() {
-      stack_.clear();
+      chunks_ = nullptr;
     }
   };
 
@@ -146,7 +124,7 @@ class OrderedMessages {
    public:
     ConstIterator() = default;
 
-    ConstIterator(const OrderedMessage *root, MessageId message_id) : IteratorBase(root, message_id) {
+    ConstIterator(const vector<Chunk> *chunks, MessageId message_id) : IteratorBase(chunks, message_id) {
     }
 
     const OrderedMessage *operator*() const {
@@ -155,7 +133,7 @@ class OrderedMessages {
   };
 
   ConstIterator get_const_iterator(MessageId message_id) const {
-    return ConstIterator(messages_.get(), message_id);
+    return ConstIterator(&chunks_, message_id);
   }
 
   void insert(MessageId message_id, bool auto_attach, MessageId old_last_message_id, const char *source);
@@ -175,23 +153,25 @@ class OrderedMessages {
   vector<MessageId> find_messages_by_date(int32 min_date, int32 max_date,
                                           const std::function<int32(MessageId)> &get_message_date) const;
 
-  void traverse_messages(const std::function<bool(MessageId)> &need_scan_older,
-                         const std::function<bool(MessageId)> &need_scan_newer) const;
-
   // returns identifiers of the requested messages; adjust from_message_id, offset and limit accordingly
   vector<MessageId> get_history(MessageId last_message_id, MessageId &from_message_id, int32 &offset, int32 &limit,
                                 bool force) const;
 
   bool empty() const {
-    return messages_ == nullptr;
+    return chunks_.empty();
   }
 
+  size_t size() const;
+
+  // returns number of bytes allocated for the stored messages
+  size_t get_memory_usage() const;
+
  private:
   class Iterator final : public IteratorBase {
    public:
     Iterator() = default;
 
-    Iterator(OrderedMessage *root, MessageId message_id) : IteratorBase(root, message_id) {
+    Iterator(const vector<Chunk> *chunks, MessageId message_id) : IteratorBase(chunks, message_id) {
     }
 
     OrderedMessage *operator*() const {
@@ -202,27 +182,15 @@ class OrderedMessages {
   void auto_attach_message(OrderedMessage *message, MessageId last_message_id, const char *source);
 
   Iterator get_iterator(MessageId message_id) {
-    return Iterator(messages_.get(), message_id);
+    return Iterator(&chunks_, message_id);
   }
 
-  static void do_find_older_messages(const OrderedMessage *ordered_message, MessageId max_message_id,
-                                     vector<MessageId> &message_ids);
-
-  static void do_find_newer_messages(const OrderedMessage *ordered_message, MessageId min_message_id,
-                                     vector<MessageId> &message_ids);
-
-  static MessageId do_find_message_by_date(const OrderedMessage *ordered_message, int32 date,
-                                           const std::function<int32(MessageId)> &get_message_date);
-
-  static void do_find_messages_by_date(const OrderedMessage *ordered_message, int32 min_date, int32 max_date,
-                                       const std::function<int32(MessageId)> &get_message_date,
-                                       vector<MessageId> &message_ids);
+  // returns the message with the least identifier which is greater than message_id
+  OrderedMessage *get_next_message(MessageId message_id);
 
-  static void do_traverse_messages(const OrderedMessage *ordered_message,
-                                   const std::function<bool(MessageId)> &need_scan_older,
-                                   const std::function<bool(MessageId)> &need_scan_newer);
+  void do_insert(const OrderedMessage &message);
 
-  unique_ptr<OrderedMessage> messages_;
+  vector<Chunk> chunks_;
 };
 
 }  // namespace td
@@ -3181,6 +3181,16 @@ void Requests::on_request(uint64 id, td_api::searchSecretMessages &request) {
                                                   get_message_search_filter(request.filter_), std::move(promise));
 }
 
+void Requests::on_request(uint64 id, td_api::searchSecretMessagesByRelevance &request) {
+  CHECK_IS_USER();
+  CLEAN_INPUT_STRING(request.query_);
+  CLEAN_INPUT_STRING(request.offset_);
+  CREATE_REQUEST_PROMISE();
+  td_->messages_manager_->offline_search_messages_by_relevance(
+      DialogId(request.chat_id_), std::move(request.query_), std::move(request.offset_), request.limit_,
+      get_message_search_filter(request.filter_), std::move(promise));
+}
+
 void Requests::on_request(uint64 id, td_api::searchMessages &request) {
   CHECK_IS_USER();
   CLEAN_INPUT_STRING(request.query_);
@@ -7753,6 +7763,14 @@ void Requests::on_request(uint64 id, const td_api::addLogMessage &request) {
   UNREACHABLE();
 }
 
+void Requests::on_request(uint64 id, const td_api::setActorProfilerSamplingPeriod &request) {
+  UNREACHABLE();
+}
+
+void Requests::on_request(uint64 id, const td_api::getActorProfile &request) {
+  UNREACHABLE();
+}
+
 // test
 void Requests::on_request(uint64 id, const td_api::testNetwork &request) {
   CREATE_OK_REQUEST_PROMISE();
@@ -432,6 +432,8 @@ class Requests {
 
   void on_request(uint64 id, td_api::searchSecretMessages &request);
 
+  void on_request(uint64 id, td_api::searchSecretMessagesByRelevance &request);
+
   void on_request(uint64 id, td_api::searchMessages &request);
 
   void on_request(uint64 id, td_api::searchSavedMessages &request);
@@ -1662,6 +1664,10 @@ class Requests {
 
   void on_request(uint64 id, const td_api::addLogMessage &request);
 
+  void on_request(uint64 id, const td_api::setActorProfilerSamplingPeriod &request);
+
+  void on_request(uint64 id, const td_api::getActorProfile &request);
+
   void on_request(uint64 id, const td_api::testNetwork &request);
 
   void on_request(uint64 id, td_api::testProxy &request);
@@ -1726,8 +1726,9 @@ StickersManager::~StickersManager() {
       G()->get_gc_scheduler_id(), stickers_, sticker_sets_, short_name_to_sticker_set_id_, attached_sticker_sets_,
       found_stickers_[0], found_stickers_[1], found_stickers_[2], found_sticker_sets_[0], found_sticker_sets_[1],
       found_sticker_sets_[2], emoji_language_codes_, emoji_language_code_versions_,
-      emoji_language_code_last_difference_times_, reloaded_emoji_keywords_, premium_gift_messages_, dice_messages_,
-      dice_quick_reply_messages_, emoji_messages_, custom_emoji_messages_, custom_emoji_to_sticker_id_);
+      emoji_language_code_last_difference_times_, reloaded_emoji_keywords_, emoji_keyword_indexes_,
+      premium_gift_messages_, dice_messages_, dice_quick_reply_messages_, emoji_messages_, custom_emoji_messages_,
+      custom_emoji_to_sticker_id_);
 }
 
 void StickersManager::start_up() {
@@ -9762,22 +9763,72 @@ string StickersManager::get_language_emojis_database_key(const string &language_
 vector<std::pair<string, string>> StickersManager::search_language_emojis(const string &language_code,
                                                                           const string &text) {
   LOG(INFO) << "Search emoji for \"" << text << "\" in language " << language_code;
-  auto key = get_language_emojis_database_key(language_code, text);
-  vector<std::pair<string, string>> result;
-  G()->td_db()->get_sqlite_sync_pmc()->get_by_prefix(key, [&text, &result](Slice key, Slice value) {
-    for (const auto &emoji : full_split(value, '$')) {
-      result.emplace_back(emoji.str(), PSTRING() << text << key);
-    }
-    return true;
-  });
-  return result;
+  auto index = get_emoji_keyword_index(language_code);
+  if (index == nullptr) {
+    return {};
+  }
+  return index->search(text);
 }
 
 vector<string> StickersManager::get_keyword_language_emojis(const string &language_code, const string &text) {
   LOG(INFO) << "Get emoji for \"" << text << "\" in language " << language_code;
-  auto key = get_language_emojis_database_key(language_code, text);
-  string emojis = G()->td_db()->get_sqlite_sync_pmc()->get(key);
-  return full_split(emojis, '$');
+  auto index = get_emoji_keyword_index(language_code);
+  if (index == nullptr) {
+    return {};
+  }
+  return index->get_emojis(text);
+}
+
+EmojiKeywordIndex *StickersManager::get_emoji_keyword_index(const string &language_code) {
+  auto it = emoji_keyword_indexes_.find(language_code);
+  if (it == emoji_keyword_indexes_.end()) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+
+void StickersManager::load_emoji_keyword_index(const string &language_code, Promise<Unit> &&promise) {
+  if (get_emoji_keyword_index(language_code) != nullptr) {
+    return promise.set_value(Unit());
+  }
+
+  auto &promises = load_emoji_keyword_index_queries_[language_code];
+  promises.push_back(std::move(promise));
+  if (promises.size() != 1) {
+    // query has already been sent, just wait for the result
+    return;
+  }
+
+  LOG(INFO) << "Load emoji keywords for language " << language_code << " from database";
+  CHECK(G()->use_sqlite_pmc());
+  G()->td_db()->get_sqlite_pmc()->get_by_prefix(
+      get_language_emojis_database_key(language_code, string()),
+      PromiseCreator::lambda([actor_id = actor_id(this),
+                              language_code](Result<vector<std::pair<string, string>>> &&result) mutable {
+        send_closure(actor_id, &StickersManager::on_load_emoji_keyword_index, language_code, std::move(result));
+      }));
+}
+
+void StickersManager::on_load_emoji_keyword_index(const string &language_code,
+                                                  Result<vector<std::pair<string, string>>> &&r_keyword_emojis) {
+  auto it = load_emoji_keyword_index_queries_.find(language_code);
+  CHECK(it != load_emoji_keyword_index_queries_.end());
+  auto promises = std::move(it->second);
+  CHECK(!promises.empty());
+  load_emoji_keyword_index_queries_.erase(it);
+
+  G()->ignore_result_if_closing(r_keyword_emojis);
+  if (r_keyword_emojis.is_error()) {
+    return fail_promises(promises, r_keyword_emojis.move_as_error());
+  }
+
+  auto &index = emoji_keyword_indexes_[language_code];
+  if (index == nullptr) {
+    // the index could have been created from a server response while the keywords were loaded
+    index = td::make_unique<EmojiKeywordIndex>(r_keyword_emojis.move_as_ok());
+    LOG(INFO) << "Loaded " << index->size() << " emoji keywords for language " << language_code;
+  }
+  set_promises(promises);
 }
 
 string StickersManager::get_emoji_language_codes_database_key(const vector<string> &language_codes) {
@@ -9964,6 +10015,7 @@ void StickersManager::on_get_emoji_keywords(
 
   auto keywords = result.move_as_ok();
   LOG(INFO) << "Receive " << keywords->keywords_.size() << " emoji keywords for language " << language_code;
+  vector<std::pair<string, string>> keyword_emojis;
   LOG_IF(ERROR, language_code != keywords->lang_code_)
       << "Receive keywords for " << keywords->lang_code_ << " instead of " << language_code;
   LOG_IF(ERROR, keywords->from_version_ != 0) << "Receive keywords from version " << keywords->from_version_;
@@ -9984,10 +10036,14 @@ void StickersManager::on_get_emoji_keywords(
             is_good = false;
           }
         }
-        if (is_good && !G()->close_flag()) {
-          CHECK(G()->use_sqlite_pmc());
-          G()->td_db()->get_sqlite_pmc()->set(get_language_emojis_database_key(language_code, text),
-                                              implode(keyword->emoticons_, '$'), mpas.get_promise());
+        if (is_good) {
+          auto emojis = implode(keyword->emoticons_, '$');
+          if (!G()->close_flag()) {
+            CHECK(G()->use_sqlite_pmc());
+            G()->td_db()->get_sqlite_pmc()->set(get_language_emojis_database_key(language_code, text), emojis,
+                                                mpas.get_promise());
+          }
+          keyword_emojis.emplace_back(std::move(text), std::move(emojis));
         }
         break;
       }
@@ -10007,6 +10063,7 @@ void StickersManager::on_get_emoji_keywords(
   }
   emoji_language_code_versions_[language_code] = version;
   emoji_language_code_last_difference_times_[language_code] = static_cast<int32>(Time::now_cached());
+  emoji_keyword_indexes_[language_code] = td::make_unique<EmojiKeywordIndex>(std::move(keyword_emojis));
 
   lock.set_value(Unit());
 }
@@ -10038,6 +10095,19 @@ void StickersManager::on_get_emoji_keywords_difference(
     return;
   }
 
+  auto index = get_emoji_keyword_index(language_code);
+  if (index == nullptr) {
+    // the difference must be applied to the current keywords
+    return load_emoji_keyword_index(
+        language_code, PromiseCreator::lambda([actor_id = actor_id(this), language_code, from_version,
+                                               result = std::move(result)](Result<Unit> load_result) mutable {
+          if (load_result.is_ok()) {
+            send_closure(actor_id, &StickersManager::on_get_emoji_keywords_difference, language_code, from_version,
+                         std::move(result));
+          }
+        }));
+  }
+
   auto version = get_emoji_language_code_version(language_code);
   CHECK(version == from_version);
 
@@ -10069,7 +10139,7 @@ void StickersManager::on_get_emoji_keywords_difference(
           }
         }
         if (is_good) {
-          vector<string> emojis = get_keyword_language_emojis(language_code, text);
+          vector<string> emojis = index->get_emojis(text);
           bool is_changed = false;
           for (auto &emoji : keyword->emoticons_) {
             if (!td::contains(emojis, emoji)) {
@@ -10078,7 +10148,8 @@ void StickersManager::on_get_emoji_keywords_difference(
             }
           }
           if (is_changed) {
-            key_values.emplace(get_language_emojis_database_key(language_code, text), implode(emojis, '$'));
+            key_values[get_language_emojis_database_key(language_code, text)] = implode(emojis, '$');
+            index->set_emojis(text, emojis);
           } else {
             LOG(INFO) << "Emoji keywords not changed for \"" << text << "\" from version " << from_version
                       << " to version " << version;
@@ -10089,7 +10160,7 @@ void StickersManager::on_get_emoji_keywords_difference(
       case telegram_api::emojiKeywordDeleted::ID: {
         auto keyword = telegram_api::move_object_as<telegram_api::emojiKeywordDeleted>(keyword_ptr);
         auto text = utf8_to_lower(keyword->keyword_);
-        vector<string> emojis = get_keyword_language_emojis(language_code, text);
+        vector<string> emojis = index->get_emojis(text);
         bool is_changed = false;
         for (auto &emoji : keyword->emoticons_) {
           if (td::remove(emojis, emoji)) {
@@ -10097,7 +10168,8 @@ void StickersManager::on_get_emoji_keywords_difference(
           }
         }
         if (is_changed) {
-          key_values.emplace(get_language_emojis_database_key(language_code, text), implode(emojis, '$'));
+          key_values[get_language_emojis_database_key(language_code, text)] = implode(emojis, '$');
+          index->set_emojis(text, emojis);
         } else {
           LOG(INFO) << "Emoji keywords not changed for \"" << text << "\" from version " << from_version
                     << " to version " << version;
@@ -10140,6 +10212,7 @@ bool StickersManager::prepare_search_emoji_query(const string &text, const vecto
   }
 
   vector<string> languages_to_load;
+  vector<string> languages_to_load_from_database;
   for (auto &language_code : language_codes) {
     CHECK(!language_code.empty());
     auto version = get_emoji_language_code_version(language_code);
@@ -10147,10 +10220,13 @@ bool StickersManager::prepare_search_emoji_query(const string &text, const vecto
       languages_to_load.push_back(language_code);
     } else {
       LOG(DEBUG) << "Found language " << language_code << " with version " << version;
+      if (get_emoji_keyword_index(language_code) == nullptr) {
+        languages_to_load_from_database.push_back(language_code);
+      }
     }
   }
 
-  if (!languages_to_load.empty()) {
+  if (!languages_to_load.empty() || !languages_to_load_from_database.empty()) {
     if (!force) {
       MultiPromiseActorSafe mpas{"LoadEmojiLanguagesMultiPromiseActor"};
       mpas.add_promise(std::move(promise));
@@ -10159,10 +10235,15 @@ bool StickersManager::prepare_search_emoji_query(const string &text, const vecto
       for (auto &language_code : languages_to_load) {
         load_emoji_keywords(language_code, mpas.get_promise());
       }
+      for (auto &language_code : languages_to_load_from_database) {
+        load_emoji_keyword_index(language_code, mpas.get_promise());
+      }
       lock.set_value(Unit());
       return false;
     } else {
-      LOG(ERROR) << "Have no " << languages_to_load << " emoji keywords";
+      LOG_IF(ERROR, !languages_to_load.empty()) << "Have no " << languages_to_load << " emoji keywords";
+      LOG_IF(ERROR, !languages_to_load_from_database.empty())
+          << "Have no loaded " << languages_to_load_from_database << " emoji keywords";
     }
   }
 
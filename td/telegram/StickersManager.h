@@ -11,6 +11,7 @@
 #include "td/telegram/Dimensions.h"
 #include "td/telegram/EmojiGroup.h"
 #include "td/telegram/EmojiGroupType.h"
+#include "td/telegram/EmojiKeywordIndex.h"
 #include "td/telegram/files/FileId.h"
 #include "td/telegram/files/FileSourceId.h"
 #include "td/telegram/MessageFullId.h"
@@ -968,9 +969,16 @@ class StickersManager final : public Actor {
 
   void on_get_language_codes(const string &key, Result<vector<string>> &&result);
 
-  static vector<std::pair<string, string>> search_language_emojis(const string &language_code, const string &text);
+  vector<std::pair<string, string>> search_language_emojis(const string &language_code, const string &text);
 
-  static vector<string> get_keyword_language_emojis(const string &language_code, const string &text);
+  vector<string> get_keyword_language_emojis(const string &language_code, const string &text);
+
+  EmojiKeywordIndex *get_emoji_keyword_index(const string &language_code);
+
+  void load_emoji_keyword_index(const string &language_code, Promise<Unit> &&promise);
+
+  void on_load_emoji_keyword_index(const string &language_code,
+                                   Result<vector<std::pair<string, string>>> &&r_keyword_emojis);
 
   void load_emoji_keywords(const string &language_code, Promise<Unit> &&promise);
 
@@ -1128,6 +1136,8 @@ class StickersManager final : public Actor {
   FlatHashMap<string, double> emoji_language_code_last_difference_times_;
   FlatHashSet<string> reloaded_emoji_keywords_;
   FlatHashMap<string, vector<Promise<Unit>>> load_emoji_keywords_queries_;
+  FlatHashMap<string, unique_ptr<EmojiKeywordIndex>> emoji_keyword_indexes_;
+  FlatHashMap<string, vector<Promise<Unit>>> load_emoji_keyword_index_queries_;
   FlatHashMap<string, vector<Promise<Unit>>> load_language_codes_queries_;
 
   struct GiftPremiumMessages {
@@ -8,6 +8,7 @@
 
 #include "td/telegram/DialogId.h"
 #include "td/telegram/files/FileGcWorker.h"
+#include "td/telegram/files/FileDb.h"
 #include "td/telegram/files/FileStatsWorker.h"
 #include "td/telegram/Global.h"
 #include "td/telegram/logevent/LogEvent.h"
@@ -24,6 +25,7 @@
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Time.h"
+#include "td/utils/tl_helpers.h"
 
 namespace td {
 
@@ -31,18 +33,39 @@ tl_object_ptr<td_api::databaseStatistics> DatabaseStats::get_database_statistics
   return make_tl_object<td_api::databaseStatistics>(debug);
 }
 
+struct StorageManager::FileStatsCounters {
+  int32 date_ = 0;  // time of the last full scan
+  FileStats stats_{false, true};
+
+  template <class StorerT>
+  void store(StorerT &storer) const {
+    td::store(date_, storer);
+    td::store(stats_, storer);
+  }
+
+  template <class ParserT>
+  void parse(ParserT &parser) {
+    td::parse(date_, parser);
+    td::parse(stats_, parser);
+  }
+};
+
 StorageManager::StorageManager(ActorShared<> parent, int32 scheduler_id)
     : parent_(std::move(parent)), scheduler_id_(scheduler_id) {
 }
 
+StorageManager::~StorageManager() = default;
+
 void StorageManager::start_up() {
   load_last_gc_timestamp();
   schedule_next_gc();
 
   load_fast_stat();
+  load_file_stats_counters();
 }
 
-void StorageManager::on_new_file(int64 size, int64 real_size, int32 cnt) {
+void StorageManager::on_new_file(FileType file_type, DialogId owner_dialog_id, bool is_temp, int64 size,
+                                 int64 real_size, int32 cnt) {
   LOG(INFO) << "Add " << cnt << " file of size " << size << " with real size " << real_size
             << " to fast storage statistics";
   fast_stat_.cnt += cnt;
@@ -58,12 +81,27 @@ void StorageManager::on_new_file(int64 size, int64 real_size, int32 cnt) {
     fast_stat_ = FileTypeStat();
   }
   save_fast_stat();
+
+  if (file_stats_counters_ != nullptr && !is_temp) {
+    file_stats_counters_->stats_.add_counters(owner_dialog_id, file_type, add_size, cnt);
+    if (!save_file_stats_counters_timeout_.has_timeout()) {
+      save_file_stats_counters_timeout_.set_callback(save_file_stats_counters_static);
+      save_file_stats_counters_timeout_.set_callback_data(static_cast<void *>(this));
+      save_file_stats_counters_timeout_.set_timeout_in(SAVE_FILE_STATS_COUNTERS_DELAY);
+    }
+  }
 }
 
 void StorageManager::get_storage_stats(bool need_all_files, int32 dialog_limit, Promise<FileStats> promise) {
   if (is_closed_) {
     return promise.set_error(Global::request_aborted_error());
   }
+  if (!need_all_files && can_use_file_stats_counters()) {
+    vector<Promise<FileStats>> promises;
+    promises.push_back(std::move(promise));
+    return send_stats(file_stats_counters_->stats_.get_counters(dialog_limit != 0, false), dialog_limit,
+                      std::move(promises));
+  }
   if (!pending_storage_stats_.empty()) {
     if (stats_dialog_limit_ == dialog_limit && need_all_files == stats_need_all_files_) {
       pending_storage_stats_.emplace_back(std::move(promise));
@@ -80,7 +118,8 @@ void StorageManager::get_storage_stats(bool need_all_files, int32 dialog_limit,
   pending_storage_stats_.emplace_back(std::move(promise));
 
   create_stats_worker();
-  send_closure(stats_worker_, &FileStatsWorker::get_stats, need_all_files, stats_dialog_limit_ != 0,
+  // the statistics are always split by owner dialog to be able to update file statistics counters
+  send_closure(stats_worker_, &FileStatsWorker::get_stats, need_all_files, true,
                PromiseCreator::lambda(
                    [actor_id = actor_id(this), stats_generation = stats_generation_](Result<FileStats> file_stats) {
                      send_closure(actor_id, &StorageManager::on_file_stats, std::move(file_stats), stats_generation);
@@ -138,7 +177,12 @@ void StorageManager::on_file_stats(Result<FileStats> r_file_stats, uint32 genera
   }
 
   update_fast_stats(r_file_stats.ok());
-  send_stats(r_file_stats.move_as_ok(), stats_dialog_limit_, std::move(pending_storage_stats_));
+  update_file_stats_counters(r_file_stats.ok());
+  auto file_stats = r_file_stats.move_as_ok();
+  if (!stats_need_all_files_) {
+    file_stats = file_stats.get_counters(stats_dialog_limit_ != 0 && G()->use_file_database(), false);
+  }
+  send_stats(std::move(file_stats), stats_dialog_limit_, std::move(pending_storage_stats_));
 }
 
 void StorageManager::create_stats_worker() {
@@ -223,11 +267,15 @@ void StorageManager::on_gc_finished(int32 dialog_limit, Result<FileGcResult> r_f
   }
 
   update_fast_stats(r_file_gc_result.ok().kept_file_stats_);
+  update_file_stats_counters(r_file_gc_result.ok().kept_file_stats_);
 
+  bool split_by_owner_dialog_id = dialog_limit != 0 && G()->use_file_database();
   auto kept_file_promises = std::move(pending_run_gc_[0]);
   auto removed_file_promises = std::move(pending_run_gc_[1]);
-  send_stats(std::move(r_file_gc_result.ok_ref().kept_file_stats_), dialog_limit, std::move(kept_file_promises));
-  send_stats(std::move(r_file_gc_result.ok_ref().removed_file_stats_), dialog_limit, std::move(removed_file_promises));
+  send_stats(r_file_gc_result.ok().kept_file_stats_.get_counters(split_by_owner_dialog_id, false), dialog_limit,
+             std::move(kept_file_promises));
+  send_stats(r_file_gc_result.ok().removed_file_stats_.get_counters(split_by_owner_dialog_id, false), dialog_limit,
+             std::move(removed_file_promises));
 }
 
 void StorageManager::save_fast_stat() {
@@ -249,6 +297,58 @@ void StorageManager::update_fast_stats(const FileStats &stats) {
   save_fast_stat();
 }
 
+bool StorageManager::can_use_file_stats_counters() const {
+  return file_stats_counters_ != nullptr &&
+         G()->unix_time() - file_stats_counters_->date_ < MAX_FILE_STATS_COUNTERS_AGE;
+}
+
+void StorageManager::update_file_stats_counters(const FileStats &stats) {
+  if (!G()->use_file_database() || !stats.is_split_by_owner_dialog_id()) {
+    return;
+  }
+  if (file_stats_counters_ == nullptr) {
+    file_stats_counters_ = make_unique<FileStatsCounters>();
+  }
+  file_stats_counters_->date_ = G()->unix_time();
+  file_stats_counters_->stats_ = stats.get_counters(true, true);
+  save_file_stats_counters();
+}
+
+void StorageManager::load_file_stats_counters() {
+  if (!G()->use_file_database()) {
+    return;
+  }
+  auto value = G()->td_db()->get_file_db_shared()->get_file_stats_sync();
+  if (value.empty()) {
+    return;
+  }
+  auto file_stats_counters = make_unique<FileStatsCounters>();
+  auto status = log_event_parse(*file_stats_counters, value);
+  if (status.is_error() || !file_stats_counters->stats_.is_split_by_owner_dialog_id()) {
+    LOG(ERROR) << "Failed to load file statistics: " << status;
+    return;
+  }
+  file_stats_counters_ = std::move(file_stats_counters);
+  LOG(INFO) << "Loaded file statistics from " << file_stats_counters_->date_;
+}
+
+void StorageManager::save_file_stats_counters_static(void *storage_manager_ptr) {
+  if (G()->close_flag()) {
+    return;
+  }
+
+  CHECK(storage_manager_ptr != nullptr);
+  static_cast<StorageManager *>(storage_manager_ptr)->save_file_stats_counters();
+}
+
+void StorageManager::save_file_stats_counters() {
+  save_file_stats_counters_timeout_.cancel_timeout();
+  if (file_stats_counters_ == nullptr) {
+    return;
+  }
+  G()->td_db()->get_file_db_shared()->set_file_stats(log_event_store(*file_stats_counters_).as_slice().str());
+}
+
 void StorageManager::send_stats(FileStats &&stats, int32 dialog_limit, std::vector<Promise<FileStats>> &&promises) {
   if (promises.empty()) {
     return;
@@ -303,6 +403,9 @@ void StorageManager::close_gc_worker() {
 }
 
 void StorageManager::hangup() {
+  if (save_file_stats_counters_timeout_.has_timeout()) {
+    save_file_stats_counters();
+  }
   is_closed_ = true;
   close_stats_worker();
   close_gc_worker();
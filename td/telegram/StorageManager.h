@@ -6,12 +6,15 @@
 //
 #pragma once
 
+#include "td/telegram/DialogId.h"
 #include "td/telegram/files/FileGcWorker.h"
 #include "td/telegram/files/FileStats.h"
 #include "td/telegram/files/FileStatsWorker.h"
+#include "td/telegram/files/FileType.h"
 #include "td/telegram/td_api.h"
 
 #include "td/actor/actor.h"
+#include "td/actor/Timeout.h"
 
 #include "td/utils/CancellationToken.h"
 #include "td/utils/common.h"
@@ -32,18 +35,26 @@ struct DatabaseStats {
 class StorageManager final : public Actor {
  public:
   StorageManager(ActorShared<> parent, int32 scheduler_id);
+  StorageManager(const StorageManager &) = delete;
+  StorageManager &operator=(const StorageManager &) = delete;
+  StorageManager(StorageManager &&) = delete;
+  StorageManager &operator=(StorageManager &&) = delete;
+  ~StorageManager() final;
+
   void get_storage_stats(bool need_all_files, int32 dialog_limit, Promise<FileStats> promise);
   void get_storage_stats_fast(Promise<FileStatsFast> promise);
   void get_database_stats(Promise<DatabaseStats> promise);
   void run_gc(FileGcParameters parameters, bool return_deleted_file_statistics, Promise<FileStats> promise);
   void update_use_storage_optimizer();
 
-  void on_new_file(int64 size, int64 real_size, int32 cnt);
+  void on_new_file(FileType file_type, DialogId owner_dialog_id, bool is_temp, int64 size, int64 real_size, int32 cnt);
 
  private:
   static constexpr int GC_EACH = 60 * 60 * 24;  // 1 day
   static constexpr int GC_DELAY = 60;
   static constexpr int GC_RAND_DELAY = 60 * 15;
+  static constexpr int32 MAX_FILE_STATS_COUNTERS_AGE = 60 * 60 * 24;  // 1 day
+  static constexpr double SAVE_FILE_STATS_COUNTERS_DELAY = 10.0;
 
   ActorShared<> parent_;
 
@@ -58,6 +69,12 @@ class StorageManager final : public Actor {
 
   FileTypeStat fast_stat_;
 
+  // full statistics by owner dialog and file type, which are updated on file changes between full scans;
+  // files in directories for temporary files are excluded, because partial files become other files after download
+  struct FileStatsCounters;
+  unique_ptr<FileStatsCounters> file_stats_counters_;
+  Timeout save_file_stats_counters_timeout_;
+
   CancellationTokenSource stats_cancellation_token_source_;
   CancellationTokenSource gc_cancellation_token_source_;
 
@@ -68,6 +85,11 @@ class StorageManager final : public Actor {
 
   void save_fast_stat();
   void load_fast_stat();
+  bool can_use_file_stats_counters() const;
+  void update_file_stats_counters(const FileStats &stats);
+  void load_file_stats_counters();
+  static void save_file_stats_counters_static(void *storage_manager_ptr);
+  void save_file_stats_counters();
   static int64 get_database_size();
   static int64 get_language_pack_database_size();
   static int64 get_log_size();
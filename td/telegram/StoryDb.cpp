@@ -11,7 +11,9 @@
 
 #include "td/db/SqliteConnectionSafe.h"
 #include "td/db/SqliteDb.h"
+#include "td/db/SqliteReadPool.h"
 #include "td/db/SqliteStatement.h"
+#include "td/db/SqliteTransactionBatcher.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/SchedulerLocalStorage.h"
@@ -355,8 +357,10 @@ std::shared_ptr<StoryDbSyncSafeInterface> create_story_db_sync(
 
 class StoryDbAsync final : public StoryDbAsyncInterface {
  public:
-  StoryDbAsync(std::shared_ptr<StoryDbSyncSafeInterface> sync_db, int32 scheduler_id) {
-    impl_ = create_actor_on_scheduler<Impl>("StoryDbActor", scheduler_id, std::move(sync_db));
+  StoryDbAsync(std::shared_ptr<StoryDbSyncSafeInterface> sync_db, int32 scheduler_id,
+               vector<int32> read_scheduler_ids) {
+    impl_ = create_actor_on_scheduler<Impl>("StoryDbActor", scheduler_id, std::move(sync_db),
+                                            std::move(read_scheduler_ids));
   }
 
   void add_story(StoryFullId story_full_id, int32 expires_at, NotificationId notification_id, BufferSlice data,
@@ -421,7 +425,8 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
  private:
   class Impl final : public Actor {
    public:
-    explicit Impl(std::shared_ptr<StoryDbSyncSafeInterface> sync_db_safe) : sync_db_safe_(std::move(sync_db_safe)) {
+    Impl(std::shared_ptr<StoryDbSyncSafeInterface> sync_db_safe, vector<int32> read_scheduler_ids)
+        : sync_db_safe_(std::move(sync_db_safe)), read_scheduler_ids_(std::move(read_scheduler_ids)) {
     }
     void add_story(StoryFullId story_full_id, int32 expires_at, NotificationId notification_id, BufferSlice data,
                    Promise<Unit> promise) {
@@ -445,19 +450,23 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
     }
 
     void get_story(StoryFullId story_full_id, Promise<BufferSlice> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_story(story_full_id));
+      run_read_query([story_full_id, promise = std::move(promise)](StoryDbSyncInterface &db) mutable {
+        promise.set_result(db.get_story(story_full_id));
+      });
     }
 
     void get_expiring_stories(int32 expires_till, int32 limit, Promise<vector<StoryDbStory>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_expiring_stories(expires_till, limit));
+      run_read_query([expires_till, limit, promise = std::move(promise)](StoryDbSyncInterface &db) mutable {
+        promise.set_value(db.get_expiring_stories(expires_till, limit));
+      });
     }
 
     void get_stories_from_notification_id(DialogId dialog_id, NotificationId from_notification_id, int32 limit,
                                           Promise<vector<StoryDbStory>> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_stories_from_notification_id(dialog_id, from_notification_id, limit));
+      run_read_query([dialog_id, from_notification_id, limit,
+                      promise = std::move(promise)](StoryDbSyncInterface &db) mutable {
+        promise.set_value(db.get_stories_from_notification_id(dialog_id, from_notification_id, limit));
+      });
     }
 
     void add_active_stories(DialogId dialog_id, StoryListId story_list_id, int64 dialog_order, BufferSlice data,
@@ -477,14 +486,17 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
     }
 
     void get_active_stories(DialogId dialog_id, Promise<BufferSlice> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_active_stories(dialog_id));
+      run_read_query([dialog_id, promise = std::move(promise)](StoryDbSyncInterface &db) mutable {
+        promise.set_result(db.get_active_stories(dialog_id));
+      });
     }
 
     void get_active_story_list(StoryListId story_list_id, int64 order, DialogId dialog_id, int32 limit,
                                Promise<StoryDbGetActiveStoryListResult> promise) {
-      add_read_query();
-      promise.set_value(sync_db_->get_active_story_list(story_list_id, order, dialog_id, limit));
+      run_read_query([story_list_id, order, dialog_id, limit,
+                      promise = std::move(promise)](StoryDbSyncInterface &db) mutable {
+        promise.set_value(db.get_active_story_list(story_list_id, order, dialog_id, limit));
+      });
     }
 
     void add_active_story_list_state(StoryListId story_list_id, BufferSlice data, Promise<Unit> promise) {
@@ -495,15 +507,16 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
     }
 
     void get_active_story_list_state(StoryListId story_list_id, Promise<BufferSlice> promise) {
-      add_read_query();
-      promise.set_result(sync_db_->get_active_story_list_state(story_list_id));
+      run_read_query([story_list_id, promise = std::move(promise)](StoryDbSyncInterface &db) mutable {
+        promise.set_result(db.get_active_story_list_state(story_list_id));
+      });
     }
 
     void close(Promise<Unit> promise) {
       do_flush();
       sync_db_safe_.reset();
       sync_db_ = nullptr;
-      promise.set_value(Unit());
+      read_pool_.close(std::move(promise));
       stop();
     }
 
@@ -515,30 +528,37 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
    private:
     std::shared_ptr<StoryDbSyncSafeInterface> sync_db_safe_;
     StoryDbSyncInterface *sync_db_ = nullptr;
+    vector<int32> read_scheduler_ids_;
+    SqliteReadPool read_pool_;
 
-    static constexpr size_t MAX_PENDING_QUERIES_COUNT{50};
-    static constexpr double MAX_PENDING_QUERIES_DELAY{0.01};
+    SqliteTransactionBatcher write_batcher_{"StoryDb"};
 
     //NB: order is important, destructor of pending_writes_ will change finished_writes_
     vector<Promise<Unit>> finished_writes_;
     vector<Promise<Unit>> pending_writes_;  // TODO use Action
-    double wakeup_at_ = 0;
 
     template <class F>
     void add_write_query(F &&f) {
       pending_writes_.push_back(PromiseCreator::lambda(std::forward<F>(f)));
-      if (pending_writes_.size() > MAX_PENDING_QUERIES_COUNT) {
+      if (write_batcher_.on_query_added()) {
         do_flush();
-        wakeup_at_ = 0;
-      } else if (wakeup_at_ == 0) {
-        wakeup_at_ = Time::now_cached() + MAX_PENDING_QUERIES_DELAY;
-      }
-      if (wakeup_at_ != 0) {
-        set_timeout_at(wakeup_at_);
+      } else {
+        set_timeout_at(write_batcher_.get_commit_time());
       }
     }
-    void add_read_query() {
+    // the query sees results of all previous writes, because they are committed before it is started
+    template <class F>
+    void run_read_query(F &&f) {
       do_flush();
+      if (read_pool_.empty()) {
+        return f(*sync_db_);
+      }
+      read_pool_.run(PromiseCreator::lambda(
+          [sync_db_safe = sync_db_safe_, f = std::forward<F>(f)](Result<Unit> result) mutable {
+            if (result.is_ok()) {
+              f(sync_db_safe->get());
+            }
+          }));
     }
     void do_flush() {
       if (pending_writes_.empty()) {
@@ -546,7 +566,9 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
       }
       sync_db_->begin_write_transaction().ensure();
       set_promises(pending_writes_);
+      auto commit_start_time = Time::now();
       sync_db_->commit_transaction().ensure();
+      write_batcher_.on_committed(Time::now() - commit_start_time);
       set_promises(finished_writes_);
       cancel_timeout();
     }
@@ -556,14 +578,17 @@ class StoryDbAsync final : public StoryDbAsyncInterface {
 
     void start_up() final {
       sync_db_ = &sync_db_safe_->get();
+      if (!read_scheduler_ids_.empty()) {
+        read_pool_ = SqliteReadPool(read_scheduler_ids_);
+      }
     }
   };
   ActorOwn<Impl> impl_;
 };
 
 std::shared_ptr<StoryDbAsyncInterface> create_story_db_async(std::shared_ptr<StoryDbSyncSafeInterface> sync_db,
-                                                             int32 scheduler_id) {
-  return std::make_shared<StoryDbAsync>(std::move(sync_db), scheduler_id);
+                                                             int32 scheduler_id, vector<int32> read_scheduler_ids) {
+  return std::make_shared<StoryDbAsync>(std::move(sync_db), scheduler_id, std::move(read_scheduler_ids));
 }
 
 }  // namespace td
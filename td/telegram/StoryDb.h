@@ -128,6 +128,7 @@ Status drop_story_db(SqliteDb &db, int version) TD_WARN_UNUSED_RESULT;
 std::shared_ptr<StoryDbSyncSafeInterface> create_story_db_sync(std::shared_ptr<SqliteConnectionSafe> sqlite_connection);
 
 std::shared_ptr<StoryDbAsyncInterface> create_story_db_async(std::shared_ptr<StoryDbSyncSafeInterface> sync_db,
-                                                             int32 scheduler_id = -1);
+                                                             int32 scheduler_id = -1,
+                                                             vector<int32> read_scheduler_ids = {});
 
 }  // namespace td
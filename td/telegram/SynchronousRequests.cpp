@@ -21,6 +21,9 @@
 #include "td/telegram/td_api.hpp"
 #include "td/telegram/ThemeManager.h"
 
+#include "td/actor/ActorProfiler.h"
+
+#include "td/utils/algorithm.h"
 #include "td/utils/filesystem.h"
 #include "td/utils/format.h"
 #include "td/utils/logging.h"
@@ -104,6 +107,8 @@ bool SynchronousRequests::is_synchronous_request(const td_api::Function *functio
     case td_api::setLogTagVerbosityLevel::ID:
     case td_api::getLogTagVerbosityLevel::ID:
     case td_api::addLogMessage::ID:
+    case td_api::setActorProfilerSamplingPeriod::ID:
+    case td_api::getActorProfile::ID:
     case td_api::testReturnError::ID:
       return true;
     case td_api::getOption::ID:
@@ -389,6 +394,37 @@ td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api:
   return td_api::make_object<td_api::ok>();
 }
 
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(
+    const td_api::setActorProfilerSamplingPeriod &request) {
+  if (request.sampling_period_ < 0 || request.sampling_period_ > ActorProfiler::MAX_SAMPLING_PERIOD) {
+    return make_error(400, "Invalid sampling period specified");
+  }
+  ActorProfiler::set_sampling_period(request.sampling_period_);
+  return td_api::make_object<td_api::ok>();
+}
+
+td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(const td_api::getActorProfile &request) {
+  if (!check_utf8(request.dump_file_path_)) {
+    return make_error(400, "Strings must be encoded in UTF-8");
+  }
+  auto profile = ActorProfiler::get_profile(request.reset_);
+  if (!request.dump_file_path_.empty()) {
+    auto status = ActorProfiler::dump_profile(profile, request.dump_file_path_);
+    if (status.is_error()) {
+      return make_error(400, status.message());
+    }
+  }
+  auto actors = transform(std::move(profile.actors), [](ActorProfiler::ActorStatistics &&actor) {
+    return td_api::make_object<td_api::actorStatistics>(std::move(actor.name), actor.event_count, actor.run_time,
+                                                        actor.mailbox_wait_time);
+  });
+  auto events = transform(std::move(profile.events), [](ActorProfiler::EventStatistics &&event) {
+    return td_api::make_object<td_api::actorEventStatistics>(std::move(event.actor_name), std::move(event.event_name),
+                                                             event.event_count, event.run_time, event.max_run_time);
+  });
+  return td_api::make_object<td_api::actorProfile>(profile.sampling_period, std::move(actors), std::move(events));
+}
+
 td_api::object_ptr<td_api::Object> SynchronousRequests::do_request(td_api::testReturnError &request) {
   if (request.error_ == nullptr) {
     return td_api::make_object<td_api::error>(404, "Not Found");
@@ -83,6 +83,10 @@ class SynchronousRequests {
 
   static td_api::object_ptr<td_api::Object> do_request(const td_api::addLogMessage &request);
 
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::setActorProfilerSamplingPeriod &request);
+
+  static td_api::object_ptr<td_api::Object> do_request(const td_api::getActorProfile &request);
+
   static td_api::object_ptr<td_api::Object> do_request(td_api::testReturnError &request);
 };
 
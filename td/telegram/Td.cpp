@@ -30,6 +30,7 @@
 #include "td/telegram/DeviceTokenManager.h"
 #include "td/telegram/DialogActionManager.h"
 #include "td/telegram/DialogFilterManager.h"
+#include "td/telegram/DialogId.h"
 #include "td/telegram/DialogInviteLinkManager.h"
 #include "td/telegram/DialogManager.h"
 #include "td/telegram/DialogParticipantManager.h"
@@ -39,6 +40,7 @@
 #include "td/telegram/FileReferenceManager.h"
 #include "td/telegram/files/FileManager.h"
 #include "td/telegram/files/FileSourceId.h"
+#include "td/telegram/files/FileType.h"
 #include "td/telegram/ForumTopicManager.h"
 #include "td/telegram/GameManager.h"
 #include "td/telegram/Global.h"
@@ -1039,8 +1041,10 @@ void Td::init_file_manager() {
       return !td_->auth_manager_->is_bot();
     }
 
-    void on_new_file(int64 size, int64 real_size, int32 cnt) final {
-      send_closure(G()->storage_manager(), &StorageManager::on_new_file, size, real_size, cnt);
+    void on_new_file(FileType file_type, DialogId owner_dialog_id, bool is_temp, int64 size, int64 real_size,
+                     int32 cnt) final {
+      send_closure(G()->storage_manager(), &StorageManager::on_new_file, file_type, owner_dialog_id, is_temp, size,
+                   real_size, cnt);
     }
 
     void on_file_updated(FileId file_id) final {
@@ -1379,6 +1383,8 @@ Result<std::pair<Td::Parameters, TdDb::Parameters>> Td::get_parameters(
   result.second.use_file_database_ = parameters->use_file_database_;
   result.second.use_chat_info_database_ = parameters->use_chat_info_database_;
   result.second.use_message_database_ = parameters->use_message_database_;
+  result.second.use_server_database_profile_ = parameters->use_server_database_profile_;
+  result.second.use_trigram_message_search_ = parameters->use_trigram_message_search_;
 
   VLOG(td_init) << "Create MtprotoHeader::Options";
   options_.api_id = parameters->api_id_;
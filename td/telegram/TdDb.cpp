@@ -25,6 +25,8 @@
 #include "td/db/SqliteKeyValue.h"
 #include "td/db/SqliteKeyValueAsync.h"
 #include "td/db/SqliteKeyValueSafe.h"
+#include "td/db/SqliteTransactionBatcher.h"
+#include "td/db/SqliteWalCheckpointer.h"
 
 #include "td/actor/actor.h"
 #include "td/actor/MultiPromise.h"
@@ -303,6 +305,11 @@ void TdDb::do_close(bool destroy_flag, Promise<Unit> on_finished) {
       }));
   auto lock = mpas.get_promise();
 
+  if (sql_wal_checkpointer_) {
+    sql_wal_checkpointer_->close(mpas.get_promise());
+    sql_wal_checkpointer_.reset();
+  }
+
   if (file_db_) {
     file_db_->close(mpas.get_promise());
     file_db_.reset();
@@ -372,12 +379,14 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
     return Status::OK();
   }
 
+  auto sqlite_options = parameters.use_server_database_profile_ ? SqliteOptions::server() : SqliteOptions();
   TRY_RESULT(db_instance, SqliteDb::change_key(sql_database_path, true, key, old_key));
-  sql_connection_ = std::make_shared<SqliteConnectionSafe>(sql_database_path, key, db_instance.get_cipher_version());
+  sql_connection_ = std::make_shared<SqliteConnectionSafe>(sql_database_path, key, db_instance.get_cipher_version(),
+                                                           sqlite_options);
   sql_connection_->set(std::move(db_instance));
   auto &db = sql_connection_->get();
   TRY_STATUS(db.exec("PRAGMA journal_mode=WAL"));
-  TRY_STATUS(db.exec("PRAGMA secure_delete=1"));
+  TRY_STATUS(db.set_options(sqlite_options));
 
   // Init databases
   // Do initialization once and before everything else to avoid "database is locked" error.
@@ -406,7 +415,7 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
 
   // init MessageDb
   if (use_message_database) {
-    TRY_STATUS(init_message_db(db, user_version));
+    TRY_STATUS(init_message_db(db, user_version, parameters.use_trigram_message_search_));
   } else {
     TRY_STATUS(drop_message_db(db, user_version));
   }
@@ -471,7 +480,7 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
 
   if (use_dialog_db) {
     dialog_db_sync_safe_ = create_dialog_db_sync(sql_connection_);
-    dialog_db_async_ = create_dialog_db_async(dialog_db_sync_safe_);
+    dialog_db_async_ = create_dialog_db_async(dialog_db_sync_safe_, -1, G()->get_database_read_scheduler_ids());
   }
 
   if (use_message_thread_db) {
@@ -481,12 +490,17 @@ Status TdDb::init_sqlite(const Parameters &parameters, const DbKey &key, const D
 
   if (use_message_database) {
     message_db_sync_safe_ = create_message_db_sync(sql_connection_);
-    message_db_async_ = create_message_db_async(message_db_sync_safe_);
+    message_db_async_ = create_message_db_async(message_db_sync_safe_, -1, G()->get_database_read_scheduler_ids());
   }
 
   if (use_story_database) {
     story_db_sync_safe_ = create_story_db_sync(sql_connection_);
-    story_db_async_ = create_story_db_async(story_db_sync_safe_);
+    story_db_async_ = create_story_db_async(story_db_sync_safe_, -1, G()->get_database_read_scheduler_ids());
+  }
+
+  if (sqlite_options.wal_autocheckpoint == 0) {
+    // checkpoints are done on a separate scheduler to not block database requests
+    sql_wal_checkpointer_ = create_sqlite_wal_checkpointer(sql_connection_, G()->get_gc_scheduler_id());
   }
 
   return Status::OK();
@@ -758,7 +772,8 @@ Result<string> TdDb::get_stats() {
   }
   sb << "Max file database depth out of " << prev.size() << '/' << count
      << " elements: " << *std::max_element(prev.begin(), prev.end()) << "\n";
-  sb << "Have " << bad_count << " forward references with maximum reference to " << max_bad_to;
+  sb << "Have " << bad_count << " forward references with maximum reference to " << max_bad_to << "\n";
+  sb << get_sqlite_transaction_batcher_stats();
 
   return sb.as_cslice().str();
 }
@@ -39,6 +39,7 @@ class SqliteConnectionSafe;
 class SqliteKeyValueSafe;
 class SqliteKeyValueAsyncInterface;
 class SqliteKeyValue;
+class SqliteWalCheckpointerInterface;
 class StoryDbSyncInterface;
 class StoryDbSyncSafeInterface;
 class StoryDbAsyncInterface;
@@ -60,6 +61,8 @@ class TdDb {
     bool use_file_database_ = false;
     bool use_chat_info_database_ = false;
     bool use_message_database_ = false;
+    bool use_server_database_profile_ = false;
+    bool use_trigram_message_search_ = false;
   };
 
   struct OpenedDatabase {
@@ -162,6 +165,7 @@ class TdDb {
   bool was_dialog_db_created_ = false;
 
   std::shared_ptr<SqliteConnectionSafe> sql_connection_;
+  unique_ptr<SqliteWalCheckpointerInterface> sql_wal_checkpointer_;
 
   std::shared_ptr<FileDbInterface> file_db_;
 
@@ -88,6 +88,7 @@
 #include "td/telegram/Usernames.h"
 #include "td/telegram/WebPagesManager.h"
 
+#include "td/actor/actor.h"
 #include "td/actor/MultiPromise.h"
 #include "td/actor/PromiseFuture.h"
 
@@ -188,12 +189,16 @@ class GetDifferenceQuery final : public Td::ResultHandler {
 
   void on_result(BufferSlice packet) final {
     VLOG(get_difference) << "Receive getDifference result of size " << packet.size();
-    auto result_ptr = fetch_result<telegram_api::updates_getDifference>(packet);
-    if (result_ptr.is_error()) {
-      return on_error(result_ptr.move_as_error());
-    }
+    // parsing of the difference doesn't depend on the state and can be done by any idle thread
+    Scheduler::instance()->run_stealable(
+        PromiseCreator::lambda([packet = std::move(packet), promise = std::move(promise_)](Unit) mutable {
+          auto result_ptr = fetch_result<telegram_api::updates_getDifference>(packet);
+          if (result_ptr.is_error()) {
+            return promise.set_error(result_ptr.move_as_error());
+          }
 
-    promise_.set_value(result_ptr.move_as_ok());
+          promise.set_value(result_ptr.move_as_ok());
+        }));
   }
 
   void on_error(Status status) final {
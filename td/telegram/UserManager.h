@@ -39,10 +39,10 @@
 #include "td/actor/MultiTimeout.h"
 
 #include "td/utils/common.h"
+#include "td/utils/CompactHints.h"
 #include "td/utils/FlatHashMap.h"
 #include "td/utils/FlatHashSet.h"
 #include "td/utils/HashTableUtils.h"
-#include "td/utils/Hints.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
@@ -1089,7 +1089,7 @@ class UserManager final : public Actor {
 
   bool are_contacts_loaded_ = false;
   int32 next_contacts_sync_date_ = 0;
-  Hints contacts_hints_;  // search contacts by first name, last name and usernames
+  CompactHints contacts_hints_;  // search contacts by first name, last name and usernames
   vector<Promise<Unit>> load_contacts_queries_;
   MultiPromiseActor load_contact_users_multipromise_{"LoadContactUsersMultiPromiseActor"};
   int32 saved_contact_count_ = -1;
@@ -97,6 +97,7 @@ static void dump_memory_usage() {
     LOG(WARNING) << tag("other", format::as_size(other_size));
     LOG(WARNING) << tag("total", format::as_size(total_size));
     LOG(WARNING) << tag("total traces", get_ht_size());
+    LOG(WARNING) << tag("total allocations", get_allocation_count());
     LOG(WARNING) << tag("fast_backtrace_success_rate", get_fast_backtrace_success_rate());
   }
 }
@@ -5027,6 +5028,14 @@ class CliClient final : public Actor {
       get_args(args, chat_id, filter, offset, query);
       send_request(td_api::make_object<td_api::searchSecretMessages>(chat_id, query.query, offset, query.limit,
                                                                      as_search_messages_filter(filter)));
+    } else if (op == "ssmr") {
+      ChatId chat_id;
+      string filter;
+      string offset;
+      SearchQuery query;
+      get_args(args, chat_id, filter, offset, query);
+      send_request(td_api::make_object<td_api::searchSecretMessagesByRelevance>(
+          chat_id, query.query, offset, query.limit, as_search_messages_filter(filter)));
     } else if (op == "ssd") {
       schedule_date_ = std::move(args);
     } else if (op == "smei") {
@@ -7226,6 +7235,13 @@ class CliClient final : public Actor {
       } else {
         execute(std::move(request));
       }
+    } else if (op == "sapsp") {
+      int32 sampling_period;
+      get_args(args, sampling_period);
+      execute(td_api::make_object<td_api::setActorProfilerSamplingPeriod>(sampling_period));
+    } else if (op == "gap" || op == "gapr") {
+      const string &dump_file_path = args;
+      execute(td_api::make_object<td_api::getActorProfile>(dump_file_path, op == "gapr"));
     } else if (op == "q" || op == "Quit") {
       quit();
     } else if (op == "dnq") {
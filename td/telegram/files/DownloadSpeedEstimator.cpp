@@ -0,0 +1,75 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/files/DownloadSpeedEstimator.h"
+
+#include "td/utils/misc.h"
+
+namespace td {
+
+void DownloadSpeedEstimator::clear() {
+  window_count_ = 0;
+  next_window_pos_ = 0;
+  window_start_time_ = 0.0;
+  window_size_ = 0;
+  window_min_latency_ = 0.0;
+}
+
+void DownloadSpeedEstimator::on_part_downloaded(int64 size, double latency, double now) {
+  if (last_part_time_ != 0.0 && now - last_part_time_ > static_cast<double>(WINDOW_COUNT) * WINDOW_DURATION) {
+    // the link could have been changed since the last download
+    clear();
+  }
+  last_part_time_ = now;
+
+  if (window_start_time_ == 0.0) {
+    window_start_time_ = now - latency;
+  } else if (now - window_start_time_ >= WINDOW_DURATION) {
+    auto &window = windows_[next_window_pos_];
+    window.speed = static_cast<double>(window_size_) / (now - window_start_time_);
+    window.min_latency = window_min_latency_;
+    next_window_pos_ = (next_window_pos_ + 1) % WINDOW_COUNT;
+    window_count_ = min(window_count_ + 1, WINDOW_COUNT);
+
+    window_start_time_ = now;
+    window_size_ = 0;
+    window_min_latency_ = 0.0;
+  }
+
+  window_size_ += size;
+  if (window_min_latency_ == 0.0 || latency < window_min_latency_) {
+    window_min_latency_ = latency;
+  }
+}
+
+double DownloadSpeedEstimator::get_speed() const {
+  double result = 0.0;
+  for (size_t i = 0; i < window_count_; i++) {
+    result = max(result, windows_[i].speed);
+  }
+  return result;
+}
+
+double DownloadSpeedEstimator::get_min_latency() const {
+  double result = window_min_latency_;
+  for (size_t i = 0; i < window_count_; i++) {
+    if (result == 0.0 || windows_[i].min_latency < result) {
+      result = windows_[i].min_latency;
+    }
+  }
+  return result;
+}
+
+int64 DownloadSpeedEstimator::get_resource_limit(int64 min_limit, int64 max_limit) const {
+  // twice the bandwidth-delay product is enough to fully use the link
+  auto limit = 2.0 * get_speed() * get_min_latency();
+  if (limit >= static_cast<double>(max_limit)) {
+    return max_limit;
+  }
+  return clamp(static_cast<int64>(limit), min_limit, max_limit);
+}
+
+}  // namespace td
@@ -0,0 +1,49 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+#include <array>
+
+namespace td {
+
+// Estimates download speed from a DC and minimum latency of part queries to choose total size of simultaneously
+// downloaded parts. The size is doubled while the speed grows with it, and stops growing when the link is saturated,
+// because then the speed doesn't grow and only part latency does.
+class DownloadSpeedEstimator {
+ public:
+  void on_part_downloaded(int64 size, double latency, double now);
+
+  // returns estimated download speed in bytes per second or 0 if unknown
+  double get_speed() const;
+
+  double get_min_latency() const;
+
+  int64 get_resource_limit(int64 min_limit, int64 max_limit) const;
+
+ private:
+  static constexpr double WINDOW_DURATION = 1.0;
+  static constexpr size_t WINDOW_COUNT = 10;
+
+  struct Window {
+    double speed = 0.0;
+    double min_latency = 0.0;
+  };
+  std::array<Window, WINDOW_COUNT> windows_;
+  size_t window_count_ = 0;
+  size_t next_window_pos_ = 0;
+
+  double window_start_time_ = 0.0;
+  int64 window_size_ = 0;
+  double window_min_latency_ = 0.0;
+  double last_part_time_ = 0.0;
+
+  void clear();
+};
+
+}  // namespace td
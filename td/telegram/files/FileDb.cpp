@@ -142,6 +142,10 @@ class FileDb final : public FileDbInterface {
       pmc.commit_transaction().ensure();
     }
 
+    void store_file_stats(const string &file_stats) {
+      file_pmc().set("file_stats", file_stats);
+    }
+
     void optimize_refs(std::vector<FileDbId> file_db_ids, FileDbId main_file_db_id) {
       LOG(INFO) << "Optimize " << file_db_ids.size() << " file_db_ids in file database to " << main_file_db_id.get();
       auto &pmc = file_pmc();
@@ -231,6 +235,14 @@ class FileDb final : public FileDbInterface {
   void set_file_data_ref(FileDbId file_db_id, FileDbId new_file_db_id) final {
     send_closure(file_db_actor_, &FileDbActor::store_file_data_ref, file_db_id, new_file_db_id);
   }
+  string get_file_stats_sync() final {
+    return file_kv_safe_->get().get("file_stats");
+  }
+
+  void set_file_stats(string file_stats) final {
+    send_closure(file_db_actor_, &FileDbActor::store_file_stats, std::move(file_stats));
+  }
+
   SqliteKeyValue &pmc() final {
     return file_kv_safe_->get();
   }
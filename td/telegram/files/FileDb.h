@@ -80,6 +80,10 @@ class FileDbInterface {
                              bool new_generate) = 0;
   virtual void set_file_data_ref(FileDbId file_db_id, FileDbId new_file_db_id) = 0;
 
+  // serialized storage statistics, which are kept up to date by StorageManager
+  virtual string get_file_stats_sync() = 0;
+  virtual void set_file_stats(string file_stats) = 0;
+
   // For FileStatsWorker. TODO: remove it
   virtual SqliteKeyValue &pmc() = 0;
 
@@ -11,7 +11,10 @@
 
 #include "td/utils/common.h"
 #include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
 
 namespace td {
 
@@ -54,6 +57,8 @@ void FileDownloadManager::download(QueryId query_id, const FullRemoteFileLocatio
       create_actor<FileDownloader>("Downloader", remote_location, local, size, std::move(name), encryption_key,
                                    is_small, need_search_file, offset, limit, std::move(callback));
   DcId dc_id = remote_location.is_web() ? G()->get_webfile_dc_id() : remote_location.get_dc_id();
+  node->dc_id_ = dc_id;
+  node->is_small_ = is_small;
   auto &resource_manager = get_download_resource_manager(is_small, dc_id);
   send_closure(resource_manager, &ResourceManager::register_worker,
                ActorShared<FileLoaderActor>(node->downloader_.get(), static_cast<uint64>(-1)), priority);
@@ -148,6 +153,48 @@ void FileDownloadManager::on_partial_download(PartialLocalFileLocation partial_l
   }
 }
 
+void FileDownloadManager::on_part_downloaded(int64 size, double latency) {
+  auto node_id = get_link_token();
+  auto node = nodes_container_.get(node_id);
+  if (node == nullptr || node->is_small_ || stop_flag_) {
+    return;
+  }
+
+  auto dc_id = node->dc_id_;
+  auto &state = dc_download_states_[dc_id];
+  state.speed_estimator_.on_part_downloaded(size, latency, Time::now());
+
+  auto max_resource_limit = max(max_download_resource_limit_, MAX_ADAPTIVE_DOWNLOAD_RESOURCE_LIMIT);
+  auto resource_limit = state.speed_estimator_.get_resource_limit(max_download_resource_limit_, max_resource_limit);
+  resource_limit = max(resource_limit / DOWNLOAD_RESOURCE_LIMIT_STEP * DOWNLOAD_RESOURCE_LIMIT_STEP,
+                       max_download_resource_limit_);
+  if (resource_limit != state.resource_limit_) {
+    LOG(INFO) << "Change total size of simultaneously downloaded parts from " << dc_id << " to " << resource_limit
+              << " with download speed " << state.speed_estimator_.get_speed() << " B/s and part latency "
+              << state.speed_estimator_.get_min_latency();
+    state.resource_limit_ = resource_limit;
+    send_closure(get_download_resource_manager(false, dc_id), &ResourceManager::update_max_resource_limit,
+                 resource_limit);
+  }
+
+  // a session can efficiently download the same amount of data as by default; more sessions are created only
+  // while the speed grows, and their number is decreased when the estimation is reset after a pause in downloads
+  auto default_session_count = NetQueryDispatcher::get_download_session_count();
+  if (state.session_count_ == 0) {
+    state.session_count_ = default_session_count;
+  }
+  auto session_resource_limit = max(max_download_resource_limit_ / default_session_count, static_cast<int64>(1));
+  auto session_count = narrow_cast<int32>(clamp((resource_limit + session_resource_limit - 1) / session_resource_limit,
+                                                static_cast<int64>(default_session_count),
+                                                static_cast<int64>(2 * default_session_count)));
+  if (session_count > state.session_count_ ||
+      (session_count < state.session_count_ && resource_limit == max_download_resource_limit_)) {
+    LOG(INFO) << "Change number of download sessions for " << dc_id << " to " << session_count;
+    state.session_count_ = session_count;
+    G()->net_query_dispatcher().update_download_session_count(dc_id, session_count);
+  }
+}
+
 void FileDownloadManager::on_ok_download(FullLocalFileLocation local, int64 size, bool is_new) {
   auto node_id = get_link_token();
   auto node = nodes_container_.get(node_id);
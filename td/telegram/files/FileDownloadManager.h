@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/telegram/files/DownloadSpeedEstimator.h"
 #include "td/telegram/files/FileDownloader.h"
 #include "td/telegram/files/FileEncryptionKey.h"
 #include "td/telegram/files/FileFromBytes.h"
@@ -58,12 +59,25 @@ class FileDownloadManager final : public Actor {
     QueryId query_id_;
     ActorOwn<FileDownloader> downloader_;
     ActorOwn<FileFromBytes> from_bytes_;
+    DcId dc_id_;
+    bool is_small_ = false;
   };
   using NodeId = uint64;
 
   std::map<DcId, ActorOwn<ResourceManager>> download_resource_manager_map_;
   std::map<DcId, ActorOwn<ResourceManager>> download_small_resource_manager_map_;
 
+  // total size of simultaneously downloaded parts and the number of download sessions are scaled from
+  // the observed download speed, but only for big files
+  static constexpr int64 MAX_ADAPTIVE_DOWNLOAD_RESOURCE_LIMIT = static_cast<int64>(1) << 26;
+  static constexpr int64 DOWNLOAD_RESOURCE_LIMIT_STEP = 1 << 19;
+  struct DcDownloadState {
+    DownloadSpeedEstimator speed_estimator_;
+    int64 resource_limit_ = 0;
+    int32 session_count_ = 0;
+  };
+  std::map<DcId, DcDownloadState> dc_download_states_;
+
   Container<Node> nodes_container_;
   unique_ptr<Callback> callback_;
   ActorShared<> parent_;
@@ -83,6 +97,7 @@ class FileDownloadManager final : public Actor {
 
   void on_start_download();
   void on_partial_download(PartialLocalFileLocation partial_local, int64 ready_size, int64 size);
+  void on_part_downloaded(int64 size, double latency);
   void on_ok_download(FullLocalFileLocation local, int64 size, bool is_new);
   void on_error(Status status);
   void on_error_impl(NodeId node_id, Status status);
@@ -101,6 +116,9 @@ class FileDownloadManager final : public Actor {
     void on_partial_download(PartialLocalFileLocation partial_local, int64 ready_size, int64 size) final {
       send_closure(actor_id_, &FileDownloadManager::on_partial_download, std::move(partial_local), ready_size, size);
     }
+    void on_part_downloaded(int64 size, double latency) final {
+      send_closure(actor_id_, &FileDownloadManager::on_part_downloaded, size, latency);
+    }
     void on_ok(FullLocalFileLocation full_local, int64 size, bool is_new) final {
       send_closure(std::move(actor_id_), &FileDownloadManager::on_ok_download, std::move(full_local), size, is_new);
     }
@@ -26,6 +26,7 @@
 #include "td/utils/port/Stat.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
 #include "td/utils/UInt.h"
 
 #include <tuple>
@@ -274,7 +275,11 @@ Result<size_t> FileDownloader::process_part(Part part, NetQueryPtr net_query) {
   }
 
   auto slice = bytes.as_slice().substr(0, part.size);
+  if (need_check_) {
+    TRY_STATUS(check_part_hashes(part.offset, slice));
+  }
   TRY_STATUS(acquire_fd());
+  try_preallocate_file();
   LOG(INFO) << "Receive " << slice.size() << " bytes at offset " << part.offset << " for \"" << path_ << '"';
   TRY_RESULT(written, fd_.pwrite(slice, part.offset));
   LOG(INFO) << "Written " << written << " bytes";
@@ -351,6 +356,12 @@ Status FileDownloader::check_loop(int64 checked_prefix_size, int64 ready_prefix_
         }
         end_offset = ready_prefix_size;
       }
+      if (checked_hash_offsets_.erase(begin_offset) != 0) {
+        checked_prefix_size = end_offset;
+        is_changed = true;
+        continue;
+      }
+
       auto size = narrow_cast<size_t>(end_offset - begin_offset);
       auto slice = BufferSlice(size);
       TRY_STATUS(acquire_fd());
@@ -410,6 +421,49 @@ void FileDownloader::add_hash_info(const std::vector<telegram_api::object_ptr<te
   }
 }
 
+Status FileDownloader::check_part_hashes(int64 offset, Slice bytes) {
+  // hash ranges fully contained in the part are checked in memory to avoid reading them back from the file
+  auto end_offset = offset + static_cast<int64>(bytes.size());
+  auto is_last_part = end_offset == parts_manager_.get_size_or_zero();
+  HashInfo search_info;
+  search_info.offset = offset;
+  for (auto it = hash_info_.lower_bound(search_info); it != hash_info_.end() && it->offset < end_offset; ++it) {
+    auto hash_end_offset = it->offset + narrow_cast<int64>(it->size);
+    if (hash_end_offset > end_offset) {
+      if (!is_last_part) {
+        break;
+      }
+      hash_end_offset = end_offset;
+    }
+    string hash(32, ' ');
+    sha256(bytes.substr(narrow_cast<size_t>(it->offset - offset), narrow_cast<size_t>(hash_end_offset - it->offset)),
+           hash);
+    if (hash != it->hash) {
+      return Status::Error("Hash mismatch");
+    }
+    checked_hash_offsets_.insert(it->offset);
+  }
+  return Status::OK();
+}
+
+void FileDownloader::try_preallocate_file() {
+  if (is_file_preallocated_) {
+    return;
+  }
+  is_file_preallocated_ = true;
+
+  // preallocate only files, which are downloaded completely; streaming can need only a small part of the file
+  auto size = parts_manager_.get_size_or_zero();
+  if (only_check_ || offset_ != 0 || limit_ != 0 || size < MIN_PREALLOCATED_FILE_SIZE ||
+      !G()->get_option_boolean("use_file_preallocation")) {
+    return;
+  }
+  auto status = fd_.preallocate(size);
+  if (status.is_error()) {
+    LOG(INFO) << "Failed to preallocate " << size << " bytes for \"" << path_ << "\": " << status;
+  }
+}
+
 void FileDownloader::try_release_fd() {
   if (!keep_fd_ && !fd_.empty()) {
     fd_.close();
@@ -465,9 +519,11 @@ void FileDownloader::update_downloaded_part(int64 offset, int64 limit, int64 max
     auto end_part_id = begin_part_id + td::min(max_parts, new_end_part_id - begin_part_id);
     VLOG(file_loader) << "Protect parts " << begin_part_id << " ... " << end_part_id - 1;
     for (auto &it : part_map_) {
-      if (!it.second.second.empty() && !(begin_part_id <= it.second.first.id && it.second.first.id < end_part_id)) {
-        VLOG(file_loader) << "Cancel part " << it.second.first.id;
-        it.second.second.reset();  // cancel_query(it.second.second);
+      auto &part_info = it.second;
+      if (!part_info.cancel_slot_.empty() &&
+          !(begin_part_id <= part_info.part_.id && part_info.part_.id < end_part_id)) {
+        VLOG(file_loader) << "Cancel part " << part_info.part_.id;
+        part_info.cancel_slot_.reset();  // cancel_query(part_info.cancel_slot_);
       }
     }
   } else {
@@ -487,6 +543,7 @@ void FileDownloader::start_up() {
   if (remote_.file_type_ == FileType::SecureEncrypted) {
     size_ = 0;
   }
+  start_time_ = Time::now();
   int32 part_size = 0;
   Bitmask bitmask{Bitmask::Ones{}, 0};
   if (local_.type() == LocalFileLocation::Type::Partial) {
@@ -593,6 +650,13 @@ Status FileDownloader::do_loop() {
     }
     callback_->on_ok(FullLocalFileLocation(remote_.file_type_, std::move(path), 0), size, !only_check_);
 
+    auto elapsed_time = Time::now() - start_time_;
+    LOG(INFO) << "Downloaded " << downloaded_size_ << " bytes in " << elapsed_time << " seconds with average speed "
+              << (elapsed_time > 0 ? static_cast<double>(downloaded_size_) / elapsed_time / 1024.0 : 0.0)
+              << " KB/s using " << downloaded_part_count_ << " parts of size " << parts_manager_.get_part_size()
+              << " with average latency "
+              << (downloaded_part_count_ == 0 ? 0.0 : total_part_latency_ / downloaded_part_count_)
+              << " seconds and up to " << max_pending_part_count_ << " simultaneous parts";
     LOG(INFO) << "Bad download order rate: "
               << (debug_total_parts_ == 0 ? 0.0 : 100.0 * debug_bad_part_order_ / debug_total_parts_) << "% "
               << debug_bad_part_order_ << "/" << debug_total_parts_ << " " << format::as_array(debug_bad_parts_);
@@ -614,7 +678,11 @@ Status FileDownloader::do_loop() {
 
     TRY_RESULT(query, start_part(part, parts_manager_.get_part_count(), parts_manager_.get_streaming_offset()));
     uint64 unique_id = UniqueId::next();
-    part_map_[unique_id] = std::make_pair(part, query->cancel_slot_.get_signal_new());
+    auto &part_info = part_map_[unique_id];
+    part_info.part_ = part;
+    part_info.cancel_slot_ = query->cancel_slot_.get_signal_new();
+    part_info.start_time_ = Time::now();
+    max_pending_part_count_ = max(max_pending_part_count_, part_map_.size());
 
     auto callback = actor_shared(this, unique_id);
     if (delay_dispatcher_.empty()) {
@@ -631,7 +699,7 @@ Status FileDownloader::do_loop() {
 
 void FileDownloader::tear_down() {
   for (auto &it : part_map_) {
-    it.second.second.reset();  // cancel_query(it.second.second);
+    it.second.cancel_slot_.reset();  // cancel_query(it.second.cancel_slot_);
   }
   ordered_parts_.clear([](auto &&part) { part.second->clear(); });
   if (!delay_dispatcher_.empty()) {
@@ -673,8 +741,9 @@ void FileDownloader::on_result(NetQueryPtr query) {
     return;
   }
 
-  Part part = it->second.first;
-  it->second.second.release();
+  Part part = it->second.part_;
+  auto latency = Time::now() - it->second.start_time_;
+  it->second.cancel_slot_.release();
   CHECK(query->is_ready());
   part_map_.erase(it);
 
@@ -698,6 +767,13 @@ void FileDownloader::on_result(NetQueryPtr query) {
   }
 
   if (next) {
+    if (query->is_ok()) {
+      auto size = static_cast<int64>(query->ok().size());
+      downloaded_size_ += size;
+      total_part_latency_ += latency;
+      downloaded_part_count_++;
+      callback_->on_part_downloaded(size, latency);
+    }
     if (ordered_flag_) {
       auto seq_no = part.id;
       ordered_parts_.add(
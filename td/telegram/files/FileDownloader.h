@@ -22,6 +22,7 @@
 #include "td/utils/common.h"
 #include "td/utils/OrderedEventsProcessor.h"
 #include "td/utils/port/FileFd.h"
+#include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 
 #include <map>
@@ -39,6 +40,7 @@ class FileDownloader final : public FileLoaderActor {
     Callback &operator=(const Callback &) = delete;
     virtual void on_start_download() = 0;
     virtual void on_partial_download(PartialLocalFileLocation partial_local, int64 ready_size, int64 size) = 0;
+    virtual void on_part_downloaded(int64 size, double latency) = 0;
     virtual void on_ok(FullLocalFileLocation full_local, int64 size, bool is_new) = 0;
     virtual void on_error(Status status) = 0;
     virtual ~Callback() = default;
@@ -93,18 +95,32 @@ class FileDownloader final : public FileLoaderActor {
     }
   };
   std::set<HashInfo> hash_info_;
+  std::set<int64> checked_hash_offsets_;  // offsets of hash ranges, which were checked before the part was written
   bool has_hash_query_ = false;
+  bool is_file_preallocated_ = false;
 
   static constexpr uint8 COMMON_QUERY_KEY = 2;
+  static constexpr int64 MIN_PREALLOCATED_FILE_SIZE = 1 << 22;
   bool stop_flag_ = false;
   ActorShared<ResourceManager> resource_manager_;
   ResourceState resource_state_;
   PartsManager parts_manager_;
-  std::map<uint64, std::pair<Part, ActorShared<>>> part_map_;
+  struct PartInfo {
+    Part part_;
+    ActorShared<> cancel_slot_;
+    double start_time_ = 0.0;
+  };
+  std::map<uint64, PartInfo> part_map_;
   OrderedEventsProcessor<std::pair<Part, NetQueryPtr>> ordered_parts_;
   ActorOwn<DelayDispatcher> delay_dispatcher_;
   double next_delay_ = 0;
 
+  double start_time_ = 0.0;
+  int64 downloaded_size_ = 0;
+  double total_part_latency_ = 0.0;
+  uint32 downloaded_part_count_ = 0;
+  size_t max_pending_part_count_ = 0;
+
   uint32 debug_total_parts_ = 0;
   uint32 debug_bad_part_order_ = 0;
   std::vector<int32> debug_bad_parts_;
@@ -127,6 +143,10 @@ class FileDownloader final : public FileLoaderActor {
 
   void add_hash_info(const std::vector<telegram_api::object_ptr<telegram_api::fileHash>> &hashes);
 
+  Status check_part_hashes(int64 offset, Slice bytes);
+
+  void try_preallocate_file();
+
   void try_release_fd();
 
   Status acquire_fd() TD_WARN_UNUSED_RESULT;
@@ -81,8 +81,10 @@ void FileGcWorker::run_gc(const FileGcParameters &parameters, std::vector<FullFi
     total_size += info.size;
   }
 
-  FileStats new_stats(false, parameters.dialog_limit_ != 0);
-  FileStats removed_stats(false, parameters.dialog_limit_ != 0);
+  // the statistics are always split by owner dialog to be able to update file statistics counters
+  bool split_by_owner_dialog_id = G()->use_file_database();
+  FileStats new_stats(false, split_by_owner_dialog_id);
+  FileStats removed_stats(false, split_by_owner_dialog_id);
 
   auto do_remove_file = [&removed_stats](const FullFileInfo &info) {
     removed_stats.add_copy(info);
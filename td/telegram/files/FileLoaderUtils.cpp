@@ -257,6 +257,12 @@ string get_files_dir(FileType file_type) {
   return PSTRING() << get_files_base_dir(file_type) << get_file_type_name(file_type) << TD_DIR_SLASH;
 }
 
+bool is_temp_file_path(CSlice path) {
+  return begins_with(path, get_files_dir(FileType::Temp)) ||
+         begins_with(path, get_files_temp_dir(FileType::SecureDecrypted)) ||
+         begins_with(path, get_files_temp_dir(FileType::Video));
+}
+
 bool are_modification_times_equal(int64 old_mtime, int64 new_mtime) {
   if (old_mtime == new_mtime) {
     return true;
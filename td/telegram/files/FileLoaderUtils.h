@@ -38,6 +38,9 @@ string get_files_temp_dir(FileType file_type);
 
 string get_files_dir(FileType file_type);
 
+// returns true, if the file is in a directory for temporary files, which is scanned as temporary by FileStatsWorker
+bool is_temp_file_path(CSlice path);
+
 bool are_modification_times_equal(int64 old_mtime, int64 new_mtime);
 
 struct FullLocalLocationInfo {
@@ -2503,7 +2503,9 @@ void FileManager::delete_file(FileId file_id, Promise<Unit> promise, const char
     if (begins_with(file_view.get_full_local_location()->path_, get_files_dir(file_view.get_type()))) {
       clear_from_pmc(node);
       if (context_->need_notify_on_new_files()) {
-        context_->on_new_file(-file_view.size(), -file_view.get_allocated_local_size(), -1);
+        context_->on_new_file(file_view.get_type(), file_view.owner_dialog_id(),
+                              is_temp_file_path(file_view.get_full_local_location()->path_), -file_view.size(),
+                              -file_view.get_allocated_local_size(), -1);
       }
       path = std::move(node->local_.full().path_);
     }
@@ -4020,7 +4022,10 @@ void FileManager::on_download_ok(FileDownloadManager::QueryId query_id, FullLoca
     status = Status::Error(PSLICE() << "Can't register local file after download: " << r_new_file_id.error().message());
   } else {
     if (is_new && context_->need_notify_on_new_files()) {
-      context_->on_new_file(size, get_file_view(r_new_file_id.ok()).get_allocated_local_size(), 1);
+      auto file_view = get_file_view(r_new_file_id.ok());
+      context_->on_new_file(file_view.get_type(), file_view.owner_dialog_id(),
+                            is_temp_file_path(file_view.get_full_local_location()->path_), size,
+                            file_view.get_allocated_local_size(), 1);
     }
   }
   if (status.is_error()) {
@@ -4187,7 +4192,9 @@ void FileManager::on_generate_ok(FileGenerateManager::QueryId query_id, FullLoca
   if (context_->need_notify_on_new_files()) {
     auto generate_location = file_view.get_generate_location();
     if (generate_location == nullptr || !begins_with(generate_location->conversion_, "#file_id#")) {
-      context_->on_new_file(file_view.size(), file_view.get_allocated_local_size(), 1);
+      context_->on_new_file(file_view.get_type(), file_view.owner_dialog_id(),
+                            is_temp_file_path(file_view.get_full_local_location()->path_), file_view.size(),
+                            file_view.get_allocated_local_size(), 1);
     }
   }
 
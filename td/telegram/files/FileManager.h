@@ -428,7 +428,8 @@ class FileManager final : public Actor {
    public:
     virtual bool need_notify_on_new_files() = 0;
 
-    virtual void on_new_file(int64 size, int64 real_size, int32 cnt) = 0;
+    virtual void on_new_file(FileType file_type, DialogId owner_dialog_id, bool is_temp, int64 size, int64 real_size,
+                             int32 cnt) = 0;
 
     virtual void on_file_updated(FileId size) = 0;
 
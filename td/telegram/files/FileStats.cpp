@@ -12,6 +12,7 @@
 #include "td/utils/common.h"
 #include "td/utils/FlatHashSet.h"
 #include "td/utils/format.h"
+#include "td/utils/logging.h"
 #include "td/utils/misc.h"
 
 #include <algorithm>
@@ -34,6 +35,9 @@ void FileStats::add(StatByType &by_type, FileType file_type, int64 size) {
 void FileStats::add_impl(const FullFileInfo &info) {
   if (split_by_owner_dialog_id_) {
     add(stat_by_owner_dialog_id_[info.owner_dialog_id], info.file_type, info.size);
+    if (info.is_temp) {
+      add(temp_stat_by_owner_dialog_id_[info.owner_dialog_id], info.file_type, info.size);
+    }
   } else {
     add(stat_by_type_, info.file_type, info.size);
   }
@@ -53,6 +57,61 @@ void FileStats::add(FullFileInfo &&info) {
   }
 }
 
+void FileStats::add_counters(DialogId owner_dialog_id, FileType file_type, int64 size, int32 cnt) {
+  auto pos = static_cast<size_t>(file_type);
+  CHECK(pos < stat_by_type_.size());
+  auto &stat = split_by_owner_dialog_id_ ? stat_by_owner_dialog_id_[owner_dialog_id][pos] : stat_by_type_[pos];
+  stat.size += size;
+  stat.cnt += cnt;
+  if (stat.size < 0 || stat.cnt < 0) {
+    LOG(ERROR) << "Receive wrong file statistics for " << owner_dialog_id << " and " << file_type << " after adding "
+               << cnt << " files of size " << size;
+    stat = FileTypeStat();
+  }
+}
+
+FileStats FileStats::get_counters(bool split_by_owner_dialog_id, bool exclude_temp_files) const {
+  CHECK(split_by_owner_dialog_id_ || (!split_by_owner_dialog_id && !exclude_temp_files));
+  FileStats result(false, split_by_owner_dialog_id);
+  if (!split_by_owner_dialog_id_) {
+    result.stat_by_type_ = stat_by_type_;
+    return result;
+  }
+
+  auto stat_by_owner_dialog_id = stat_by_owner_dialog_id_;
+  if (exclude_temp_files) {
+    for (auto &dialog : temp_stat_by_owner_dialog_id_) {
+      auto &stat_by_type = stat_by_owner_dialog_id[dialog.first];
+      for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+        stat_by_type[i].size -= dialog.second[i].size;
+        stat_by_type[i].cnt -= dialog.second[i].cnt;
+      }
+    }
+    table_remove_if(stat_by_owner_dialog_id, [](const auto &it) {
+      for (auto &stat : it.second) {
+        if (stat.cnt != 0 || stat.size != 0) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+  if (split_by_owner_dialog_id) {
+    result.stat_by_owner_dialog_id_ = std::move(stat_by_owner_dialog_id);
+    if (!exclude_temp_files) {
+      result.temp_stat_by_owner_dialog_id_ = temp_stat_by_owner_dialog_id_;
+    }
+    return result;
+  }
+  for (auto &dialog : stat_by_owner_dialog_id) {
+    for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+      result.stat_by_type_[i].size += dialog.second[i].size;
+      result.stat_by_type_[i].cnt += dialog.second[i].cnt;
+    }
+  }
+  return result;
+}
+
 FileTypeStat FileStats::get_nontemp_stat(const FileStats::StatByType &by_type) {
   FileTypeStat stat;
   for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
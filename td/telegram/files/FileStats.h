@@ -10,6 +10,7 @@
 #include "td/telegram/files/FileType.h"
 
 #include "td/utils/common.h"
+#include "td/utils/misc.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/tl_helpers.h"
 
@@ -48,6 +49,7 @@ struct FullFileInfo {
   int64 size;
   uint64 atime_nsec;
   uint64 mtime_nsec;
+  bool is_temp = false;  // the file is in a directory for temporary files
 };
 
 struct FileStatsFast {
@@ -74,6 +76,8 @@ class FileStats {
 
   StatByType stat_by_type_;
   std::unordered_map<DialogId, StatByType, DialogIdHash> stat_by_owner_dialog_id_;
+  // the part of stat_by_owner_dialog_id_ for files in directories for temporary files
+  std::unordered_map<DialogId, StatByType, DialogIdHash> temp_stat_by_owner_dialog_id_;
   vector<FullFileInfo> all_files_;
 
   void add_impl(const FullFileInfo &info);
@@ -96,6 +100,17 @@ class FileStats {
 
   void add(FullFileInfo &&info);
 
+  // adds cnt files of total size size; both values can be negative
+  void add_counters(DialogId owner_dialog_id, FileType file_type, int64 size, int32 cnt);
+
+  // returns a copy of the statistics without the list of all files; files in directories for temporary files
+  // can be excluded only from statistics split by owner dialog
+  FileStats get_counters(bool split_by_owner_dialog_id, bool exclude_temp_files) const;
+
+  bool is_split_by_owner_dialog_id() const {
+    return split_by_owner_dialog_id_;
+  }
+
   void apply_dialog_limit(int32 limit);
 
   void apply_dialog_ids(const vector<DialogId> &dialog_ids);
@@ -107,6 +122,69 @@ class FileStats {
   FileTypeStat get_total_nontemp_stat() const;
 
   vector<FullFileInfo> get_all_files();
+
+  template <class StorerT>
+  void store(StorerT &storer) const {
+    using ::td::store;
+    CHECK(!need_all_files_);
+    // only non-empty statistics are stored
+    auto store_stat_by_type = [&storer](const StatByType &stat_by_type) {
+      int32 file_type_count = 0;
+      for (auto &stat : stat_by_type) {
+        if (stat.cnt != 0 || stat.size != 0) {
+          file_type_count++;
+        }
+      }
+      store(file_type_count, storer);
+      for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+        auto &stat = stat_by_type[i];
+        if (stat.cnt != 0 || stat.size != 0) {
+          store(i, storer);
+          store(stat, storer);
+        }
+      }
+    };
+    store(split_by_owner_dialog_id_, storer);
+    if (split_by_owner_dialog_id_) {
+      store(narrow_cast<int32>(stat_by_owner_dialog_id_.size()), storer);
+      for (auto &it : stat_by_owner_dialog_id_) {
+        store(it.first, storer);
+        store_stat_by_type(it.second);
+      }
+    } else {
+      store_stat_by_type(stat_by_type_);
+    }
+  }
+
+  template <class ParserT>
+  void parse(ParserT &parser) {
+    using ::td::parse;
+    auto parse_stat_by_type = [&parser](StatByType &stat_by_type) {
+      int32 file_type_count;
+      parse(file_type_count, parser);
+      for (int32 i = 0; i < file_type_count && parser.get_error() == nullptr; i++) {
+        int32 file_type;
+        parse(file_type, parser);
+        if (file_type < 0 || file_type >= MAX_FILE_TYPE) {
+          return parser.set_error("Invalid file type");
+        }
+        parse(stat_by_type[file_type], parser);
+      }
+    };
+    need_all_files_ = false;
+    parse(split_by_owner_dialog_id_, parser);
+    if (split_by_owner_dialog_id_) {
+      int32 dialog_count;
+      parse(dialog_count, parser);
+      for (int32 i = 0; i < dialog_count && parser.get_error() == nullptr; i++) {
+        DialogId dialog_id;
+        parse(dialog_id, parser);
+        parse_stat_by_type(stat_by_owner_dialog_id_[dialog_id]);
+      }
+    } else {
+      parse_stat_by_type(stat_by_type_);
+    }
+  }
 };
 
 StringBuilder &operator<<(StringBuilder &sb, const FileStats &file_stats);
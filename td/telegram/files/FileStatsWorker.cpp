@@ -24,24 +24,24 @@
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/PathView.h"
+#include "td/utils/port/Clocks.h"
 #include "td/utils/port/path.h"
 #include "td/utils/port/Stat.h"
+#include "td/utils/port/thread.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/Time.h"
 #include "td/utils/tl_parsers.h"
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 namespace td {
 namespace {
-// Performance ideas:
-// - use slice instead of string
-// - use arena memory allocator
-// - store FileType or dir, no both
-// - store dir relative to G()->files_dir()
-
 struct DbFileInfo {
   FileType file_type;
   string path;
@@ -93,25 +93,153 @@ void scan_db(CancellationToken &token, CallbackT &&callback) {
 }
 
 struct FsFileInfo {
+  uint32 name_offset;
+  uint32 name_length;
   FileType file_type;
-  string path;
   int64 size;
   uint64 atime_nsec;
   uint64 mtime_nsec;
 };
 
-template <class CallbackT>
-void scan_fs(CancellationToken &token, CallbackT &&callback) {
-  std::unordered_set<string, Hash<string>> scanned_file_dirs;
-  auto scan_dir = [&](FileType file_type, const string &file_dir) {
-    if (!scanned_file_dirs.insert(file_dir).second) {
-      return;
+// regular files found directly in a directory; names of all the files are stored in one string
+struct FsDirInfo {
+  string scan_path;
+  FileType file_type = FileType::None;
+  bool is_temp = false;
+  uint64 mtime_nsec = 0;
+  string dir_path;  // common prefix of paths of all files in the directory
+  string names;
+  vector<FsFileInfo> files;
+  vector<string> subdir_paths;
+
+  Slice get_name(const FsFileInfo &info) const {
+    return Slice(names).substr(info.name_offset, info.name_length);
+  }
+
+  string get_path(const FsFileInfo &info) const {
+    return PSTRING() << dir_path << get_name(info);
+  }
+
+  bool is_path(const FsFileInfo &info, Slice path) const {
+    return path.size() == dir_path.size() + info.name_length && begins_with(path, dir_path) &&
+           ends_with(path, get_name(info));
+  }
+};
+
+struct FsScanTask {
+  string path;
+  FileType file_type;
+  bool is_temp;
+};
+
+using FsDirInfos = std::unordered_map<string, std::shared_ptr<const FsDirInfo>, Hash<string>>;
+
+// scans the given directories and all their subdirectories; each directory is scanned by one of the threads
+class FsScanner {
+ public:
+  FsScanner(const CancellationToken &token, const FsDirInfos *snapshot, uint64 max_snapshot_mtime_nsec)
+      : token_(token), snapshot_(snapshot), max_snapshot_mtime_nsec_(max_snapshot_mtime_nsec) {
+  }
+
+  vector<std::shared_ptr<const FsDirInfo>> run(vector<FsScanTask> tasks, int32 thread_count) {
+    for (auto &task : tasks) {
+      root_paths_.insert(task.path);
+    }
+    tasks_ = std::move(tasks);
+#if !TD_THREAD_UNSUPPORTED
+    vector<td::thread> threads;
+    for (int32 i = 1; i < thread_count; i++) {
+      threads.push_back(td::thread([this] { run_worker(); }));
+    }
+#endif
+    run_worker();
+#if !TD_THREAD_UNSUPPORTED
+    for (auto &thread : threads) {
+      thread.join();
     }
-    LOG(INFO) << "Scanning directory " << file_dir;
-    walk_path(file_dir, [&](CSlice path, WalkPath::Type type) {
-      if (token) {
+#endif
+    return std::move(results_);
+  }
+
+  // returns true, if the directory can be reused from the snapshot next time
+  bool can_be_reused(const FsDirInfo &dir_info) const {
+    return !dir_info.is_temp && dir_info.mtime_nsec != 0 && dir_info.mtime_nsec < max_snapshot_mtime_nsec_;
+  }
+
+ private:
+  const CancellationToken &token_;
+  const FsDirInfos *snapshot_;
+  uint64 max_snapshot_mtime_nsec_;
+  std::unordered_set<string, Hash<string>> root_paths_;
+
+  std::mutex mutex_;
+  std::condition_variable tasks_cv_;
+  vector<FsScanTask> tasks_;
+  size_t active_worker_count_ = 0;
+  vector<std::shared_ptr<const FsDirInfo>> results_;
+
+  void run_worker() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      tasks_cv_.wait(lock, [&] { return !tasks_.empty() || active_worker_count_ == 0; });
+      if (tasks_.empty() || token_) {
+        break;
+      }
+      auto task = std::move(tasks_.back());
+      tasks_.pop_back();
+      active_worker_count_++;
+      lock.unlock();
+
+      auto dir_info = scan_dir(task);
+
+      lock.lock();
+      active_worker_count_--;
+      if (dir_info != nullptr) {
+        for (auto &subdir_path : dir_info->subdir_paths) {
+          if (root_paths_.count(PSTRING() << subdir_path << TD_DIR_SLASH) == 0) {
+            tasks_.push_back(FsScanTask{subdir_path, task.file_type, task.is_temp});
+          }
+        }
+        results_.push_back(std::move(dir_info));
+      }
+      tasks_cv_.notify_all();
+    }
+    tasks_cv_.notify_all();
+  }
+
+  std::shared_ptr<const FsDirInfo> scan_dir(const FsScanTask &task) const {
+    auto r_dir_stat = stat(task.path);
+    if (r_dir_stat.is_error() || !r_dir_stat.ok().is_dir_) {
+      return nullptr;
+    }
+    auto mtime_nsec = r_dir_stat.ok().mtime_nsec_;
+    if (snapshot_ != nullptr) {
+      auto it = snapshot_->find(task.path);
+      if (it != snapshot_->end() && it->second->mtime_nsec == mtime_nsec && can_be_reused(*it->second)) {
+        return it->second;
+      }
+    }
+
+    LOG(INFO) << "Scanning directory " << task.path;
+    auto dir_info = std::make_shared<FsDirInfo>();
+    dir_info->scan_path = task.path;
+    dir_info->file_type = task.file_type;
+    dir_info->is_temp = task.is_temp;
+    dir_info->mtime_nsec = mtime_nsec;
+    bool is_root = true;
+    walk_path(task.path, [&](CSlice path, WalkPath::Type type) {
+      if (token_) {
         return WalkPath::Action::Abort;
       }
+      if (type == WalkPath::Type::EnterDir) {
+        if (is_root) {
+          is_root = false;
+          return WalkPath::Action::Continue;
+        }
+        // subdirectories are scanned separately
+        dir_info->subdir_paths.push_back(path.str());
+        return WalkPath::Action::SkipDir;
+      }
       if (type != WalkPath::Type::RegularFile) {
         return WalkPath::Action::Continue;
       }
@@ -126,100 +254,171 @@ void scan_fs(CancellationToken &token, CallbackT &&callback) {
         return WalkPath::Action::Continue;
       }
 
+      PathView path_view(path);
+      if (dir_info->files.empty()) {
+        dir_info->dir_path = path_view.parent_dir().str();
+      }
+      auto name = path_view.file_name();
+
       FsFileInfo info;
-      info.path = path.str();
+      info.name_offset = narrow_cast<uint32>(dir_info->names.size());
+      info.name_length = narrow_cast<uint32>(name.size());
+      info.file_type = guess_file_type_by_path(path, task.file_type);
       info.size = stat.real_size_;
-      info.file_type = guess_file_type_by_path(path, file_type);
       info.atime_nsec = stat.atime_nsec_;
       info.mtime_nsec = stat.mtime_nsec_;
-      callback(info);
+      dir_info->names.append(name.begin(), name.size());
+      dir_info->files.push_back(info);
       return WalkPath::Action::Continue;
     }).ignore();
-  };
-  for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
-    auto file_type = static_cast<FileType>(i);
-    scan_dir(get_main_file_type(file_type), get_files_dir(file_type));
+    dir_info->names.shrink_to_fit();
+    dir_info->files.shrink_to_fit();
+    return std::move(dir_info);
   }
-  scan_dir(get_main_file_type(FileType::Temp), get_files_temp_dir(FileType::SecureDecrypted));
-  scan_dir(get_main_file_type(FileType::Temp), get_files_temp_dir(FileType::Video));
+};
+
+int32 get_scan_thread_count() {
+#if TD_THREAD_UNSUPPORTED
+  return 1;
+#else
+  // scanning is limited mostly by the storage, so use more threads than there are CPU cores
+  static constexpr int32 MAX_SCAN_THREAD_COUNT = 8;
+  return clamp(2 * static_cast<int32>(td::thread::hardware_concurrency()), 1, MAX_SCAN_THREAD_COUNT);
+#endif
 }
 }  // namespace
 
-void FileStatsWorker::get_stats(bool need_all_files, bool split_by_owner_dialog_id, Promise<FileStats> promise) {
-  if (!G()->use_file_database()) {
-    FileStats file_stats(need_all_files, false);
-    auto start = Time::now();
-    scan_fs(token_, [&](FsFileInfo &fs_info) {
-      FullFileInfo info;
-      info.file_type = fs_info.file_type;
-      info.path = std::move(fs_info.path);
-      info.size = fs_info.size;
-      info.atime_nsec = fs_info.atime_nsec;
-      info.mtime_nsec = fs_info.mtime_nsec;
-      file_stats.add(std::move(info));
-    });
-    auto passed = Time::now() - start;
-    LOG_IF(INFO, passed > 0.5) << "Get file stats took: " << format::as_time(passed);
-    if (token_) {
-      return promise.set_error(Global::request_aborted_error());
-    }
-    promise.set_value(std::move(file_stats));
-  } else {
-    auto start = Time::now();
+struct FileStatsWorker::FsSnapshot {
+  FsDirInfos dir_infos;
+};
 
-    vector<FullFileInfo> full_infos;
-    scan_fs(token_, [&](FsFileInfo &fs_info) {
-      FullFileInfo info;
-      info.file_type = fs_info.file_type;
-      info.path = std::move(fs_info.path);
-      info.size = fs_info.size;
-      info.atime_nsec = fs_info.atime_nsec;
-      info.mtime_nsec = fs_info.mtime_nsec;
+FileStatsWorker::FileStatsWorker(ActorShared<> parent, CancellationToken token)
+    : parent_(std::move(parent)), token_(std::move(token)) {
+}
 
-      // LOG(INFO) << "Found file of size " << info.size << " at " << info.path;
+FileStatsWorker::~FileStatsWorker() = default;
 
-      full_infos.push_back(std::move(info));
-    });
+void FileStatsWorker::get_stats(bool need_all_files, bool split_by_owner_dialog_id, Promise<FileStats> promise) {
+  auto start = Time::now();
 
-    if (token_) {
-      return promise.set_error(Global::request_aborted_error());
+  vector<FsScanTask> tasks;
+  std::unordered_set<string, Hash<string>> scanned_file_dirs;
+  auto add_scan_task = [&](FileType file_type, string file_dir, bool is_temp) {
+    if (!scanned_file_dirs.insert(file_dir).second) {
+      return;
+    }
+    tasks.push_back(FsScanTask{std::move(file_dir), file_type, is_temp});
+  };
+  for (int32 i = 0; i < MAX_FILE_TYPE; i++) {
+    auto file_type = static_cast<FileType>(i);
+    auto main_file_type = get_main_file_type(file_type);
+    add_scan_task(main_file_type, get_files_dir(file_type), main_file_type == FileType::Temp);
+  }
+  add_scan_task(get_main_file_type(FileType::Temp), get_files_temp_dir(FileType::SecureDecrypted), true);
+  add_scan_task(get_main_file_type(FileType::Temp), get_files_temp_dir(FileType::Video), true);
+
+  // files can be changed without change of the directory modification time only in temporary directories, and
+  // statistics without a list of all files don't depend on file access times, so in other cases directories,
+  // which weren't changed since the previous scan, needn't be scanned again; directories changed less than
+  // a second before the scan aren't reused to ignore changes made in the same file system time tick
+  bool use_snapshot = G()->get_option_boolean("use_storage_statistics_snapshot");
+  if (!use_snapshot) {
+    fs_snapshot_ = nullptr;
+  }
+  auto max_snapshot_mtime_nsec = static_cast<uint64>((Clocks::system() - 1.0) * 1e9);
+  FsScanner scanner(token_, fs_snapshot_ != nullptr && !need_all_files ? &fs_snapshot_->dir_infos : nullptr,
+                    max_snapshot_mtime_nsec);
+  auto dir_infos = scanner.run(std::move(tasks), get_scan_thread_count());
+  if (token_) {
+    return promise.set_error(Global::request_aborted_error());
+  }
+  if (use_snapshot) {
+    auto fs_snapshot = make_unique<FsSnapshot>();
+    for (auto &dir_info : dir_infos) {
+      if (scanner.can_be_reused(*dir_info)) {
+        fs_snapshot->dir_infos.emplace(dir_info->scan_path, dir_info);
+      }
     }
+    fs_snapshot_ = std::move(fs_snapshot);
+  }
 
-    std::unordered_map<int64, size_t, Hash<int64>> hash_to_pos;
-    size_t pos = 0;
-    for (auto &full_info : full_infos) {
-      hash_to_pos[Hash<string>()(full_info.path)] = pos;
-      pos++;
+  struct FileOwner {
+    DialogId owner_dialog_id;
+    FileType file_type;
+  };
+  vector<vector<FileOwner>> file_owners(dir_infos.size());
+  bool use_file_database = G()->use_file_database();
+  if (use_file_database) {
+    size_t file_count = 0;
+    for (auto &dir_info : dir_infos) {
+      file_count += dir_info->files.size();
+    }
+    std::unordered_multimap<uint32, std::pair<uint32, uint32>> hash_to_pos;
+    hash_to_pos.reserve(file_count);
+    string path;
+    for (size_t i = 0; i < dir_infos.size(); i++) {
+      const auto &dir_info = *dir_infos[i];
+      auto &owners = file_owners[i];
+      owners.reserve(dir_info.files.size());
+      for (size_t j = 0; j < dir_info.files.size(); j++) {
+        const auto &file = dir_info.files[j];
+        owners.push_back(FileOwner{DialogId(), file.file_type});
+        path = dir_info.dir_path;
+        path.append(dir_info.get_name(file).begin(), file.name_length);
+        hash_to_pos.emplace(SliceHash()(path), std::make_pair(static_cast<uint32>(i), static_cast<uint32>(j)));
+      }
       if (token_) {
         return promise.set_error(Global::request_aborted_error());
       }
     }
+
     scan_db(token_, [&](DbFileInfo &db_info) {
-      auto it = hash_to_pos.find(Hash<string>()(db_info.path));
-      if (it == hash_to_pos.end()) {
-        return;
+      auto range = hash_to_pos.equal_range(SliceHash()(db_info.path));
+      for (auto it = range.first; it != range.second; ++it) {
+        auto dir_pos = it->second.first;
+        auto file_pos = it->second.second;
+        if (dir_infos[dir_pos]->is_path(dir_infos[dir_pos]->files[file_pos], db_info.path)) {
+          // LOG(INFO) << "Match! " << db_info.path << " from " << db_info.owner_dialog_id;
+          auto &owner = file_owners[dir_pos][file_pos];
+          owner.owner_dialog_id = db_info.owner_dialog_id;
+          owner.file_type = db_info.file_type;  // database file_type is the correct one
+          break;
+        }
       }
-      // LOG(INFO) << "Match! " << db_info.path << " from " << db_info.owner_dialog_id;
-      CHECK(it->second < full_infos.size());
-      auto &full_info = full_infos[it->second];
-      full_info.owner_dialog_id = db_info.owner_dialog_id;
-      full_info.file_type = db_info.file_type;  // database file_type is the correct one
     });
     if (token_) {
       return promise.set_error(Global::request_aborted_error());
     }
+  }
 
-    FileStats file_stats(need_all_files, split_by_owner_dialog_id);
-    for (auto &full_info : full_infos) {
-      file_stats.add(std::move(full_info));
-      if (token_) {
-        return promise.set_error(Global::request_aborted_error());
+  FileStats file_stats(need_all_files, use_file_database && split_by_owner_dialog_id);
+  for (size_t i = 0; i < dir_infos.size(); i++) {
+    const auto &dir_info = *dir_infos[i];
+    for (size_t j = 0; j < dir_info.files.size(); j++) {
+      const auto &file = dir_info.files[j];
+      FullFileInfo info;
+      if (use_file_database) {
+        info.file_type = file_owners[i][j].file_type;
+        info.owner_dialog_id = file_owners[i][j].owner_dialog_id;
+      } else {
+        info.file_type = file.file_type;
       }
+      if (need_all_files) {
+        info.path = dir_info.get_path(file);
+      }
+      info.is_temp = dir_info.is_temp;
+      info.size = file.size;
+      info.atime_nsec = file.atime_nsec;
+      info.mtime_nsec = file.mtime_nsec;
+      file_stats.add(std::move(info));
+    }
+    if (token_) {
+      return promise.set_error(Global::request_aborted_error());
     }
-    auto passed = Time::now() - start;
-    LOG_IF(INFO, passed > 0.5) << "Get file stats took: " << format::as_time(passed);
-    promise.set_value(std::move(file_stats));
   }
+  auto passed = Time::now() - start;
+  LOG_IF(INFO, passed > 0.5) << "Get file stats took: " << format::as_time(passed);
+  promise.set_value(std::move(file_stats));
 }
 
 }  // namespace td
@@ -11,20 +11,30 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/CancellationToken.h"
+#include "td/utils/common.h"
 #include "td/utils/Promise.h"
 
 namespace td {
 
 class FileStatsWorker final : public Actor {
  public:
-  FileStatsWorker(ActorShared<> parent, CancellationToken token)
-      : parent_(std::move(parent)), token_(std::move(token)) {
-  }
+  FileStatsWorker(ActorShared<> parent, CancellationToken token);
+  FileStatsWorker(const FileStatsWorker &) = delete;
+  FileStatsWorker &operator=(const FileStatsWorker &) = delete;
+  FileStatsWorker(FileStatsWorker &&) = delete;
+  FileStatsWorker &operator=(FileStatsWorker &&) = delete;
+  ~FileStatsWorker() final;
+
   void get_stats(bool need_all_files, bool split_by_owner_dialog_id, Promise<FileStats> promise);
 
  private:
+  struct FsSnapshot;
+
   ActorShared<> parent_;
   CancellationToken token_;
+
+  // results of the previous scan of file directories, which are reused if the directories weren't changed since then
+  unique_ptr<FsSnapshot> fs_snapshot_;
 };
 
 }  // namespace td
@@ -132,6 +132,9 @@ Status PartsManager::init(int64 size, int64 expected_size, bool is_size_final, s
       CHECK(is_upload_);
       return Status::Error("FILE_UPLOAD_RESTART");
     }
+  } else if (!is_upload_ && expected_size_ >= MIN_BIG_DOWNLOAD_SIZE) {
+    // the fewer queries are needed to download a big file, the faster it is downloaded
+    part_size_ = MAX_PART_SIZE;
   } else {
     part_size_ = 64 << 10;
     while (part_size_ < MAX_PART_SIZE && calc_part_count(expected_size_, part_size_) > MAX_PART_COUNT) {
@@ -59,6 +59,7 @@ class PartsManager {
   static constexpr int MAX_PART_COUNT_PREMIUM = 8000;
   static constexpr size_t MAX_PART_SIZE = 512 << 10;
   static constexpr int64 MAX_FILE_SIZE = static_cast<int64>(MAX_PART_SIZE) * MAX_PART_COUNT_PREMIUM;
+  static constexpr int64 MIN_BIG_DOWNLOAD_SIZE = 16 << 20;
 
   enum class PartStatus : int32 { Empty, Pending, Ready };
 
@@ -31,6 +31,17 @@ void ResourceManager::register_worker(ActorShared<FileLoaderActor> callback, int
   send_closure(node->callback_, &FileLoaderActor::set_resource_manager, actor_shared(this, node_id));
 }
 
+void ResourceManager::update_max_resource_limit(int64 max_resource_limit) {
+  if (stop_flag_ || max_resource_limit == max_resource_limit_) {
+    return;
+  }
+  VLOG(file_loader) << "Update maximum resource limit to " << max_resource_limit;
+  // if the limit is decreased, then already given resources aren't taken back and new ones aren't given until
+  // resources in use fit in the new limit
+  max_resource_limit_ = max_resource_limit;
+  loop();
+}
+
 void ResourceManager::update_priority(int8 priority) {
   if (stop_flag_) {
     return;
@@ -115,7 +126,7 @@ bool ResourceManager::satisfy_node(NodeId file_node_id) {
   give = min(need, give);
   give -= give % part_size;
   VLOG(file_loader) << tag("give", give);
-  if (give == 0) {
+  if (give <= 0) {
     return false;
   }
   resource_state_.start_use(give);
@@ -11,6 +11,8 @@
 #include "td/telegram/Td.h"
 #include "td/telegram/telegram_api.h"
 
+#include "td/mtproto/QueryPackingPolicy.h"
+
 #include "td/actor/actor.h"
 
 #include "td/utils/buffer.h"
@@ -61,18 +63,22 @@ NetQueryPtr NetQueryCreator::create(uint64 id, const telegram_api::object_ptr<te
     slice.as_mutable_slice().copy_from(prefix_str);
   }
 
-  size_t min_gzipped_size = 128;
+  size_t min_gzipped_size = mtproto::QueryPackingPolicy::Options().min_gzipped_size;
   int32 tl_constructor = function.get_id();
   int32 total_timeout_limit = 60;
 
   if (Scheduler::instance() != nullptr && current_scheduler_id_ == Scheduler::instance()->sched_id() &&
       !G()->close_flag()) {
+    auto reported_min_gzipped_size = G()->get_min_gzipped_query_size();
+    if (reported_min_gzipped_size != 0) {
+      min_gzipped_size = reported_min_gzipped_size;
+    }
     auto td = G()->td();
     if (!td.empty()) {
       auto auth_manager = td.get_actor_unsafe()->auth_manager_.get();
       if (auth_manager != nullptr && auth_manager->is_bot()) {
         total_timeout_limit = 8;
-        min_gzipped_size = 1024;
+        min_gzipped_size = max(min_gzipped_size, static_cast<size_t>(1024));
       }
       if ((auth_manager == nullptr || !auth_manager->was_authorized()) && auth_flag == NetQuery::AuthFlag::On &&
           tl_constructor != telegram_api::auth_exportAuthorization::ID &&
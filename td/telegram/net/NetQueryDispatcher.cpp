@@ -218,7 +218,7 @@ Status NetQueryDispatcher::wait_dc_init(DcId dc_id, bool force) {
     auto raw_dc_id = dc_id.get_raw_id();
     bool is_premium = G()->get_option_boolean("is_premium");
     int32 upload_session_count = (raw_dc_id != 2 && raw_dc_id != 4) || is_premium ? 8 : 4;
-    int32 download_session_count = is_premium ? 8 : 2;
+    int32 download_session_count = get_download_session_count();
     int32 download_small_session_count = is_premium ? 8 : 2;
     dc.main_session_ = create_actor_on_scheduler<SessionMultiProxy>(
         PSLICE() << "SessionMultiProxy:" << raw_dc_id << ":main", get_main_session_scheduler_id(), session_count,
@@ -285,6 +285,19 @@ void NetQueryDispatcher::update_session_count() {
     }
   }
 }
+
+void NetQueryDispatcher::update_download_session_count(DcId dc_id, int32 session_count) {
+  if (!dc_id.is_exact()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto raw_dc_id = dc_id.get_raw_id();
+  if (is_dc_inited(raw_dc_id)) {
+    send_closure_later(dcs_[raw_dc_id - 1].download_session_, &SessionMultiProxy::update_session_count,
+                       session_count);
+  }
+}
+
 void NetQueryDispatcher::destroy_auth_keys(Promise<> promise) {
   for (int32 i = 1; i < DcId::MAX_RAW_DC_ID && i <= 5; i++) {
     auto dc_id = DcId::internal(i);
@@ -333,6 +346,10 @@ bool NetQueryDispatcher::is_dc_inited(int32 raw_dc_id) {
   return dcs_[raw_dc_id - 1].is_valid_.load(std::memory_order_relaxed);
 }
 
+int32 NetQueryDispatcher::get_download_session_count() {
+  return G()->get_option_boolean("is_premium") ? 8 : 2;
+}
+
 int32 NetQueryDispatcher::get_session_count() {
   return max(narrow_cast<int32>(G()->get_option_integer("session_count")), 1);
 }
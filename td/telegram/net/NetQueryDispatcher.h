@@ -46,6 +46,7 @@ class NetQueryDispatcher {
   void stop();
 
   void update_session_count();
+  void update_download_session_count(DcId dc_id, int32 session_count);
   void destroy_auth_keys(Promise<> promise);
   void update_use_pfs();
   void update_mtproto_header();
@@ -59,6 +60,9 @@ class NetQueryDispatcher {
 
   void set_verification_token(int64 verification_id, string &&token, Promise<Unit> &&promise);
 
+  // returns default number of sessions for downloading of big files
+  static int32 get_download_session_count();
+
  private:
   std::atomic<bool> stop_flag_{false};
   bool need_destroy_auth_key_{false};
@@ -620,6 +620,10 @@ void Session::on_server_time_difference_updated(bool force) {
   shared_auth_data_->update_server_time_difference(auth_data_.get_server_time_difference(), force);
 }
 
+void Session::on_min_gzipped_size_updated(size_t min_gzipped_size) {
+  G()->set_min_gzipped_query_size(min_gzipped_size);
+}
+
 void Session::on_closed(Status status) {
   if (!close_flag_ && is_main_) {
     connection_token_.reset();
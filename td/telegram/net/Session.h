@@ -220,6 +220,8 @@ class Session final
   void on_server_salt_updated() final;
   void on_server_time_difference_updated(bool force) final;
 
+  void on_min_gzipped_size_updated(size_t min_gzipped_size) final;
+
   void on_new_session_created(uint64 unique_id, mtproto::MessageId first_message_id) final;
   void on_session_failed(Status status) final;
 
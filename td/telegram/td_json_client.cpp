@@ -27,6 +27,10 @@ const char *td_json_client_receive(void *client, double timeout) {
   return static_cast<td::ClientJson *>(client)->receive(timeout);
 }
 
+int td_json_client_receive_to_buffer(void *client, double timeout, char *buffer, size_t buffer_size) {
+  return static_cast<td::ClientJson *>(client)->receive(timeout, td::MutableSlice(buffer, buffer_size));
+}
+
 const char *td_json_client_execute(void *client, const char *request) {
   return td::ClientJson::execute(td::Slice(request == nullptr ? "" : request));
 }
@@ -43,6 +47,14 @@ const char *td_receive(double timeout) {
   return td::json_receive(timeout);
 }
 
+int td_receive_to_buffer(double timeout, char *buffer, size_t buffer_size) {
+  return td::json_receive(timeout, td::MutableSlice(buffer, buffer_size));
+}
+
+const char *td_receive_batch(int max_count, double timeout) {
+  return td::json_receive_batch(max_count <= 0 ? 1 : max_count, timeout);
+}
+
 const char *td_execute(const char *request) {
   return td::json_execute(td::Slice(request == nullptr ? "" : request));
 }
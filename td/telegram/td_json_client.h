@@ -50,6 +50,8 @@
 
 #include "td/telegram/tdjson_export.h"
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -76,6 +78,31 @@ TDJSON_EXPORT void td_send(int client_id, const char *request);
  */
 TDJSON_EXPORT const char *td_receive(double timeout);
 
+/**
+ * Receives incoming updates and request responses like td_receive, but serializes them directly to the provided buffer
+ * without additional copying. Must not be called simultaneously from two different threads.
+ * If the buffer is too small, then the response is kept by TDLib and will be returned by the next call to
+ * td_receive or td_receive_to_buffer.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \param[out] buffer The buffer to which the JSON-serialized null-terminated response will be written.
+ * \param[in] buffer_size Size of the buffer.
+ * \return Length of the response without the terminating null character, 0 if the timeout expires, or negative
+ *         minimum required buffer size if the buffer is too small to contain the response.
+ */
+TDJSON_EXPORT int td_receive_to_buffer(double timeout, char *buffer, size_t buffer_size);
+
+/**
+ * Receives several incoming updates and request responses at once. Must not be called simultaneously from two different
+ * threads. Waits only for the first update or response; all other already received ones are returned without waiting.
+ * The returned pointer can be used until the next call to td_receive, td_receive_batch or td_execute, after which
+ * it will be deallocated by TDLib.
+ * \param[in] max_count The maximum number of updates and request responses to return. Must be positive.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \return JSON-serialized null-terminated array of incoming updates and request responses in the order they were
+ *         received. May be NULL if the timeout expires.
+ */
+TDJSON_EXPORT const char *td_receive_batch(int max_count, double timeout);
+
 /**
  * Synchronously executes a TDLib request.
  * A request can be executed synchronously, only if it is documented with "Can be called synchronously".
@@ -165,6 +192,21 @@ TDJSON_EXPORT void td_json_client_send(void *client, const char *request);
  */
 TDJSON_EXPORT const char *td_json_client_receive(void *client, double timeout);
 
+/**
+ * Receives incoming updates and request responses from the TDLib client like td_json_client_receive, but serializes
+ * them directly to the provided buffer without additional copying. May be called from any thread, but
+ * must not be called simultaneously from two different threads.
+ * If the buffer is too small, then the response is kept by TDLib and will be returned by the next call to
+ * td_json_client_receive or td_json_client_receive_to_buffer.
+ * \param[in] client The client.
+ * \param[in] timeout The maximum number of seconds allowed for this function to wait for new data.
+ * \param[out] buffer The buffer to which the JSON-serialized null-terminated response will be written.
+ * \param[in] buffer_size Size of the buffer.
+ * \return Length of the response without the terminating null character, 0 if the timeout expires, or negative
+ *         minimum required buffer size if the buffer is too small to contain the response.
+ */
+TDJSON_EXPORT int td_json_client_receive_to_buffer(void *client, double timeout, char *buffer, size_t buffer_size);
+
 /**
  * Synchronously executes TDLib request. May be called from any thread.
  * Only a few requests can be executed synchronously.
@@ -166,7 +166,7 @@ std::enable_if_t<!std::is_constructible<T>::value, Status> from_json(tl_object_p
   if (constructor_value.type() == JsonValue::Type::Number) {
     constructor = to_integer<int32>(constructor_value.get_number());
   } else if (constructor_value.type() == JsonValue::Type::String) {
-    TRY_RESULT_ASSIGN(constructor, tl_constructor_from_string(to.get(), constructor_value.get_string().str()));
+    TRY_RESULT_ASSIGN(constructor, tl_constructor_from_string(to.get(), constructor_value.get_string()));
   } else {
     return Status::Error(PSLICE() << "Expected String or Integer, but receive " << constructor_value.type());
   }
@@ -199,4 +199,111 @@ std::enable_if_t<std::is_constructible<T>::value, Status> from_json(tl_object_pt
   return from_json(*to, from.get_object());
 }
 
+inline Status from_json(int32 &to, JsonParser &from) {
+  TRY_RESULT(value, from.read_simple_value());
+  return from_json(to, std::move(value));
+}
+
+inline Status from_json(bool &to, JsonParser &from) {
+  TRY_RESULT(value, from.read_simple_value());
+  return from_json(to, std::move(value));
+}
+
+inline Status from_json(int64 &to, JsonParser &from) {
+  TRY_RESULT(value, from.read_simple_value());
+  return from_json(to, std::move(value));
+}
+
+inline Status from_json(double &to, JsonParser &from) {
+  TRY_RESULT(value, from.read_simple_value());
+  return from_json(to, std::move(value));
+}
+
+inline Status from_json(string &to, JsonParser &from) {
+  TRY_RESULT(value, from.read_simple_value());
+  return from_json(to, std::move(value));
+}
+
+inline Status from_json_bytes(string &to, JsonParser &from) {
+  TRY_RESULT(value, from.read_simple_value());
+  return from_json_bytes(to, std::move(value));
+}
+
+template <class T>
+Status from_json(std::vector<T> &to, JsonParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Array) {
+    if (type == JsonValue::Type::Null) {
+      return from.skip_value();
+    }
+    return Status::Error(PSLICE() << "Expected Array, but receive " << type);
+  }
+  to.clear();
+  return from.read_array([&] {
+    to.emplace_back();
+    return from_json(to.back(), from);
+  });
+}
+
+template <class T>
+std::enable_if_t<!std::is_constructible<T>::value, Status> from_json(tl_object_ptr<T> &to, JsonParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Object) {
+    if (type == JsonValue::Type::Null) {
+      to = nullptr;
+      return from.skip_value();
+    }
+    return Status::Error(PSLICE() << "Expected Object, but receive " << type);
+  }
+
+  // the type must be known before the object is parsed; usually, it is the first field
+  TRY_RESULT(constructor_json, from.read_first_field("@type"));
+  if (constructor_json.empty()) {
+    TRY_RESULT_ASSIGN(constructor_json, from.peek_field("@type"));
+  }
+  if (constructor_json.empty()) {
+    return Status::Error("Can't find field \"@type\"");
+  }
+  if (constructor_json.find('\\') != Slice::npos) {
+    return Status::Error("Escaped characters in \"@type\" aren't supported");
+  }
+  TRY_RESULT(constructor_value, json_decode(constructor_json));
+  int32 constructor = 0;
+  if (constructor_value.type() == JsonValue::Type::Number) {
+    constructor = to_integer<int32>(constructor_value.get_number());
+  } else if (constructor_value.type() == JsonValue::Type::String) {
+    TRY_RESULT_ASSIGN(constructor, tl_constructor_from_string(to.get(), constructor_value.get_string()));
+  } else {
+    return Status::Error(PSLICE() << "Expected String or Integer, but receive " << constructor_value.type());
+  }
+
+  TlDowncastHelper<T> helper(constructor);
+  Status status;
+  bool ok = downcast_call(static_cast<T &>(helper), [&](auto &dummy) {
+    auto result = make_tl_object<std::decay_t<decltype(dummy)>>();
+    status = from_json(*result, from);
+    to = std::move(result);
+  });
+  TRY_STATUS(std::move(status));
+  if (!ok) {
+    return Status::Error(PSLICE() << "Unknown constructor " << format::as_hex(constructor));
+  }
+
+  return Status::OK();
+}
+
+template <class T>
+std::enable_if_t<std::is_constructible<T>::value, Status> from_json(tl_object_ptr<T> &to, JsonParser &from) {
+  auto type = from.peek_type();
+  if (type != JsonValue::Type::Object) {
+    if (type == JsonValue::Type::Null) {
+      to = nullptr;
+      return from.skip_value();
+    }
+    return Status::Error(PSLICE() << "Expected Object, but receive " << type);
+  }
+  to = make_tl_object<T>();
+  return from_json(*to, from);
+}
+
 }  // namespace td
@@ -0,0 +1,197 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/actor/ActorProfiler.h"
+
+#include "td/utils/filesystem.h"
+#include "td/utils/format.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/port/config.h"
+#include "td/utils/port/platform.h"
+#include "td/utils/port/thread_local.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
+
+#if TD_PORT_POSIX && !TD_EMSCRIPTEN
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace td {
+
+std::atomic<int32> ActorProfiler::sampling_period_{0};
+
+namespace {
+
+struct EventData {
+  int64 event_count = 0;
+  double run_time = 0.0;
+  double max_run_time = 0.0;
+};
+
+struct ActorData {
+  double mailbox_wait_time = 0.0;
+  // event names are string literals, so they can be stored as Slice
+  std::map<std::pair<Slice, uint64>, EventData> events;
+};
+
+std::mutex profile_mutex;
+std::map<string, ActorData> profile_actors;
+
+TD_THREAD_LOCAL int32 skipped_event_count;                     // static zero-initialized
+TD_THREAD_LOCAL bool is_next_event_sampled;                    // static zero-initialized
+TD_THREAD_LOCAL ActorProfiler::EventTimer *active_event_timer;  // static zero-initialized
+
+// raw addresses are useless without load address of the module, so the address is converted to a symbol name
+// or to an offset in the module, which can be resolved using addr2line
+string get_code_location(uint64 code_address) {
+#if TD_PORT_POSIX && !TD_EMSCRIPTEN
+  Dl_info info;
+  if (dladdr(reinterpret_cast<const void *>(static_cast<std::uintptr_t>(code_address)), &info) != 0) {
+    if (info.dli_sname != nullptr) {
+      int status = 0;
+      char *demangled_name = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+      if (demangled_name == nullptr) {
+        return info.dli_sname;
+      }
+      string result = demangled_name;
+      std::free(demangled_name);
+      return result;
+    }
+    if (info.dli_fname != nullptr) {
+      auto module_address = static_cast<uint64>(reinterpret_cast<std::uintptr_t>(info.dli_fbase));
+      return PSTRING() << format::as_hex(code_address - module_address) << " in " << info.dli_fname;
+    }
+  }
+#endif
+  // virtual member functions are represented by an offset in the virtual table
+  return PSTRING() << format::as_hex(code_address);
+}
+
+}  // namespace
+
+void ActorProfiler::set_sampling_period(int32 sampling_period) {
+  CHECK(0 <= sampling_period && sampling_period <= MAX_SAMPLING_PERIOD);
+  sampling_period_.store(sampling_period, std::memory_order_relaxed);
+}
+
+bool ActorProfiler::need_sample_slow() {
+  is_next_event_sampled = ++skipped_event_count >= get_sampling_period();
+  if (is_next_event_sampled) {
+    skipped_event_count = 0;
+  }
+  // time of the event must be excluded from the time of the active event
+  return is_next_event_sampled || active_event_timer != nullptr;
+}
+
+void ActorProfiler::add_event(Slice actor_name, const char *event_name, uint64 code_address, double run_time) {
+  // each sampled event represents sampling_period events
+  auto weight = max(get_sampling_period(), 1);
+  std::lock_guard<std::mutex> lock(profile_mutex);
+  auto &event = profile_actors[actor_name.str()].events[std::make_pair(Slice(event_name), code_address)];
+  event.event_count += weight;
+  event.run_time += run_time * weight;
+  event.max_run_time = max(event.max_run_time, run_time);
+}
+
+void ActorProfiler::add_mailbox_wait(Slice actor_name, double wait_time) {
+  auto weight = max(get_sampling_period(), 1);
+  std::lock_guard<std::mutex> lock(profile_mutex);
+  profile_actors[actor_name.str()].mailbox_wait_time += wait_time * weight;
+}
+
+ActorProfiler::Profile ActorProfiler::get_profile(bool reset) {
+  Profile profile;
+  profile.sampling_period = get_sampling_period();
+  {
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    for (auto &actor_it : profile_actors) {
+      ActorStatistics actor;
+      actor.name = actor_it.first;
+      actor.mailbox_wait_time = actor_it.second.mailbox_wait_time;
+      for (auto &event_it : actor_it.second.events) {
+        const auto &data = event_it.second;
+        actor.event_count += data.event_count;
+        actor.run_time += data.run_time;
+
+        EventStatistics event;
+        event.actor_name = actor.name;
+        auto code_address = event_it.first.second;
+        if (code_address == 0) {
+          event.event_name = event_it.first.first.str();
+        } else {
+          event.event_name = PSTRING() << event_it.first.first << " at " << get_code_location(code_address);
+        }
+        event.event_count = data.event_count;
+        event.run_time = data.run_time;
+        event.max_run_time = data.max_run_time;
+        profile.events.push_back(std::move(event));
+      }
+      profile.actors.push_back(std::move(actor));
+    }
+    if (reset) {
+      profile_actors.clear();
+    }
+  }
+
+  std::sort(profile.actors.begin(), profile.actors.end(),
+            [](const ActorStatistics &lhs, const ActorStatistics &rhs) { return lhs.run_time > rhs.run_time; });
+  std::sort(profile.events.begin(), profile.events.end(),
+            [](const EventStatistics &lhs, const EventStatistics &rhs) { return lhs.run_time > rhs.run_time; });
+  return profile;
+}
+
+Status ActorProfiler::dump_profile(const Profile &profile, CSlice file_path) {
+  string result = PSTRING() << "Sampling period: " << profile.sampling_period << '\n';
+  result += "\nActors: name, event count, run time, mailbox wait time\n";
+  for (auto &actor : profile.actors) {
+    result += PSTRING() << actor.name << '\t' << actor.event_count << '\t' << actor.run_time << '\t'
+                        << actor.mailbox_wait_time << '\n';
+  }
+  result += "\nEvents: actor name, event name, event count, run time, maximum run time\n";
+  for (auto &event : profile.events) {
+    result += PSTRING() << event.actor_name << '\t' << event.event_name << '\t' << event.event_count << '\t'
+                        << event.run_time << '\t' << event.max_run_time << '\n';
+  }
+  return write_file(file_path, result);
+}
+
+void ActorProfiler::EventTimer::start(Slice actor_name, const char *event_name, uint64 code_address) {
+  CHECK(event_name != nullptr);
+  CHECK(!is_started_);
+  is_started_ = true;
+  is_sampled_ = is_next_event_sampled;
+  if (is_sampled_) {
+    actor_name_ = actor_name.str();
+    event_name_ = event_name;
+    code_address_ = code_address;
+  }
+  parent_ = active_event_timer;
+  active_event_timer = this;
+  start_time_ = Time::now();
+}
+
+void ActorProfiler::EventTimer::finish() {
+  auto run_time = Time::now() - start_time_;
+  CHECK(active_event_timer == this);
+  active_event_timer = parent_;
+  if (parent_ != nullptr) {
+    parent_->child_time_ += run_time;
+  }
+  if (is_sampled_) {
+    add_event(actor_name_, event_name_, code_address_, max(run_time - child_time_, 0.0));
+  }
+}
+
+}  // namespace td
@@ -0,0 +1,108 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+#include "td/utils/Status.h"
+
+#include <atomic>
+
+namespace td {
+
+// Sampling profiler of actor events, which is disabled by default.
+// If enabled, every sampling_period-th event run by a scheduler is timed and accounted to its actor.
+// Events run immediately from another event are excluded from the time of the outer event.
+// Closures are identified by the called member function and lambdas by a static variable unique for the lambda type;
+// they are named after the symbol if it is exported, or by the offset in the containing module otherwise.
+class ActorProfiler {
+ public:
+  struct ActorStatistics {
+    string name;
+    int64 event_count = 0;
+    double run_time = 0.0;
+    double mailbox_wait_time = 0.0;
+  };
+
+  struct EventStatistics {
+    string actor_name;
+    string event_name;
+    int64 event_count = 0;
+    double run_time = 0.0;
+    double max_run_time = 0.0;
+  };
+
+  struct Profile {
+    int32 sampling_period = 0;
+    vector<ActorStatistics> actors;  // sorted by decreasing run time
+    vector<EventStatistics> events;  // sorted by decreasing run time
+  };
+
+  static constexpr int32 MAX_SAMPLING_PERIOD = 1000000;
+
+  // 0 disables the profiler, 1 makes it time every event
+  static void set_sampling_period(int32 sampling_period);
+
+  static int32 get_sampling_period() {
+    return sampling_period_.load(std::memory_order_relaxed);
+  }
+
+  static bool is_enabled() {
+    return get_sampling_period() != 0;
+  }
+
+  // returns true, if the next event must be timed; events run from a timed event are always timed,
+  // but are accounted only if sampled
+  static bool need_sample() {
+    return is_enabled() && need_sample_slow();
+  }
+
+  static void add_event(Slice actor_name, const char *event_name, uint64 code_address, double run_time);
+
+  static void add_mailbox_wait(Slice actor_name, double wait_time);
+
+  static Profile get_profile(bool reset);
+
+  static Status dump_profile(const Profile &profile, CSlice file_path) TD_WARN_UNUSED_RESULT;
+
+  class EventTimer {
+   public:
+    EventTimer() = default;
+    EventTimer(const EventTimer &) = delete;
+    EventTimer &operator=(const EventTimer &) = delete;
+    EventTimer(EventTimer &&) = delete;
+    EventTimer &operator=(EventTimer &&) = delete;
+    ~EventTimer() {
+      if (is_started_) {
+        finish();
+      }
+    }
+
+    // must be called only after need_sample returned true; the actor can be destroyed by the event,
+    // so its name is copied
+    void start(Slice actor_name, const char *event_name, uint64 code_address);
+
+   private:
+    string actor_name_;
+    const char *event_name_ = nullptr;
+    uint64 code_address_ = 0;
+    double start_time_ = 0.0;
+    double child_time_ = 0.0;  // total time of events run from the event
+    EventTimer *parent_ = nullptr;
+    bool is_started_ = false;
+    bool is_sampled_ = false;
+
+    void finish();
+  };
+
+ private:
+  static std::atomic<int32> sampling_period_;
+
+  static bool need_sample_slow();
+};
+
+}  // namespace td
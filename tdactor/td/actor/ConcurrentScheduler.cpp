@@ -6,6 +6,8 @@
 //
 #include "td/actor/ConcurrentScheduler.h"
 
+#include "td/actor/impl/WorkStealingPool.h"
+
 #include "td/utils/ExitGuard.h"
 #include "td/utils/MpscPollableQueue.h"
 #include "td/utils/port/thread_local.h"
@@ -15,9 +17,11 @@
 
 namespace td {
 
-ConcurrentScheduler::ConcurrentScheduler(int32 additional_thread_count, uint64 thread_affinity_mask) {
+ConcurrentScheduler::ConcurrentScheduler(int32 additional_thread_count, uint64 thread_affinity_mask,
+                                         bool enable_work_stealing) {
 #if TD_THREAD_UNSUPPORTED || TD_EVENTFD_UNSUPPORTED
   additional_thread_count = 0;
+  enable_work_stealing = false;
 #endif
   additional_thread_count++;
   std::vector<std::shared_ptr<MpscPollableQueue<EventFull>>> outbound(additional_thread_count);
@@ -54,6 +58,18 @@ ConcurrentScheduler::ConcurrentScheduler(int32 additional_thread_count, uint64 t
     sched->init(i, outbound, static_cast<Scheduler::Callback *>(this));
   }
 
+  if (enable_work_stealing && additional_thread_count > 1) {
+    // the extra scheduler has no own thread, so it can only add tasks
+    vector<Scheduler *> workers;
+    for (int32 i = 0; i < additional_thread_count; i++) {
+      workers.push_back(schedulers_[i].get());
+    }
+    work_stealing_pool_ = std::make_shared<WorkStealingPool>(std::move(workers));
+    for (auto &sched : schedulers_) {
+      sched->set_work_stealing_pool(work_stealing_pool_);
+    }
+  }
+
 #if TD_PORT_WINDOWS
   iocp_ = make_unique<detail::Iocp>();
   iocp_->init();
@@ -78,6 +94,14 @@ thread::id ConcurrentScheduler::get_scheduler_thread_id(int32 sched_id) {
 }
 #endif
 
+void ConcurrentScheduler::set_use_timer_wheel(bool use_timer_wheel) {
+  CHECK(state_ == State::Start);
+  for (auto &sched : schedulers_) {
+    auto guard = sched->get_guard();
+    sched->set_use_timer_wheel(use_timer_wheel);
+  }
+}
+
 void ConcurrentScheduler::start() {
   CHECK(state_ == State::Start);
   is_finished_.store(false, std::memory_order_relaxed);
@@ -181,7 +205,12 @@ void ConcurrentScheduler::finish() {
   iocp_thread_.join();
 #endif
 
+  if (work_stealing_pool_ != nullptr) {
+    auto guard = schedulers_[0]->get_guard();
+    work_stealing_pool_->clear();
+  }
   schedulers_.clear();
+  work_stealing_pool_ = nullptr;
   for (auto &f : at_finish_) {
     f();
   }
@@ -19,6 +19,7 @@
 
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <utility>
 
@@ -26,7 +27,9 @@ namespace td {
 
 class ConcurrentScheduler final : private Scheduler::Callback {
  public:
-  explicit ConcurrentScheduler(int32 additional_thread_count, uint64 thread_affinity_mask = 0);
+  // if work stealing is enabled, then tasks passed to Scheduler::run_stealable can be run by any idle scheduler thread
+  explicit ConcurrentScheduler(int32 additional_thread_count, uint64 thread_affinity_mask = 0,
+                               bool enable_work_stealing = false);
 
   void finish_async() {
     schedulers_[0]->finish();
@@ -58,6 +61,9 @@ class ConcurrentScheduler final : private Scheduler::Callback {
   thread::id get_scheduler_thread_id(int32 sched_id);
 #endif
 
+  // must be called before start; actor timeouts will be kept in timer wheels instead of heaps
+  void set_use_timer_wheel(bool use_timer_wheel);
+
   void start();
 
   bool run_main(double timeout) {
@@ -97,6 +103,7 @@ class ConcurrentScheduler final : private Scheduler::Callback {
   std::mutex at_finish_mutex_;
   vector<std::function<void()>> at_finish_;  // can be used during destruction by Scheduler destructors
   vector<unique_ptr<Scheduler>> schedulers_;
+  std::shared_ptr<WorkStealingPool> work_stealing_pool_;
   std::atomic<bool> is_finished_{false};
 #if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
   vector<td::thread> threads_;
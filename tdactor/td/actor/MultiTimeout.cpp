@@ -8,42 +8,43 @@
 
 #include "td/utils/logging.h"
 
+#include <algorithm>
+#include <utility>
+
 namespace td {
 
 bool MultiTimeout::has_timeout(int64 key) const {
-  return items_.count(Item(key)) > 0;
+  return items_.count(key) > 0;
+}
+
+MultiTimeout::Item *MultiTimeout::add_item(int64 key) {
+  auto it = items_.find(key);
+  if (it == items_.end()) {
+    it = items_.emplace(key, Item(key)).first;
+  }
+  return &it->second;
 }
 
 void MultiTimeout::set_timeout_at(int64 key, double timeout) {
   LOG(DEBUG) << "Set " << get_name() << " for " << key << " in " << timeout - Time::now();
-  auto item = items_.emplace(key);
-  auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item.first));
-  if (heap_node->in_heap()) {
-    CHECK(!item.second);
-    bool need_update_timeout = heap_node->is_top();
-    timeout_queue_.fix(timeout, heap_node);
-    if (need_update_timeout || heap_node->is_top()) {
-      update_timeout("set_timeout");
-    }
+  auto item = add_item(key);
+  if (item->in_timer_wheel()) {
+    timeout_queue_.fix(timeout, item);
   } else {
-    CHECK(item.second);
-    timeout_queue_.insert(timeout, heap_node);
-    if (heap_node->is_top()) {
-      update_timeout("set_timeout 2");
-    }
+    timeout_queue_.insert(timeout, item);
+  }
+  // if the item had been the first to expire, the actor just wakes up earlier than needed
+  if (!Actor::has_timeout() || timeout < timeout_at_) {
+    update_timeout("set_timeout");
   }
 }
 
 void MultiTimeout::add_timeout_at(int64 key, double timeout) {
   LOG(DEBUG) << "Add " << get_name() << " for " << key << " in " << timeout - Time::now();
-  auto item = items_.emplace(key);
-  auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item.first));
-  if (heap_node->in_heap()) {
-    CHECK(!item.second);
-  } else {
-    CHECK(item.second);
-    timeout_queue_.insert(timeout, heap_node);
-    if (heap_node->is_top()) {
+  auto item = add_item(key);
+  if (!item->in_timer_wheel()) {
+    timeout_queue_.insert(timeout, item);
+    if (!Actor::has_timeout() || timeout < timeout_at_) {
       update_timeout("add_timeout");
     }
   }
@@ -51,15 +52,13 @@ void MultiTimeout::add_timeout_at(int64 key, double timeout) {
 
 void MultiTimeout::cancel_timeout(int64 key, const char *source) {
   LOG(DEBUG) << "Cancel " << get_name() << " for " << key;
-  auto item = items_.find(Item(key));
-  if (item != items_.end()) {
-    auto heap_node = static_cast<HeapNode *>(const_cast<Item *>(&*item));
-    CHECK(heap_node->in_heap());
-    bool need_update_timeout = heap_node->is_top();
-    timeout_queue_.erase(heap_node);
-    items_.erase(item);
+  auto it = items_.find(key);
+  if (it != items_.end()) {
+    CHECK(it->second.in_timer_wheel());
+    timeout_queue_.erase(&it->second);
+    items_.erase(it);
 
-    if (need_update_timeout) {
+    if (items_.empty()) {
       update_timeout(source);
     }
   }
@@ -81,16 +80,18 @@ void MultiTimeout::update_timeout(const char *source) {
       Actor::cancel_timeout();
     }
   } else {
-    LOG(DEBUG) << "Set timeout of " << get_name() << " in " << timeout_queue_.top_key() - Time::now_cached();
-    Actor::set_timeout_at(timeout_queue_.top_key());
+    timeout_at_ = timeout_queue_.get_next_time();
+    LOG(DEBUG) << "Set timeout of " << get_name() << " in " << timeout_at_ - Time::now_cached();
+    Actor::set_timeout_at(timeout_at_);
   }
 }
 
 vector<int64> MultiTimeout::get_expired_keys(double now) {
   vector<int64> expired_keys;
-  while (!timeout_queue_.empty() && timeout_queue_.top_key() < now) {
-    int64 key = static_cast<Item *>(timeout_queue_.pop())->key;
-    items_.erase(Item(key));
+  TimerWheelNode *node;
+  while ((node = timeout_queue_.pop_expired(now)) != nullptr) {
+    int64 key = static_cast<Item *>(node)->key;
+    items_.erase(key);
     expired_keys.push_back(key);
   }
   return expired_keys;
@@ -107,7 +108,17 @@ void MultiTimeout::timeout_expired() {
 }
 
 void MultiTimeout::run_all() {
-  vector<int64> expired_keys = get_expired_keys(Time::now_cached() + 1e10);
+  vector<std::pair<double, int64>> expired_items;
+  TimerWheelNode *node;
+  while ((node = timeout_queue_.pop()) != nullptr) {
+    expired_items.emplace_back(node->key_, static_cast<Item *>(node)->key);
+  }
+  std::sort(expired_items.begin(), expired_items.end());
+  vector<int64> expired_keys;
+  for (auto &expired_item : expired_items) {
+    items_.erase(expired_item.second);
+    expired_keys.push_back(expired_item.second);
+  }
   if (!expired_keys.empty()) {
     update_timeout("run_all");
   }
@@ -9,25 +9,22 @@
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
-#include "td/utils/Heap.h"
+#include "td/utils/HashTableUtils.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Time.h"
+#include "td/utils/TimerWheel.h"
 
-#include <set>
+#include <unordered_map>
 
 namespace td {
 
-// TODO optimize
+// timeouts are kept in a timer wheel, so they are set and cancelled in O(1), but can expire up to 1 ms later
 class MultiTimeout final : public Actor {
-  struct Item final : public HeapNode {
+  struct Item final : public TimerWheelNode {
     int64 key;
 
     explicit Item(int64 key) : key(key) {
     }
-
-    bool operator<(const Item &other) const {
-      return key < other.key;
-    }
   };
 
  public:
@@ -68,8 +65,11 @@ class MultiTimeout final : public Actor {
   Callback callback_;
   Data data_;
 
-  KHeap<double> timeout_queue_;
-  std::set<Item> items_;
+  TimerWheel timeout_queue_;
+  std::unordered_map<int64, Item, Hash<int64>> items_;
+  double timeout_at_ = 0.0;  // the last time passed to Actor::set_timeout_at
+
+  Item *add_item(int64 key);
 
   void update_timeout(const char *source);
 
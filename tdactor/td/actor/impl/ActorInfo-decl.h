@@ -15,6 +15,7 @@
 #include "td/utils/ObjectPool.h"
 #include "td/utils/Slice.h"
 #include "td/utils/StringBuilder.h"
+#include "td/utils/TimerWheel.h"
 
 #include <atomic>
 #include <memory>
@@ -49,7 +50,8 @@ class ActorContext {
 
 class ActorInfo final
     : private ListNode
-    , private HeapNode {
+    , private HeapNode
+    , private TimerWheelNode {
  public:
   enum class Deleter : uint8 { Destroy, None };
 
@@ -95,6 +97,10 @@ class ActorInfo final
   const HeapNode *get_heap_node() const;
   static ActorInfo *from_heap_node(HeapNode *node);
 
+  TimerWheelNode *get_timer_wheel_node();
+  const TimerWheelNode *get_timer_wheel_node() const;
+  static ActorInfo *from_timer_wheel_node(TimerWheelNode *node);
+
   ListNode *get_list_node();
   const ListNode *get_list_node() const;
   static ActorInfo *from_list_node(ListNode *node);
@@ -104,6 +110,7 @@ class ActorInfo final
   void finish_run();
 
   vector<Event> mailbox_;
+  double mailbox_wait_start_time_ = 0.0;  // time since which the mailbox is non-empty; used only by the profiler
 
   bool need_context() const;
   bool need_start_up() const;
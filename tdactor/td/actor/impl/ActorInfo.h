@@ -89,6 +89,7 @@ inline void ActorInfo::destroy_actor() {
   }
   actor_ = nullptr;
   mailbox_.clear();
+  mailbox_wait_start_time_ = 0.0;
 }
 
 template <class ActorT>
@@ -196,6 +197,15 @@ inline const HeapNode *ActorInfo::get_heap_node() const {
 inline ActorInfo *ActorInfo::from_heap_node(HeapNode *node) {
   return static_cast<ActorInfo *>(node);
 }
+inline TimerWheelNode *ActorInfo::get_timer_wheel_node() {
+  return this;
+}
+inline const TimerWheelNode *ActorInfo::get_timer_wheel_node() const {
+  return this;
+}
+inline ActorInfo *ActorInfo::from_timer_wheel_node(TimerWheelNode *node) {
+  return static_cast<ActorInfo *>(node);
+}
 inline ListNode *ActorInfo::get_list_node() {
   return this;
 }
@@ -8,8 +8,10 @@
 
 #include "td/utils/Closure.h"
 #include "td/utils/common.h"
+#include "td/utils/SmallObjectAllocator.h"
 #include "td/utils/StringBuilder.h"
 
+#include <cstring>
 #include <type_traits>
 #include <utility>
 
@@ -38,6 +40,17 @@ template <class T>
 std::enable_if_t<!std::is_base_of<Actor, T>::value> finish_migrate(T &obj) {
 }
 
+namespace detail {
+// for non-virtual member functions the pointer starts with the address of the function's code,
+// which is enough to find the function in actor profiles
+template <class FunctionT>
+uint64 get_function_code_address(const FunctionT &func) {
+  uint64 result = 0;
+  std::memcpy(&result, &func, min(sizeof(result), sizeof(func)));
+  return result;
+}
+}  // namespace detail
+
 class CustomEvent {
  public:
   CustomEvent() = default;
@@ -47,11 +60,22 @@ class CustomEvent {
   CustomEvent &operator=(CustomEvent &&) = delete;
   virtual ~CustomEvent() = default;
 
+  // custom events are created for almost every sent closure, so their memory is reused
+  TD_SMALL_OBJECT_ALLOCATION
+
   virtual void run(Actor *actor) = 0;
   virtual void start_migrate(int32 sched_id) {
   }
   virtual void finish_migrate() {
   }
+
+  // for the actor profiler
+  virtual const char *get_name() const {
+    return "custom";
+  }
+  virtual uint64 get_code_address() const {
+    return 0;
+  }
 };
 
 template <class ClosureT>
@@ -78,6 +102,13 @@ class ClosureEvent final : public CustomEvent {
     });
   }
 
+  const char *get_name() const final {
+    return "closure";
+  }
+  uint64 get_code_address() const final {
+    return detail::get_function_code_address(closure_.get_function());
+  }
+
  private:
   ClosureT closure_;
 };
@@ -92,6 +123,20 @@ class LambdaEvent final : public CustomEvent {
   explicit LambdaEvent(FromLambdaT &&func) : f_(std::forward<FromLambdaT>(func)) {
   }
 
+  const char *get_name() const final {
+    return "lambda";
+  }
+  uint64 get_code_address() const final {
+    return get_lambda_code_address();
+  }
+
+  // lambda type has no name, so the address of a variable unique for the lambda is used instead;
+  // the variable's symbol contains the lambda type
+  static uint64 get_lambda_code_address() {
+    static const char marker = 0;
+    return static_cast<uint64>(reinterpret_cast<std::uintptr_t>(&marker));
+  }
+
  private:
   LambdaT f_;
 };
@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/actor/ActorProfiler.h"
 #include "td/actor/impl/Actor-decl.h"
 #include "td/actor/impl/ActorId-decl.h"
 #include "td/actor/impl/EventFull-decl.h"
@@ -26,6 +27,7 @@
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Time.h"
+#include "td/utils/TimerWheel.h"
 #include "td/utils/type_traits.h"
 
 #include <functional>
@@ -40,6 +42,7 @@ extern int VERBOSITY_NAME(actor);
 class ActorInfo;
 
 class Scheduler;
+class WorkStealingPool;
 class SchedulerGuard {
  public:
   explicit SchedulerGuard(Scheduler *scheduler, bool lock = true);
@@ -98,6 +101,15 @@ class Scheduler {
 
   void run_on_scheduler(int32 sched_id, Promise<Unit> action);  // TODO Action
 
+  // runs a task, which doesn't access actors' state, on any idle scheduler thread,
+  // or immediately if work stealing is disabled; the task is run with the current actor context
+  void run_stealable(Promise<Unit> task);
+
+  void set_work_stealing_pool(std::shared_ptr<WorkStealingPool> pool);
+
+  // actor timeouts are kept in a timer wheel with 1 ms resolution instead of a heap
+  void set_use_timer_wheel(bool use_timer_wheel);
+
   template <class T>
   void destroy_on_scheduler(int32 sched_id, T &value);
 
@@ -182,6 +194,8 @@ class Scheduler {
 
   void do_event(ActorInfo *actor, Event &&event);
 
+  static void start_event_timer(ActorProfiler::EventTimer &timer, const ActorInfo *actor_info, const Event &event);
+
   void enter_actor(ActorInfo *actor_info);
   void exit_actor(ActorInfo *actor_info);
 
@@ -212,10 +226,13 @@ class Scheduler {
 
   void send_later_impl(const ActorId<> &actor_id, Event &&event);
 
+  void flush_outbound_events();
+
   Timestamp run_timeout();
   void run_mailbox();
   Timestamp run_events(Timestamp timeout);
   void run_poll(Timestamp timeout);
+  bool run_stealable_tasks(Timestamp timeout);
 
   template <class ActorT>
   ActorOwn<ActorT> register_actor_impl(Slice name, ActorT *actor_ptr, Actor::Deleter deleter, int32 sched_id);
@@ -223,6 +240,8 @@ class Scheduler {
 
   static TD_THREAD_LOCAL Scheduler *scheduler_;
   static TD_THREAD_LOCAL ActorContext *context_;
+  // the scheduler, which runs events in the current thread; events sent from it to other schedulers are batched
+  static TD_THREAD_LOCAL Scheduler *running_scheduler_;
 
   Callback *callback_ = nullptr;
   unique_ptr<ObjectPool<ActorInfo>> actor_info_pool_;
@@ -231,6 +250,8 @@ class Scheduler {
   ListNode pending_actors_list_;
   ListNode ready_actors_list_;
   KHeap<double> timeout_queue_;
+  TimerWheel timeout_wheel_;
+  bool use_timer_wheel_ = false;
 
   FlatHashMap<ActorInfo *, std::vector<Event>> pending_events_;
 
@@ -245,6 +266,9 @@ class Scheduler {
   int32 sched_n_ = 0;
   std::shared_ptr<MpscPollableQueue<EventFull>> inbound_queue_;
   std::vector<std::shared_ptr<MpscPollableQueue<EventFull>>> outbound_queues_;
+  std::vector<std::vector<EventFull>> outbound_events_;
+  bool has_outbound_events_ = false;
+  std::shared_ptr<WorkStealingPool> work_stealing_pool_;
 
   std::shared_ptr<ActorContext> save_context_;
 
@@ -6,11 +6,13 @@
 //
 #include "td/actor/impl/Scheduler.h"
 
+#include "td/actor/ActorProfiler.h"
 #include "td/actor/impl/Actor.h"
 #include "td/actor/impl/ActorId.h"
 #include "td/actor/impl/ActorInfo.h"
 #include "td/actor/impl/Event.h"
 #include "td/actor/impl/EventFull.h"
+#include "td/actor/impl/WorkStealingPool.h"
 
 #include "td/utils/algorithm.h"
 #include "td/utils/common.h"
@@ -37,6 +39,7 @@ int VERBOSITY_NAME(actor) = VERBOSITY_NAME(DEBUG) + 10;
 
 TD_THREAD_LOCAL Scheduler *Scheduler::scheduler_;   // static zero-initialized
 TD_THREAD_LOCAL ActorContext *Scheduler::context_;  // static zero-initialized
+TD_THREAD_LOCAL Scheduler *Scheduler::running_scheduler_;  // static zero-initialized
 
 Scheduler::~Scheduler() {
   clear();
@@ -127,6 +130,10 @@ SchedulerGuard::SchedulerGuard(Scheduler *scheduler, bool lock) : scheduler_(sch
     scheduler_->has_guard_ = true;
   }
   is_locked_ = lock;
+  if (Scheduler::running_scheduler_ != nullptr && Scheduler::running_scheduler_ != scheduler_) {
+    // events sent through another scheduler must not outrun already sent events
+    Scheduler::running_scheduler_->flush_outbound_events();
+  }
   save_scheduler_ = Scheduler::instance();
   Scheduler::set_scheduler(scheduler_);
 
@@ -229,6 +236,7 @@ void Scheduler::init(int32 id, std::vector<std::shared_ptr<MpscPollableQueue<Eve
   outbound_queues_ = std::move(outbound);
   sched_id_ = id;
   sched_n_ = static_cast<int32>(outbound_queues_.size());
+  outbound_events_.resize(outbound_queues_.size());
   service_actor_.set_queue(inbound_queue_);
   register_actor(PSLICE() << "ServiceActor" << id, &service_actor_).release();
 }
@@ -267,6 +275,10 @@ void Scheduler::do_event(ActorInfo *actor_info, Event &&event) {
   event_context_ptr_->link_token = event.link_token;
   auto actor = actor_info->get_actor_unsafe();
   VLOG(actor) << *actor_info << ' ' << event;
+  ActorProfiler::EventTimer profiler_timer;
+  if (ActorProfiler::need_sample()) {
+    start_event_timer(profiler_timer, actor_info, event);
+  }
   switch (event.type) {
     case Event::Type::Start:
       actor->start_up();
@@ -301,6 +313,29 @@ void Scheduler::do_event(ActorInfo *actor_info, Event &&event) {
   // can't clear event here. It may be already destroyed during destroy_actor
 }
 
+void Scheduler::start_event_timer(ActorProfiler::EventTimer &timer, const ActorInfo *actor_info, const Event &event) {
+  switch (event.type) {
+    case Event::Type::Start:
+      return timer.start(actor_info->get_name(), "start_up", 0);
+    case Event::Type::Stop:
+      return timer.start(actor_info->get_name(), "tear_down", 0);
+    case Event::Type::Yield:
+      return timer.start(actor_info->get_name(), "wakeup", 0);
+    case Event::Type::Hangup:
+      return timer.start(actor_info->get_name(), "hangup", 0);
+    case Event::Type::Timeout:
+      return timer.start(actor_info->get_name(), "timeout_expired", 0);
+    case Event::Type::Raw:
+      return timer.start(actor_info->get_name(), "raw_event", 0);
+    case Event::Type::Custom:
+      return timer.start(actor_info->get_name(), event.data.custom_event->get_name(),
+                         event.data.custom_event->get_code_address());
+    case Event::Type::NoType:
+    default:
+      UNREACHABLE();
+  }
+}
+
 void Scheduler::get_actor_sched_id_to_send_immediately(const ActorInfo *actor_info, int32 &actor_sched_id,
                                                        bool &on_current_sched, bool &can_send_immediately) {
   bool is_migrating;
@@ -363,11 +398,32 @@ void Scheduler::send_to_other_scheduler(int32 sched_id, const ActorId<> &actor_i
       VLOG(actor) << "Send to scheduler " << sched_id << ": " << event;
     }
     start_migrate(event, sched_id);
+    if (running_scheduler_ == this) {
+      // the events are delivered after the current pass over actors' mailboxes
+      outbound_events_[sched_id].push_back(EventCreator::event_unsafe(actor_id, std::move(event)));
+      has_outbound_events_ = true;
+      return;
+    }
     outbound_queues_[sched_id]->writer_put(EventCreator::event_unsafe(actor_id, std::move(event)));
     outbound_queues_[sched_id]->writer_flush();
   }
 }
 
+void Scheduler::flush_outbound_events() {
+  if (!has_outbound_events_) {
+    return;
+  }
+  has_outbound_events_ = false;
+  for (size_t sched_id = 0; sched_id < outbound_events_.size(); sched_id++) {
+    auto &events = outbound_events_[sched_id];
+    if (!events.empty()) {
+      VLOG(actor) << "Send " << events.size() << " events to scheduler " << sched_id;
+      outbound_queues_[sched_id]->writer_put_batch(events);
+      outbound_queues_[sched_id]->writer_flush();
+    }
+  }
+}
+
 void Scheduler::run_on_scheduler(int32 sched_id, Promise<Unit> action) {
   if (sched_id >= 0 && sched_id_ != sched_id) {
     class Worker final : public Actor {
@@ -390,6 +446,38 @@ void Scheduler::run_on_scheduler(int32 sched_id, Promise<Unit> action) {
   action.set_value(Unit());
 }
 
+void Scheduler::run_stealable(Promise<Unit> task) {
+  if (work_stealing_pool_ == nullptr || close_flag_) {
+    task.set_value(Unit());
+    return;
+  }
+  work_stealing_pool_->push(sched_id_, std::move(task), context_->this_ptr_.lock());
+}
+
+void Scheduler::set_work_stealing_pool(std::shared_ptr<WorkStealingPool> pool) {
+  work_stealing_pool_ = std::move(pool);
+}
+
+void Scheduler::set_use_timer_wheel(bool use_timer_wheel) {
+  if (use_timer_wheel_ == use_timer_wheel) {
+    return;
+  }
+  use_timer_wheel_ = use_timer_wheel;
+  if (use_timer_wheel) {
+    while (!timeout_queue_.empty()) {
+      auto timeout_at = timeout_queue_.top_key();
+      auto actor_info = ActorInfo::from_heap_node(timeout_queue_.pop());
+      timeout_wheel_.insert(timeout_at, actor_info->get_timer_wheel_node());
+    }
+  } else {
+    TimerWheelNode *node;
+    while ((node = timeout_wheel_.pop()) != nullptr) {
+      auto actor_info = ActorInfo::from_timer_wheel_node(node);
+      timeout_queue_.insert(node->key_, actor_info->get_heap_node());
+    }
+  }
+}
+
 void Scheduler::destroy_on_scheduler_impl(int32 sched_id, Promise<Unit> action) {
   auto empty_context = std::make_shared<ActorContext>();
   empty_context->this_ptr_ = empty_context;
@@ -412,6 +500,9 @@ void Scheduler::add_to_mailbox(ActorInfo *actor_info, Event &&event) {
     ready_actors_list_.put(node);
   }
   VLOG(actor) << "Add to mailbox: " << *actor_info << " " << event;
+  if (actor_info->mailbox_.empty() && ActorProfiler::is_enabled()) {
+    actor_info->mailbox_wait_start_time_ = Time::now();
+  }
   actor_info->mailbox_.push_back(std::move(event));
 }
 
@@ -484,6 +575,10 @@ void Scheduler::start_migrate_actor(ActorInfo *actor_info, int32 dest_sched_id)
 }
 
 double Scheduler::get_actor_timeout(const ActorInfo *actor_info) const {
+  if (use_timer_wheel_) {
+    const TimerWheelNode *timer_wheel_node = actor_info->get_timer_wheel_node();
+    return timer_wheel_node->in_timer_wheel() ? timeout_wheel_.get_key(timer_wheel_node) - Time::now() : 0.0;
+  }
   const HeapNode *heap_node = actor_info->get_heap_node();
   return heap_node->in_heap() ? timeout_queue_.get_key(heap_node) - Time::now() : 0.0;
 }
@@ -500,8 +595,17 @@ void Scheduler::set_actor_timeout_in(ActorInfo *actor_info, double timeout) {
 }
 
 void Scheduler::set_actor_timeout_at(ActorInfo *actor_info, double timeout_at) {
-  HeapNode *heap_node = actor_info->get_heap_node();
   VLOG(actor) << "Set actor " << *actor_info << " timeout in " << timeout_at - Time::now_cached();
+  if (use_timer_wheel_) {
+    TimerWheelNode *timer_wheel_node = actor_info->get_timer_wheel_node();
+    if (timer_wheel_node->in_timer_wheel()) {
+      timeout_wheel_.fix(timeout_at, timer_wheel_node);
+    } else {
+      timeout_wheel_.insert(timeout_at, timer_wheel_node);
+    }
+    return;
+  }
+  HeapNode *heap_node = actor_info->get_heap_node();
   if (heap_node->in_heap()) {
     timeout_queue_.fix(timeout_at, heap_node);
   } else {
@@ -521,16 +625,35 @@ void Scheduler::run_poll(Timestamp timeout) {
 #endif
 }
 
+bool Scheduler::run_stealable_tasks(Timestamp timeout) {
+  bool has_run = false;
+  while (work_stealing_pool_->run_one(sched_id_)) {
+    has_run = true;
+    // own actors have priority over stolen tasks
+    if (!ready_actors_list_.empty() || yield_flag_ || timeout.is_in_past()) {
+      break;
+    }
+  }
+  return has_run;
+}
+
 void Scheduler::flush_mailbox(ActorInfo *actor_info) {
   auto &mailbox = actor_info->mailbox_;
   size_t mailbox_size = mailbox.size();
   CHECK(mailbox_size != 0);
+  if (actor_info->mailbox_wait_start_time_ != 0.0 && ActorProfiler::need_sample()) {
+    ActorProfiler::add_mailbox_wait(actor_info->get_name(), Time::now() - actor_info->mailbox_wait_start_time_);
+  }
   EventGuard guard(this, actor_info);
   size_t i = 0;
   for (; i < mailbox_size && guard.can_run(); i++) {
     do_event(actor_info, std::move(mailbox[i]));
   }
   mailbox.erase(mailbox.begin(), mailbox.begin() + i);
+  if (actor_info->mailbox_wait_start_time_ != 0.0) {
+    // the remaining events wait for the next pass
+    actor_info->mailbox_wait_start_time_ = mailbox.empty() ? 0.0 : Time::now();
+  }
 }
 
 void Scheduler::run_mailbox() {
@@ -565,6 +688,14 @@ void Scheduler::run_mailbox() {
 Timestamp Scheduler::run_timeout() {
   double now = Time::now();
   //TODO: use Timestamp().is_in_past()
+  if (use_timer_wheel_) {
+    TimerWheelNode *node;
+    while ((node = timeout_wheel_.pop_expired(now)) != nullptr) {
+      ActorInfo *actor_info = ActorInfo::from_timer_wheel_node(node);
+      send_immediately(actor_info->actor_id(), Event::timeout());
+    }
+    return get_timeout();
+  }
   while (!timeout_queue_.empty() && timeout_queue_.top_key() < now) {
     HeapNode *node = timeout_queue_.pop();
     ActorInfo *actor_info = ActorInfo::from_heap_node(node);
@@ -580,13 +711,18 @@ Timestamp Scheduler::run_events(Timestamp timeout) {
   do {
     run_mailbox();
     res = run_timeout();
+    flush_outbound_events();
   } while (!ready_actors_list_.empty() && !timeout.is_in_past());
   return res;
 }
 
 void Scheduler::run_no_guard(Timestamp timeout) {
   CHECK(has_guard_);
+  auto saved_running_scheduler = running_scheduler_;
+  running_scheduler_ = this;
   SCOPE_EXIT {
+    flush_outbound_events();
+    running_scheduler_ = saved_running_scheduler;
     yield_flag_ = false;
   };
 
@@ -594,7 +730,22 @@ void Scheduler::run_no_guard(Timestamp timeout) {
   if (yield_flag_) {
     return;
   }
+  bool is_idle = false;
+  if (work_stealing_pool_ != nullptr) {
+    if (run_stealable_tasks(timeout)) {
+      // there can be more tasks to run, so just check for new events
+      timeout = Timestamp::now();
+    } else if (work_stealing_pool_->try_set_idle(sched_id_)) {
+      is_idle = true;
+    } else {
+      timeout = Timestamp::now();
+    }
+  }
+  flush_outbound_events();
   run_poll(timeout);
+  if (is_idle) {
+    work_stealing_pool_->set_busy(sched_id_);
+  }
   run_events(timeout);
 }
 
@@ -602,6 +753,12 @@ Timestamp Scheduler::get_timeout() {
   if (!ready_actors_list_.empty()) {
     return Timestamp::in(0);
   }
+  if (use_timer_wheel_) {
+    if (timeout_wheel_.empty()) {
+      return Timestamp::in(10000);
+    }
+    return Timestamp::at(timeout_wheel_.get_next_time());
+  }
   if (timeout_queue_.empty()) {
     return Timestamp::in(10000);
   }
@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include "td/actor/ActorProfiler.h"
 #include "td/actor/impl/ActorInfo-decl.h"
 #include "td/actor/impl/Scheduler-decl.h"
 
@@ -209,6 +210,11 @@ void Scheduler::send_lambda_immediately(ActorRef actor_ref, EventT &&func) {
       actor_ref.get(),
       [&](ActorInfo *actor_info) {
         event_context_ptr_->link_token = actor_ref.token();
+        ActorProfiler::EventTimer profiler_timer;
+        if (ActorProfiler::need_sample()) {
+          profiler_timer.start(actor_info->get_name(), "lambda",
+                               LambdaEvent<std::decay_t<EventT>>::get_lambda_code_address());
+        }
         func();
       },
       [&] {
@@ -231,6 +237,11 @@ void Scheduler::send_closure_immediately(ActorRef actor_ref, EventT &&closure) {
       actor_ref.get(),
       [&](ActorInfo *actor_info) {
         event_context_ptr_->link_token = actor_ref.token();
+        ActorProfiler::EventTimer profiler_timer;
+        if (ActorProfiler::need_sample()) {
+          profiler_timer.start(actor_info->get_name(), "closure",
+                               detail::get_function_code_address(closure.get_function()));
+        }
         closure.run(static_cast<typename EventT::ActorType *>(actor_info->get_actor_unsafe()));
       },
       [&] {
@@ -312,6 +323,13 @@ inline void Scheduler::cancel_actor_timeout(Actor *actor) {
 }
 
 inline void Scheduler::cancel_actor_timeout(ActorInfo *actor_info) {
+  if (use_timer_wheel_) {
+    TimerWheelNode *timer_wheel_node = actor_info->get_timer_wheel_node();
+    if (timer_wheel_node->in_timer_wheel()) {
+      timeout_wheel_.erase(timer_wheel_node);
+    }
+    return;
+  }
   HeapNode *heap_node = actor_info->get_heap_node();
   if (heap_node->in_heap()) {
     timeout_queue_.erase(heap_node);
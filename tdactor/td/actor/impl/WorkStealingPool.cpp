@@ -0,0 +1,180 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/actor/impl/WorkStealingPool.h"
+
+#include "td/actor/impl/ActorInfo.h"
+#include "td/actor/impl/Scheduler.h"
+
+#include "td/utils/logging.h"
+
+#include <utility>
+
+namespace td {
+
+WorkStealingPool::WorkStealingPool(vector<Scheduler *> workers) {
+  workers_.reserve(workers.size());
+  for (auto scheduler : workers) {
+    CHECK(scheduler != nullptr);
+    auto worker = make_unique<Worker>();
+    worker->scheduler = scheduler;
+    workers_.push_back(std::move(worker));
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  for (size_t i = 0; i < workers_.size(); i++) {
+    Task *task;
+    while ((task = pop(static_cast<int32>(i))) != nullptr) {
+      delete task;
+    }
+  }
+  for (auto task : shared_tasks_) {
+    delete task;
+  }
+}
+
+void WorkStealingPool::push(int32 sched_id, Promise<Unit> task, std::shared_ptr<ActorContext> context) {
+  auto *ptr = new Task{std::move(task), std::move(context)};
+  if (is_worker(sched_id)) {
+    workers_[sched_id]->queue.local_push(ptr, [&](Task *overflow_task) { push_shared(overflow_task); });
+  } else {
+    push_shared(ptr);
+  }
+  wakeup_idle_worker(sched_id);
+}
+
+bool WorkStealingPool::run_one(int32 sched_id) {
+  auto *task = pop(sched_id);
+  if (task == nullptr) {
+    return false;
+  }
+  run_task(task);
+  return true;
+}
+
+bool WorkStealingPool::try_set_idle(int32 sched_id) {
+  if (!is_worker(sched_id)) {
+    // non-worker schedulers aren't woken up for new tasks
+    return true;
+  }
+  auto &worker = *workers_[sched_id];
+  CHECK(!worker.is_idle.load(std::memory_order_relaxed));
+  worker.is_idle.store(true);
+  idle_worker_count_.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  // pairs with the fence in wakeup_idle_worker; either the pusher sees the worker as idle, or we see the task
+  bool has_tasks = shared_task_count_.load() != 0;
+  for (size_t i = 0; i < workers_.size() && !has_tasks; i++) {
+    has_tasks = !workers_[i]->queue.empty();
+  }
+  if (has_tasks) {
+    set_busy(sched_id);
+    return false;
+  }
+  return true;
+}
+
+void WorkStealingPool::set_busy(int32 sched_id) {
+  if (!is_worker(sched_id)) {
+    return;
+  }
+  if (workers_[sched_id]->is_idle.exchange(false)) {
+    idle_worker_count_.fetch_sub(1);
+  }
+}
+
+void WorkStealingPool::clear() {
+  bool has_run = true;
+  while (has_run) {
+    has_run = false;
+    for (size_t i = 0; i < workers_.size(); i++) {
+      while (run_one(static_cast<int32>(i))) {
+        has_run = true;
+      }
+    }
+    while (run_one(-1)) {
+      has_run = true;
+    }
+  }
+}
+
+void WorkStealingPool::push_shared(Task *task) {
+  std::lock_guard<std::mutex> guard(shared_tasks_mutex_);
+  shared_tasks_.push_back(task);
+  shared_task_count_.store(shared_tasks_.size());
+}
+
+WorkStealingPool::Task *WorkStealingPool::pop_shared() {
+  if (shared_task_count_.load(std::memory_order_relaxed) == 0) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> guard(shared_tasks_mutex_);
+  if (shared_tasks_.empty()) {
+    return nullptr;
+  }
+  auto *task = shared_tasks_.back();
+  shared_tasks_.pop_back();
+  shared_task_count_.store(shared_tasks_.size());
+  return task;
+}
+
+WorkStealingPool::Task *WorkStealingPool::pop(int32 sched_id) {
+  Task *task = nullptr;
+  if (is_worker(sched_id) && workers_[sched_id]->queue.local_pop(task)) {
+    return task;
+  }
+
+  task = pop_shared();
+  if (task != nullptr || !is_worker(sched_id)) {
+    return task;
+  }
+
+  auto worker_count = workers_.size();
+  auto &queue = workers_[sched_id]->queue;
+  for (size_t i = 1; i < worker_count; i++) {
+    auto &other = workers_[(static_cast<size_t>(sched_id) + i) % worker_count]->queue;
+    if (!other.empty() && queue.steal(task, other)) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void WorkStealingPool::wakeup_idle_worker(int32 sched_id) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (idle_worker_count_.load() == 0) {
+    return;
+  }
+  for (size_t i = 0; i < workers_.size(); i++) {
+    auto &worker = *workers_[i];
+    if (static_cast<int32>(i) != sched_id && worker.is_idle.load() && worker.is_idle.exchange(false)) {
+      idle_worker_count_.fetch_sub(1);
+      worker.scheduler->wakeup();
+      return;
+    }
+  }
+}
+
+void WorkStealingPool::run_task(Task *task) {
+  unique_ptr<Task> task_ptr(task);
+  auto *context_ptr = &Scheduler::context();
+  ActorContext *save_context = *context_ptr;
+  if (task->context != nullptr && task->context.get() != save_context) {
+    *context_ptr = task->context.get();
+    Scheduler::on_context_updated();
+  }
+
+  task->promise.set_value(Unit());
+
+  if (*context_ptr != save_context) {
+    *context_ptr = save_context;
+    Scheduler::on_context_updated();
+  }
+}
+
+}  // namespace td
@@ -0,0 +1,84 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Promise.h"
+#include "td/utils/StealingQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace td {
+
+class ActorContext;
+class Scheduler;
+
+// Tasks, which aren't bound to any actor and can be run by any scheduler thread.
+// Every worker scheduler has its own queue, from which tasks are stolen by idle workers.
+// Tasks added from non-worker schedulers are put to a shared queue.
+class WorkStealingPool {
+ public:
+  explicit WorkStealingPool(vector<Scheduler *> workers);
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+  WorkStealingPool(WorkStealingPool &&) = delete;
+  WorkStealingPool &operator=(WorkStealingPool &&) = delete;
+  ~WorkStealingPool();
+
+  // must be called from the thread of the scheduler sched_id
+  void push(int32 sched_id, Promise<Unit> task, std::shared_ptr<ActorContext> context);
+
+  // runs one task from own queue, the shared queue or a queue of another worker
+  // must be called from the thread of the scheduler sched_id
+  bool run_one(int32 sched_id);
+
+  // returns true if there are no tasks available to the scheduler, and it can fall asleep
+  bool try_set_idle(int32 sched_id);
+  void set_busy(int32 sched_id);
+
+  // runs all remaining tasks; must be called after all worker threads are stopped
+  void clear();
+
+  size_t get_worker_count() const {
+    return workers_.size();
+  }
+
+ private:
+  struct Task {
+    Promise<Unit> promise;
+    std::shared_ptr<ActorContext> context;
+  };
+
+  struct Worker {
+    Scheduler *scheduler = nullptr;
+    std::atomic<bool> is_idle{false};
+    StealingQueue<Task *> queue;
+  };
+
+  vector<unique_ptr<Worker>> workers_;
+  std::atomic<int32> idle_worker_count_{0};
+
+  std::mutex shared_tasks_mutex_;
+  vector<Task *> shared_tasks_;
+  std::atomic<size_t> shared_task_count_{0};
+
+  bool is_worker(int32 sched_id) const {
+    return 0 <= sched_id && static_cast<size_t>(sched_id) < workers_.size();
+  }
+
+  void push_shared(Task *task);
+  Task *pop_shared();
+  Task *pop(int32 sched_id);
+
+  void wakeup_idle_worker(int32 sched_id);
+
+  static void run_task(Task *task);
+};
+
+}  // namespace td
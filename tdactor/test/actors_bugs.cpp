@@ -110,3 +110,59 @@ TEST(MultiTimeout, Destroy) {
   }
   sched.finish();
 }
+
+class TimeoutChain final : public td::Actor {
+ public:
+  void start_up() final {
+    multi_timeout_.set_callback(on_multi_timeout_callback);
+    multi_timeout_.set_callback_data(static_cast<void *>(this));
+    for (int i = 0; i < 1000; i++) {
+      multi_timeout_.set_timeout_in(i, td::Random::fast(1, 20) / 1000.0);
+    }
+    for (int i = 0; i < 1000; i += 2) {
+      multi_timeout_.cancel_timeout(i);
+    }
+    set_timeout_in(1000.0);
+    cancel_timeout();
+    set_timeout_in(0.001);
+  }
+
+  void timeout_expired() final {
+    if (++timeout_count_ < 10) {
+      set_timeout_in(0.001);
+    } else {
+      try_finish();
+    }
+  }
+
+ private:
+  td::MultiTimeout multi_timeout_{"TimeoutChainMultiTimeout"};
+  int timeout_count_ = 0;
+  int expired_key_count_ = 0;
+
+  static void on_multi_timeout_callback(void *timeout_chain_ptr, td::int64 key) {
+    CHECK(key % 2 == 1);
+    auto timeout_chain = static_cast<TimeoutChain *>(timeout_chain_ptr);
+    timeout_chain->expired_key_count_++;
+    timeout_chain->try_finish();
+  }
+
+  void try_finish() {
+    if (timeout_count_ == 10 && expired_key_count_ == 500) {
+      td::Scheduler::instance()->finish();
+      stop();
+    }
+  }
+};
+
+TEST(MultiTimeout, TimerWheelScheduler) {
+  td::ConcurrentScheduler sched(0, 0);
+  sched.set_use_timer_wheel(true);
+
+  sched.create_actor_unsafe<TimeoutChain>(0, "TimeoutChain").release();
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+}
@@ -5,6 +5,7 @@
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
 #include "td/actor/actor.h"
+#include "td/actor/ActorProfiler.h"
 #include "td/actor/ConcurrentScheduler.h"
 #include "td/actor/MultiPromise.h"
 #include "td/actor/PromiseFuture.h"
@@ -12,10 +13,12 @@
 
 #include "td/utils/common.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
 #include "td/utils/MpscPollableQueue.h"
 #include "td/utils/Observer.h"
 #include "td/utils/port/FileFd.h"
 #include "td/utils/port/path.h"
+#include "td/utils/port/sleep.h"
 #include "td/utils/port/thread.h"
 #include "td/utils/Promise.h"
 #include "td/utils/Slice.h"
@@ -680,3 +683,116 @@ TEST(Actors, MultiPromiseSendClosureLater) {
   }
   scheduler.finish();
 }
+
+class ProfiledActor final : public td::Actor {
+ public:
+  void start_up() final {
+    td::send_closure_later(actor_id(this), &ProfiledActor::ping, 10);
+  }
+
+  void ping(int left) {
+    if (left == 0) {
+      td::Scheduler::instance()->finish();
+      return stop();
+    }
+    td::send_closure_later(actor_id(this), &ProfiledActor::ping, left - 1);
+  }
+};
+
+TEST(Actors, profiler) {
+  td::ActorProfiler::get_profile(true);
+  td::ActorProfiler::set_sampling_period(1);
+  td::ConcurrentScheduler scheduler(0, 0);
+  scheduler.create_actor_unsafe<ProfiledActor>(0, "ProfiledActor").release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+
+  auto profile = td::ActorProfiler::get_profile(true);
+  td::ActorProfiler::set_sampling_period(0);
+  ASSERT_EQ(1, profile.sampling_period);
+  size_t profiled_actor_count = 0;
+  for (auto &actor : profile.actors) {
+    if (actor.name == "ProfiledActor") {
+      profiled_actor_count++;
+      // start_up, 11 calls of ping and tear_down
+      ASSERT_EQ(13, actor.event_count);
+      ASSERT_TRUE(actor.mailbox_wait_time > 0.0);
+    }
+  }
+  ASSERT_EQ(1u, profiled_actor_count);
+  size_t profiled_event_count = 0;
+  for (auto &event : profile.events) {
+    ASSERT_TRUE(event.max_run_time <= event.run_time);
+    if (event.actor_name != "ProfiledActor") {
+      continue;
+    }
+    profiled_event_count++;
+    if (td::begins_with(event.event_name, "closure at ")) {
+      ASSERT_EQ(11, event.event_count);
+    } else {
+      ASSERT_EQ(1, event.event_count);
+    }
+  }
+  ASSERT_EQ(3u, profiled_event_count);
+  ASSERT_TRUE(td::ActorProfiler::get_profile(false).actors.empty());
+}
+
+class ProfiledCallee final : public td::Actor {
+ public:
+  void work(bool *is_done) {
+    td::usleep_for(50000);
+    *is_done = true;
+  }
+};
+
+class ProfiledCaller final : public td::Actor {
+ public:
+  explicit ProfiledCaller(td::ActorId<ProfiledCallee> callee) : callee_(std::move(callee)) {
+  }
+
+  void start_up() final {
+    td::send_closure_later(actor_id(this), &ProfiledCaller::call);
+  }
+
+  void call() {
+    bool is_done = false;
+    td::send_closure(callee_, &ProfiledCallee::work, &is_done);
+    CHECK(is_done);  // the closure must be run immediately
+    td::send_closure(callee_, &ProfiledCallee::work, &is_done);
+    td::Scheduler::instance()->finish();
+    stop();
+  }
+
+ private:
+  td::ActorId<ProfiledCallee> callee_;
+};
+
+TEST(Actors, profiler_self_time) {
+  td::ActorProfiler::get_profile(true);
+  td::ActorProfiler::set_sampling_period(1);
+  td::ConcurrentScheduler scheduler(0, 0);
+  auto callee = scheduler.create_actor_unsafe<ProfiledCallee>(0, "ProfiledCallee").release();
+  scheduler.create_actor_unsafe<ProfiledCaller>(0, "ProfiledCaller", callee).release();
+  scheduler.start();
+  while (scheduler.run_main(10)) {
+  }
+  scheduler.finish();
+
+  auto profile = td::ActorProfiler::get_profile(true);
+  td::ActorProfiler::set_sampling_period(0);
+  double caller_run_time = -1.0;
+  double callee_run_time = -1.0;
+  for (auto &actor : profile.actors) {
+    if (actor.name == "ProfiledCaller") {
+      caller_run_time = actor.run_time;
+    } else if (actor.name == "ProfiledCallee") {
+      callee_run_time = actor.run_time;
+    }
+  }
+  // work is run immediately from call, but is accounted only to the callee
+  ASSERT_TRUE(callee_run_time >= 0.05 * 2);
+  ASSERT_TRUE(caller_run_time >= 0.0);
+  ASSERT_TRUE(caller_run_time < 0.02);
+}
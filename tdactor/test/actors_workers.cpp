@@ -8,10 +8,15 @@
 #include "td/actor/ConcurrentScheduler.h"
 
 #include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/Promise.h"
+#include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/tests.h"
 #include "td/utils/Time.h"
 
+#include <memory>
+
 class PowerWorker final : public td::Actor {
  public:
   class Callback {
@@ -186,3 +191,54 @@ TEST(Actors, send_closure_while_finish) {
   }
   sched.finish();
 }
+
+class StealableTasksActor final : public td::Actor {
+ public:
+  explicit StealableTasksActor(int tasks_n) : left_tasks_(tasks_n) {
+  }
+
+  void on_task_result(td::uint32 x, td::uint32 res) {
+    CHECK(res == x * x);
+    if (--left_tasks_ == 0) {
+      td::Scheduler::instance()->finish();
+      stop();
+    }
+  }
+
+ private:
+  int left_tasks_;
+
+  void start_up() final {
+    set_context(std::make_shared<td::ActorContext>());
+    set_tag("StealableTasks");
+    for (int i = 0; i < left_tasks_; i++) {
+      td::Scheduler::instance()->run_stealable(td::PromiseCreator::lambda(
+          [actor_id = actor_id(this), x = static_cast<td::uint32>(i)](td::Unit) {
+            CHECK(td::Slice(LOG_TAG) == "StealableTasks");
+            send_closure(actor_id, &StealableTasksActor::on_task_result, x, x * x);
+          }));
+    }
+  }
+};
+
+static void test_stealable_tasks(int threads_n, bool enable_work_stealing) {
+  td::ConcurrentScheduler sched(threads_n, 0, enable_work_stealing);
+  sched.create_actor_unsafe<StealableTasksActor>(0, "StealableTasksActor", 100000).release();
+  sched.start();
+  while (sched.run_main(10)) {
+    // empty
+  }
+  sched.finish();
+}
+
+TEST(Actors, stealable_tasks_disabled) {
+  test_stealable_tasks(2, false);
+}
+
+TEST(Actors, stealable_tasks_one_thread) {
+  test_stealable_tasks(0, true);
+}
+
+TEST(Actors, stealable_tasks_three_threads) {
+  test_stealable_tasks(3, true);
+}
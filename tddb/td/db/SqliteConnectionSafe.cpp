@@ -12,17 +12,19 @@
 
 namespace td {
 
-SqliteConnectionSafe::SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version)
+SqliteConnectionSafe::SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version,
+                                           SqliteOptions options)
     : path_(std::move(path))
+    , options_(options)
     , lsls_connection_([path = path_, close_state_ptr = &close_state_, key = std::move(key),
-                        cipher_version = std::move(cipher_version)] {
+                        cipher_version = std::move(cipher_version), options] {
       auto r_db = SqliteDb::open_with_key(path, false, key, cipher_version.copy());
       if (r_db.is_error()) {
         LOG(FATAL) << "Can't open database in state " << close_state_ptr->load() << ": " << r_db.error().message();
       }
       auto db = r_db.move_as_ok();
       db.exec("PRAGMA journal_mode=WAL").ensure();
-      db.exec("PRAGMA secure_delete=1").ensure();
+      db.set_options(options).ensure();
       return db;
     }) {
 }
@@ -21,7 +21,8 @@ namespace td {
 class SqliteConnectionSafe {
  public:
   SqliteConnectionSafe() = default;
-  SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version = {});
+  SqliteConnectionSafe(string path, DbKey key, optional<int32> cipher_version = {},
+                       SqliteOptions options = SqliteOptions());
 
   SqliteDb &get();
   void set(SqliteDb &&db);
@@ -30,8 +31,13 @@ class SqliteConnectionSafe {
 
   void close_and_destroy();
 
+  const SqliteOptions &get_options() const {
+    return options_;
+  }
+
  private:
   string path_;
+  SqliteOptions options_;
   std::atomic<uint32> close_state_{0};
   LazySchedulerLocalStorage<SqliteDb> lsls_connection_;
 };
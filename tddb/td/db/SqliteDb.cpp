@@ -168,6 +168,39 @@ Result<string> SqliteDb::get_pragma_string(Slice name) {
   return std::move(res);
 }
 
+SqliteOptions SqliteOptions::server() {
+  SqliteOptions options;
+  options.secure_delete = false;
+  options.cache_size_kb = 64 << 10;
+  options.mmap_size = static_cast<int64>(1) << 30;
+  options.use_memory_temp_store = true;
+  options.wal_autocheckpoint = 0;
+  options.wal_checkpoint_period = 1.0;
+  return options;
+}
+
+Status SqliteDb::set_options(const SqliteOptions &options) {
+  TRY_STATUS(exec(PSLICE() << "PRAGMA secure_delete=" << (options.secure_delete ? 1 : 0)));
+  if (options.cache_size_kb > 0) {
+    // negative value means size in kibibytes instead of the number of pages
+    TRY_STATUS(exec(PSLICE() << "PRAGMA cache_size=" << -static_cast<int64>(options.cache_size_kb)));
+  }
+  if (options.mmap_size > 0) {
+    TRY_STATUS(exec(PSLICE() << "PRAGMA mmap_size=" << options.mmap_size));
+  }
+  if (options.use_memory_temp_store) {
+    TRY_STATUS(exec("PRAGMA temp_store=MEMORY"));
+  }
+  if (options.wal_autocheckpoint >= 0) {
+    TRY_STATUS(exec(PSLICE() << "PRAGMA wal_autocheckpoint=" << options.wal_autocheckpoint));
+  }
+  return Status::OK();
+}
+
+Status SqliteDb::checkpoint() {
+  return exec("PRAGMA wal_checkpoint(PASSIVE)");
+}
+
 Result<int32> SqliteDb::user_version() {
   TRY_RESULT(get_version_stmt, get_statement("PRAGMA user_version"));
   TRY_STATUS(get_version_stmt.step());
@@ -22,6 +22,19 @@ struct tdsqlite3;
 
 namespace td {
 
+// connection settings, which must be applied to every opened connection to a database
+struct SqliteOptions {
+  bool secure_delete = true;
+  int32 cache_size_kb = 0;           // 0 - use SQLite default page cache size
+  int64 mmap_size = 0;               // 0 - don't use memory-mapped I/O; ignored by SQLCipher for encrypted databases
+  bool use_memory_temp_store = false;
+  int32 wal_autocheckpoint = -1;     // in pages; -1 - use SQLite default; 0 - disable automatic WAL checkpoints
+  double wal_checkpoint_period = 0;  // period of background WAL checkpoints if automatic checkpoints are disabled
+
+  // options for servers with plenty of RAM
+  static SqliteOptions server();
+};
+
 class SqliteDb {
  public:
   SqliteDb() = default;
@@ -52,6 +65,11 @@ class SqliteDb {
   Status begin_write_transaction() TD_WARN_UNUSED_RESULT;
   Status commit_transaction() TD_WARN_UNUSED_RESULT;
 
+  Status set_options(const SqliteOptions &options) TD_WARN_UNUSED_RESULT;
+
+  // copies pages from the write-ahead log to the database without waiting for readers and writers
+  Status checkpoint() TD_WARN_UNUSED_RESULT;
+
   Result<int32> user_version();
   Status set_user_version(int32 version) TD_WARN_UNUSED_RESULT;
   void trace(bool flag);
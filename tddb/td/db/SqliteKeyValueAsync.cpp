@@ -7,13 +7,17 @@
 #include "td/db/SqliteKeyValueAsync.h"
 
 #include "td/db/SqliteKeyValue.h"
+#include "td/db/SqliteTransactionBatcher.h"
 
 #include "td/actor/actor.h"
 
 #include "td/utils/common.h"
 #include "td/utils/optional.h"
+#include "td/utils/Slice.h"
 #include "td/utils/Time.h"
 
+#include <utility>
+
 namespace td {
 
 class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
@@ -36,6 +40,9 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
   void get(string key, Promise<string> promise) final {
     send_closure_later(impl_, &Impl::get, std::move(key), std::move(promise));
   }
+  void get_by_prefix(string key_prefix, Promise<vector<std::pair<string, string>>> promise) final {
+    send_closure_later(impl_, &Impl::get_by_prefix, std::move(key_prefix), std::move(promise));
+  }
   void close(Promise<Unit> promise) final {
     send_closure_later(impl_, &Impl::close, std::move(promise));
   }
@@ -57,12 +64,11 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
       if (promise) {
         buffer_promises_.push_back(std::move(promise));
       }
-      cnt_++;
-      do_flush(false /*force*/);
+      on_write_added();
     }
 
     void set_all(FlatHashMap<string, string> key_values, Promise<Unit> promise) {
-      do_flush(true /*force*/);
+      do_flush();
       kv_->set_all(key_values);
       promise.set_value(Unit());
     }
@@ -78,12 +84,11 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
       if (promise) {
         buffer_promises_.push_back(std::move(promise));
       }
-      cnt_++;
-      do_flush(false /*force*/);
+      on_write_added();
     }
 
     void erase_by_prefix(string key_prefix, Promise<Unit> promise) {
-      do_flush(true /*force*/);
+      do_flush();
       kv_->erase_by_prefix(key_prefix);
       promise.set_value(Unit());
     }
@@ -96,8 +101,18 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
       promise.set_value(kv_->get(key));
     }
 
+    void get_by_prefix(const string &key_prefix, Promise<vector<std::pair<string, string>>> promise) {
+      do_flush();
+      vector<std::pair<string, string>> result;
+      kv_->get_by_prefix(key_prefix, [&result](Slice key, Slice value) {
+        result.emplace_back(key.str(), value.str());
+        return true;
+      });
+      promise.set_value(std::move(result));
+    }
+
     void close(Promise<Unit> promise) {
-      do_flush(true /*force*/);
+      do_flush();
       kv_safe_.reset();
       kv_ = nullptr;
       stop();
@@ -108,32 +123,23 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
     std::shared_ptr<SqliteKeyValueSafe> kv_safe_;
     SqliteKeyValue *kv_ = nullptr;
 
-    static constexpr double MAX_PENDING_QUERIES_DELAY = 0.01;
-    static constexpr size_t MAX_PENDING_QUERIES_COUNT = 100;
     FlatHashMap<string, optional<string>> buffer_;
     vector<Promise<Unit>> buffer_promises_;
-    size_t cnt_ = 0;
+    SqliteTransactionBatcher write_batcher_{"SqliteKeyValue"};
 
-    double wakeup_at_ = 0;
-    void do_flush(bool force) {
-      if (buffer_.empty()) {
-        return;
+    void on_write_added() {
+      if (write_batcher_.on_query_added()) {
+        do_flush();
+      } else {
+        set_timeout_at(write_batcher_.get_commit_time());
       }
+    }
 
-      if (!force) {
-        auto now = Time::now_cached();
-        if (wakeup_at_ == 0) {
-          wakeup_at_ = now + MAX_PENDING_QUERIES_DELAY;
-        }
-        if (now < wakeup_at_ && cnt_ < MAX_PENDING_QUERIES_COUNT) {
-          set_timeout_at(wakeup_at_);
-          return;
-        }
+    void do_flush() {
+      if (buffer_.empty()) {
+        return;
       }
 
-      wakeup_at_ = 0;
-      cnt_ = 0;
-
       kv_->begin_write_transaction().ensure();
       for (auto &it : buffer_) {
         if (it.second) {
@@ -142,13 +148,16 @@ class SqliteKeyValueAsync final : public SqliteKeyValueAsyncInterface {
           kv_->erase(it.first);
         }
       }
+      auto commit_start_time = Time::now();
       kv_->commit_transaction().ensure();
+      write_batcher_.on_committed(Time::now() - commit_start_time);
       buffer_.clear();
       set_promises(buffer_promises_);
+      cancel_timeout();
     }
 
     void timeout_expired() final {
-      do_flush(false /*force*/);
+      do_flush();
     }
 
     void start_up() final {
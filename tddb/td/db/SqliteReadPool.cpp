@@ -0,0 +1,77 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/db/SqliteReadPool.h"
+
+#include "td/actor/MultiPromise.h"
+
+#include "td/utils/logging.h"
+
+namespace td {
+
+class SqliteReadPool::Reader final : public Actor {
+ public:
+  explicit Reader(std::shared_ptr<std::atomic<int32>> pending_query_count)
+      : pending_query_count_(std::move(pending_query_count)) {
+  }
+
+  void run(Promise<Unit> query) {
+    query.set_value(Unit());
+    pending_query_count_->fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void close(Promise<Unit> promise) {
+    promise.set_value(Unit());
+    stop();
+  }
+
+ private:
+  std::shared_ptr<std::atomic<int32>> pending_query_count_;
+};
+
+SqliteReadPool::SqliteReadPool() = default;
+
+SqliteReadPool::SqliteReadPool(const vector<int32> &scheduler_ids) {
+  for (auto scheduler_id : scheduler_ids) {
+    ReaderInfo reader;
+    reader.pending_query_count = std::make_shared<std::atomic<int32>>(0);
+    reader.actor = create_actor_on_scheduler<Reader>("SqliteReader", scheduler_id, reader.pending_query_count);
+    readers_.push_back(std::move(reader));
+  }
+}
+
+SqliteReadPool::SqliteReadPool(SqliteReadPool &&other) noexcept = default;
+SqliteReadPool &SqliteReadPool::operator=(SqliteReadPool &&other) noexcept = default;
+SqliteReadPool::~SqliteReadPool() = default;
+
+void SqliteReadPool::run(Promise<Unit> query) {
+  CHECK(!readers_.empty());
+  ReaderInfo *best_reader = nullptr;
+  int32 min_pending_query_count = 0;
+  for (auto &reader : readers_) {
+    auto pending_query_count = reader.pending_query_count->load(std::memory_order_relaxed);
+    if (best_reader == nullptr || pending_query_count < min_pending_query_count) {
+      best_reader = &reader;
+      min_pending_query_count = pending_query_count;
+    }
+  }
+  best_reader->pending_query_count->fetch_add(1, std::memory_order_relaxed);
+  send_closure(best_reader->actor, &Reader::run, std::move(query));
+}
+
+void SqliteReadPool::close(Promise<Unit> promise) {
+  MultiPromiseActorSafe mpas{"SqliteReadPoolCloseMultiPromiseActor"};
+  mpas.add_promise(std::move(promise));
+  auto lock = mpas.get_promise();
+  for (auto &reader : readers_) {
+    send_closure(reader.actor, &Reader::close, mpas.get_promise());
+    reader.actor.release();
+  }
+  readers_.clear();
+  lock.set_value(Unit());
+}
+
+}  // namespace td
@@ -0,0 +1,52 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/actor/actor.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Promise.h"
+
+#include <atomic>
+#include <memory>
+
+namespace td {
+
+// Runs read-only database queries on several schedulers in parallel.
+// SqliteConnectionSafe opens a separate connection on every scheduler, and the database is in WAL mode,
+// so the queries don't block each other and a single writer.
+class SqliteReadPool {
+ public:
+  SqliteReadPool();
+  explicit SqliteReadPool(const vector<int32> &scheduler_ids);
+  SqliteReadPool(const SqliteReadPool &) = delete;
+  SqliteReadPool &operator=(const SqliteReadPool &) = delete;
+  SqliteReadPool(SqliteReadPool &&other) noexcept;
+  SqliteReadPool &operator=(SqliteReadPool &&other) noexcept;
+  ~SqliteReadPool();
+
+  bool empty() const {
+    return readers_.empty();
+  }
+
+  // runs the query on the least loaded scheduler; the query is dropped if the pool is closed
+  void run(Promise<Unit> query);
+
+  // the promise is set after all already added queries are finished
+  void close(Promise<Unit> promise);
+
+ private:
+  class Reader;
+
+  struct ReaderInfo {
+    ActorOwn<Reader> actor;
+    std::shared_ptr<std::atomic<int32>> pending_query_count;
+  };
+  vector<ReaderInfo> readers_;
+};
+
+}  // namespace td
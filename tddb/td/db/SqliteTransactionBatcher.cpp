@@ -0,0 +1,120 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/db/SqliteTransactionBatcher.h"
+
+#include "td/utils/misc.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/Time.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace td {
+
+struct SqliteTransactionBatcher::Stats {
+  static constexpr size_t HISTOGRAM_SIZE = 24;
+
+  std::atomic<uint64> transaction_count{0};
+  std::atomic<uint64> query_count{0};
+  std::atomic<uint64> batch_size_histogram[HISTOGRAM_SIZE];   // batches with [2^i, 2^(i+1)) queries
+  std::atomic<uint64> commit_time_histogram[HISTOGRAM_SIZE];  // commits which took [2^i, 2^(i+1)) microseconds
+  std::atomic<uint64> latency_histogram[HISTOGRAM_SIZE];      // batches committed [2^i, 2^(i+1)) microseconds
+                                                              // after the first query was added
+
+  Stats() {
+    for (size_t i = 0; i < HISTOGRAM_SIZE; i++) {
+      batch_size_histogram[i] = 0;
+      commit_time_histogram[i] = 0;
+      latency_histogram[i] = 0;
+    }
+  }
+
+  static void add_to_histogram(std::atomic<uint64> *histogram, uint64 value) {
+    size_t bucket = 0;
+    while (value > 1 && bucket + 1 < HISTOGRAM_SIZE) {
+      value >>= 1;
+      bucket++;
+    }
+    histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void print_histogram(StringBuilder &sb, Slice name, const std::atomic<uint64> *histogram) {
+    sb << name << ":";
+    for (size_t i = 0; i < HISTOGRAM_SIZE; i++) {
+      auto count = histogram[i].load(std::memory_order_relaxed);
+      if (count != 0) {
+        sb << ' ' << (static_cast<uint64>(1) << i) << ':' << count;
+      }
+    }
+    sb << '\n';
+  }
+};
+
+static std::mutex sqlite_transaction_batcher_stats_mutex;
+static std::map<string, unique_ptr<SqliteTransactionBatcher::Stats>> sqlite_transaction_batcher_stats;
+
+SqliteTransactionBatcher::SqliteTransactionBatcher(Slice name) {
+  std::lock_guard<std::mutex> lock(sqlite_transaction_batcher_stats_mutex);
+  auto &stats = sqlite_transaction_batcher_stats[name.str()];
+  if (stats == nullptr) {
+    stats = make_unique<Stats>();
+  }
+  stats_ = stats.get();
+}
+
+bool SqliteTransactionBatcher::on_query_added() {
+  if (query_count_ == 0) {
+    batch_start_time_ = Time::now();
+    commit_at_ = batch_start_time_ + clamp(2 * average_commit_duration_, MIN_DELAY, MAX_DELAY);
+  }
+  query_count_++;
+  return query_count_ >= max_batch_size_;
+}
+
+void SqliteTransactionBatcher::on_committed(double commit_duration) {
+  if (query_count_ == 0) {
+    return;
+  }
+
+  stats_->transaction_count.fetch_add(1, std::memory_order_relaxed);
+  stats_->query_count.fetch_add(query_count_, std::memory_order_relaxed);
+  Stats::add_to_histogram(stats_->batch_size_histogram, query_count_);
+  Stats::add_to_histogram(stats_->commit_time_histogram, static_cast<uint64>(commit_duration * 1e6));
+  Stats::add_to_histogram(stats_->latency_histogram, static_cast<uint64>((Time::now() - batch_start_time_) * 1e6));
+
+  if (average_commit_duration_ == 0) {
+    average_commit_duration_ = commit_duration;
+  } else {
+    average_commit_duration_ = 0.9 * average_commit_duration_ + 0.1 * commit_duration;
+  }
+
+  if (query_count_ >= max_batch_size_) {
+    // queries are added faster than they are committed
+    max_batch_size_ = min(2 * max_batch_size_, MAX_MAX_BATCH_SIZE);
+  } else if (query_count_ * 4 < max_batch_size_) {
+    max_batch_size_ = max(max_batch_size_ / 2, MIN_MAX_BATCH_SIZE);
+  }
+  query_count_ = 0;
+  commit_at_ = 0;
+}
+
+string get_sqlite_transaction_batcher_stats() {
+  auto sb = StringBuilder({}, true);
+  std::lock_guard<std::mutex> lock(sqlite_transaction_batcher_stats_mutex);
+  for (auto &it : sqlite_transaction_batcher_stats) {
+    auto &stats = *it.second;
+    sb << it.first << " transactions: " << stats.transaction_count.load(std::memory_order_relaxed)
+       << ", queries: " << stats.query_count.load(std::memory_order_relaxed) << '\n';
+    SqliteTransactionBatcher::Stats::print_histogram(sb, "batch size", stats.batch_size_histogram);
+    SqliteTransactionBatcher::Stats::print_histogram(sb, "commit time, us", stats.commit_time_histogram);
+    SqliteTransactionBatcher::Stats::print_histogram(sb, "batch latency, us", stats.latency_histogram);
+  }
+  return sb.as_cslice().str();
+}
+
+}  // namespace td
@@ -0,0 +1,52 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/Slice.h"
+
+namespace td {
+
+// Decides when write queries, buffered by an asynchronous database wrapper, need to be committed in one transaction.
+// A batch waits for about the time of a commit, so at most a half of the time is spent on commit overhead,
+// and maximum batch size grows while batches are filled faster than they are committed.
+class SqliteTransactionBatcher {
+ public:
+  // batchers with the same name share statistics
+  explicit SqliteTransactionBatcher(Slice name);
+
+  // must be called after a query is added to the current batch; returns true if the batch must be committed now
+  bool on_query_added();
+
+  // returns time at which the current batch must be committed
+  double get_commit_time() const {
+    return commit_at_;
+  }
+
+  // must be called after the current batch is committed
+  void on_committed(double commit_duration);
+
+  struct Stats;
+
+ private:
+  static constexpr size_t MIN_MAX_BATCH_SIZE = 50;
+  static constexpr size_t MAX_MAX_BATCH_SIZE = 5000;
+  static constexpr double MIN_DELAY = 0.0005;
+  static constexpr double MAX_DELAY = 0.01;
+
+  Stats *stats_ = nullptr;
+  size_t query_count_ = 0;
+  size_t max_batch_size_ = MIN_MAX_BATCH_SIZE;
+  double batch_start_time_ = 0;
+  double commit_at_ = 0;
+  double average_commit_duration_ = 0;
+};
+
+// returns text representation of batch size and latency histograms of all batchers
+string get_sqlite_transaction_batcher_stats();
+
+}  // namespace td
@@ -0,0 +1,70 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/db/SqliteWalCheckpointer.h"
+
+#include "td/db/SqliteDb.h"
+
+#include "td/actor/actor.h"
+
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
+#include "td/utils/Time.h"
+
+namespace td {
+
+class SqliteWalCheckpointer final : public SqliteWalCheckpointerInterface {
+ public:
+  SqliteWalCheckpointer(std::shared_ptr<SqliteConnectionSafe> connection, int32 scheduler_id) {
+    impl_ = create_actor_on_scheduler<Impl>("SqliteWalCheckpointer", scheduler_id, std::move(connection));
+  }
+
+  void close(Promise<Unit> promise) final {
+    send_closure_later(impl_, &Impl::close, std::move(promise));
+  }
+
+ private:
+  class Impl final : public Actor {
+   public:
+    explicit Impl(std::shared_ptr<SqliteConnectionSafe> connection) : connection_(std::move(connection)) {
+    }
+
+    void close(Promise<Unit> promise) {
+      connection_.reset();
+      stop();
+      promise.set_value(Unit());
+    }
+
+   private:
+    std::shared_ptr<SqliteConnectionSafe> connection_;
+    double period_ = 0;
+
+    void start_up() final {
+      period_ = connection_->get_options().wal_checkpoint_period;
+      CHECK(period_ > 0);
+      set_timeout_in(period_);
+    }
+
+    void timeout_expired() final {
+      auto start_time = Time::now();
+      auto status = connection_->get().checkpoint();
+      if (status.is_error()) {
+        LOG(ERROR) << "Failed to checkpoint database: " << status;
+      }
+      auto passed_time = Time::now() - start_time;
+      LOG_IF(WARNING, passed_time > 0.1) << "Database checkpoint took " << passed_time << " seconds";
+      set_timeout_in(period_);
+    }
+  };
+  ActorOwn<Impl> impl_;
+};
+
+unique_ptr<SqliteWalCheckpointerInterface> create_sqlite_wal_checkpointer(
+    std::shared_ptr<SqliteConnectionSafe> connection, int32 scheduler_id) {
+  return td::make_unique<SqliteWalCheckpointer>(std::move(connection), scheduler_id);
+}
+
+}  // namespace td
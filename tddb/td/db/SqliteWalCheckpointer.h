@@ -0,0 +1,30 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/db/SqliteConnectionSafe.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Promise.h"
+
+#include <memory>
+
+namespace td {
+
+// periodically checkpoints the write-ahead log of a database, which has automatic checkpoints disabled
+class SqliteWalCheckpointerInterface {
+ public:
+  virtual ~SqliteWalCheckpointerInterface() = default;
+
+  virtual void close(Promise<Unit> promise) = 0;
+};
+
+// the checkpoints are done with period SqliteOptions::wal_checkpoint_period of the connection
+unique_ptr<SqliteWalCheckpointerInterface> create_sqlite_wal_checkpointer(
+    std::shared_ptr<SqliteConnectionSafe> connection, int32 scheduler_id = -1);
+
+}  // namespace td
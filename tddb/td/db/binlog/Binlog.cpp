@@ -18,6 +18,7 @@
 #include "td/utils/port/PollFlags.h"
 #include "td/utils/port/sleep.h"
 #include "td/utils/port/Stat.h"
+#include "td/utils/port/thread.h"
 #include "td/utils/Random.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/SliceBuilder.h"
@@ -26,6 +27,10 @@
 #include "td/utils/tl_helpers.h"
 #include "td/utils/tl_parsers.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 namespace td {
 namespace detail {
 struct AesCtrEncryptionEvent {
@@ -109,7 +114,8 @@ class BinlogReader {
   int64 offset() const {
     return offset_;
   }
-  Result<size_t> read_next(BinlogEvent *event) {
+  // cuts next raw event from the input without validating it
+  Result<size_t> read_next(string &raw_event) {
     if (state_ == State::ReadLength) {
       if (input_->size() < 4) {
         return 4;
@@ -138,12 +144,9 @@ class BinlogReader {
       return size_;
     }
 
-    event->debug_info_ = BinlogDebugInfo{__FILE__, __LINE__};
     auto buffer_slice = input_->cut_head(size_).move_as_buffer_slice();
-    event->init(buffer_slice.as_slice().str());
-    TRY_STATUS(event->validate());
+    raw_event = buffer_slice.as_slice().str();
     offset_ += size_;
-    event->offset_ = offset_;
     state_ = State::ReadLength;
     return 0;
   }
@@ -158,6 +161,187 @@ class BinlogReader {
   bool is_encrypted_{false};
 };
 
+// consecutive events read from the binlog, which are validated together
+struct BinlogLoadBatch {
+  static constexpr size_t MAX_SIZE = 1 << 20;
+
+  vector<string> raw_events;
+  vector<int64> offsets;
+  vector<BinlogEvent> events;
+  vector<Status> statuses;
+  size_t size = 0;
+
+  Status error;  // error, which occurred while reading the event following the batch
+  int64 error_offset = 0;
+  bool is_last = false;
+  bool has_encryption_event = false;  // the next events must be decrypted with a new key
+
+  std::atomic<size_t> next_event_index{0};
+  std::atomic<size_t> validated_event_count{0};
+  int32 worker_count = 0;  // protected by the mutex of BinlogEventsValidator
+
+  void clear() {
+    raw_events.clear();
+    offsets.clear();
+    events.clear();
+    statuses.clear();
+    size = 0;
+    error = Status::OK();
+    error_offset = 0;
+    is_last = false;
+    has_encryption_event = false;
+    next_event_index = 0;
+    validated_event_count = 0;
+    CHECK(worker_count == 0);
+  }
+
+  void add_event(string raw_event, int64 offset) {
+    CHECK(raw_event.size() >= BinlogEvent::MIN_SIZE);
+    auto type = TlParser(Slice(raw_event).substr(4 + 8, 4)).fetch_int();
+    if (type == BinlogEvent::ServiceTypes::AesCtrEncryption) {
+      has_encryption_event = true;
+    }
+    size += raw_event.size();
+    raw_events.push_back(std::move(raw_event));
+    offsets.push_back(offset);
+  }
+
+  bool is_full() const {
+    return size >= MAX_SIZE || has_encryption_event || error.is_error() || is_last;
+  }
+
+  // the next batch can be read before the events from this batch are applied
+  bool can_read_next() const {
+    return !has_encryption_event && error.is_ok() && !is_last;
+  }
+
+  bool validate_next_events() {
+    static constexpr size_t CHUNK_SIZE = 16;
+    auto event_count = raw_events.size();
+    auto begin = next_event_index.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+    if (begin >= event_count) {
+      return false;
+    }
+    auto end = min(begin + CHUNK_SIZE, event_count);
+    for (auto i = begin; i < end; i++) {
+      auto &event = events[i];
+      event.debug_info_ = BinlogDebugInfo{__FILE__, __LINE__};
+      event.init(std::move(raw_events[i]));
+      event.offset_ = offsets[i];
+      statuses[i] = event.validate();
+    }
+    validated_event_count.fetch_add(end - begin, std::memory_order_acq_rel);
+    return true;
+  }
+
+  bool is_validated() const {
+    return validated_event_count.load(std::memory_order_acquire) == raw_events.size();
+  }
+};
+
+// checks CRC and parses headers of loaded events in parallel with reading and applying of other events
+class BinlogEventsValidator {
+ public:
+  explicit BinlogEventsValidator(int32 thread_count) {
+#if !TD_THREAD_UNSUPPORTED
+    thread_count_ = thread_count;
+    for (int32 i = 0; i < thread_count; i++) {
+      threads_.push_back(td::thread([this] { run_worker(); }));
+    }
+#endif
+  }
+  BinlogEventsValidator(const BinlogEventsValidator &) = delete;
+  BinlogEventsValidator &operator=(const BinlogEventsValidator &) = delete;
+  BinlogEventsValidator(BinlogEventsValidator &&) = delete;
+  BinlogEventsValidator &operator=(BinlogEventsValidator &&) = delete;
+  ~BinlogEventsValidator() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      is_closed_ = true;
+    }
+    new_batch_cv_.notify_all();
+#if !TD_THREAD_UNSUPPORTED
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+#endif
+  }
+
+  void start(BinlogLoadBatch *batch) {
+    auto event_count = batch->raw_events.size();
+    batch->events.resize(event_count);
+    batch->statuses.resize(event_count);
+    if (thread_count_ == 0) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      batch_ = batch;
+      generation_++;
+    }
+    new_batch_cv_.notify_all();
+  }
+
+  void wait(BinlogLoadBatch *batch) {
+    while (batch->validate_next_events()) {
+    }
+    if (thread_count_ == 0) {
+      CHECK(batch->is_validated());
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (batch_ == batch) {
+      batch_ = nullptr;  // no new workers can take the batch
+    }
+    batch_done_cv_.wait(lock, [&] { return batch->worker_count == 0; });
+    CHECK(batch->is_validated());
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable new_batch_cv_;
+  std::condition_variable batch_done_cv_;
+  BinlogLoadBatch *batch_ = nullptr;
+  uint64 generation_ = 0;
+  bool is_closed_ = false;
+  int32 thread_count_ = 0;
+#if !TD_THREAD_UNSUPPORTED
+  vector<td::thread> threads_;
+#endif
+
+  void run_worker() {
+    uint64 last_generation = 0;
+    while (true) {
+      BinlogLoadBatch *batch = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        new_batch_cv_.wait(lock, [&] { return is_closed_ || generation_ != last_generation; });
+        if (is_closed_) {
+          return;
+        }
+        last_generation = generation_;
+        batch = batch_;
+        if (batch == nullptr) {
+          continue;
+        }
+        batch->worker_count++;
+      }
+
+      while (batch->validate_next_events()) {
+      }
+
+      bool is_last_worker = false;
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        is_last_worker = --batch->worker_count == 0;
+      }
+      if (is_last_worker) {
+        batch_done_cv_.notify_all();
+      }
+    }
+  }
+};
+
 static int64 file_size(CSlice path) {
   auto r_stat = stat(path);
   if (r_stat.is_error()) {
@@ -165,6 +349,51 @@ static int64 file_size(CSlice path) {
   }
   return r_stat.ok().size_;
 }
+
+// writer of the new binlog file during an incremental reindex
+struct BinlogReindexer {
+  BufferedFdBase<FileFd> fd;
+  ChainBufferWriter buffer_writer;
+  ChainBufferReader buffer_reader;
+  bool is_encrypted = false;
+  AesCtrState aes_ctr_state;
+
+  // all live events with identifiers not bigger than last_copied_event_id are already written to the new file
+  uint64 last_copied_event_id = 0;
+  int64 copied_size = 0;
+  int64 total_size = 0;
+
+  int64 fd_size = 0;
+  uint64 fd_events = 0;
+
+  double start_time = 0;
+  int64 start_size = 0;
+  uint64 start_events = 0;
+  int32 step_count = 0;
+
+  explicit BinlogReindexer(FileFd file_fd) : fd(std::move(file_fd)) {
+    buffer_reader = buffer_writer.extract_reader();
+    fd.set_output_reader(&buffer_reader);
+  }
+
+  void write(Slice raw_event) {
+    if (is_encrypted) {
+      BufferSlice encrypted_event(raw_event.size());
+      aes_ctr_state.encrypt(raw_event, encrypted_event.as_mutable_slice());
+      buffer_writer.append(std::move(encrypted_event));
+    } else {
+      buffer_writer.append(raw_event);
+    }
+    fd_size += static_cast<int64>(raw_event.size());
+    fd_events++;
+  }
+
+  void flush() {
+    auto r_written = fd.flush_write();
+    r_written.ensure();
+    LOG_IF(FATAL, fd.need_flush_write()) << "Failed to flush new binlog";
+  }
+};
 }  // namespace detail
 
 int32 VERBOSITY_NAME(binlog) = VERBOSITY_NAME(DEBUG) + 8;
@@ -230,6 +459,8 @@ void Binlog::add_event(BinlogEvent &&event) {
   if (event.size_ % 4 != 0) {
     LOG(FATAL) << "Trying to add event with bad size " << event.public_to_string();
   }
+  stats_.event_count++;
+  auto event_size = event.size_;
 
   if (!events_buffer_) {
     do_add_event(std::move(event));
@@ -239,6 +470,12 @@ void Binlog::add_event(BinlogEvent &&event) {
   lazy_flush();
 
   if (state_ == State::Run) {
+    if (reindexer_ != nullptr) {
+      // copy several times more data than was added to ensure that the reindex finishes
+      reindex_step(static_cast<int64>(event_size) * 8 + 4096);
+      return;
+    }
+
     auto fd_size = fd_size_;
     if (events_buffer_) {
       fd_size += events_buffer_->size();
@@ -249,7 +486,7 @@ void Binlog::add_event(BinlogEvent &&event) {
     if (need_reindex(50000, 5) || need_reindex(100000, 4) || need_reindex(300000, 3) || need_reindex(500000, 2)) {
       LOG(INFO) << tag("fd_size", format::as_size(fd_size))
                 << tag("total events size", format::as_size(processor_->total_raw_events_size()));
-      do_reindex();
+      start_incremental_reindex();
     }
   }
 }
@@ -285,6 +522,7 @@ Status Binlog::close(bool need_sync) {
   if (fd_.empty()) {
     return Status::OK();
   }
+  cancel_incremental_reindex();
   if (need_sync) {
     sync("close");
   } else {
@@ -335,6 +573,11 @@ void Binlog::do_event(BinlogEvent &&event) {
     VLOG(binlog) << "Write binlog event: " << format::cond(state_ == State::Reindex, "[reindex] ")
                  << event.public_to_string();
     buffer_writer_.append(as_slice(event.raw_event_));
+
+    if (reindexer_ != nullptr && event.id_ <= reindexer_->last_copied_event_id) {
+      // the event changes an already copied event
+      reindexer_->write(as_slice(event.raw_event_));
+    }
   }
 
   if (event.type_ < 0) {
@@ -408,9 +651,11 @@ void Binlog::sync(const char *source) {
   flush(source);
   if (need_sync_) {
     LOG(INFO) << "Sync binlog from " << source;
-    auto status = fd_.sync();
+    // the binlog is append-only, so it is enough to sync the data and the file size
+    auto status = fd_.sync_data();
     LOG_IF(FATAL, status.is_error()) << "Failed to sync binlog: " << status;
     need_sync_ = false;
+    stats_.sync_count++;
   }
 }
 
@@ -514,13 +759,85 @@ Status Binlog::load_binlog(const Callback &callback, const Callback &debug_callb
 
   fd_.get_poll_info().add_flags(PollFlags::Read());
   info_.wrong_password = false;
+
+  // events are read and decrypted by the current thread, validated by the current thread and additional threads,
+  // and applied in order by the current thread; the next batch of events is read while the current one is validated
+  int32 thread_count = 0;
+#if !TD_THREAD_UNSUPPORTED
+  TRY_RESULT(binlog_size, fd_.get_size());
+  if (binlog_size >= static_cast<int64>(PARALLEL_LOAD_MIN_SIZE)) {
+    auto hardware_concurrency = static_cast<int32>(td::thread::hardware_concurrency());
+    thread_count = clamp(hardware_concurrency - 1, 0, MAX_LOAD_THREAD_COUNT);
+  }
+#endif
+
+  auto read_batch = [&](detail::BinlogLoadBatch &batch) -> Status {
+    batch.clear();
+    while (!batch.is_full()) {
+      string raw_event;
+      auto r_need_size = reader.read_next(raw_event);
+      if (r_need_size.is_error()) {
+        batch.error = r_need_size.move_as_error();
+        batch.error_offset = reader.offset();
+        break;
+      }
+      auto need_size = r_need_size.move_as_ok();
+      if (need_size == 0) {
+        batch.add_event(std::move(raw_event), reader.offset());
+        continue;
+      }
+
+      TRY_STATUS(fd_.flush_read(max(need_size, READ_BLOCK_SIZE)));
+      buffer_reader_.sync_with_writer();
+      if (byte_flow_flag_) {
+        byte_flow_source_.wakeup();
+      }
+      if (reader.input()->size() < need_size) {
+        batch.is_last = true;
+      }
+    }
+    return Status::OK();
+  };
+
+  // the batches must be destroyed after the validator, which can still use them
+  detail::BinlogLoadBatch batches[2];
+  detail::BinlogEventsValidator validator(thread_count);
+  auto *batch = &batches[0];
+  auto *next_batch = &batches[1];
+  TRY_STATUS(read_batch(*batch));
   while (true) {
-    BinlogEvent event;
-    auto r_need_size = reader.read_next(&event);
-    if (r_need_size.is_error()) {
-      if (r_need_size.error().code() == -2) {
+    validator.start(batch);
+    bool is_next_batch_read = false;
+    if (batch->can_read_next()) {
+      TRY_STATUS(read_batch(*next_batch));
+      is_next_batch_read = true;
+    }
+    validator.wait(batch);
+
+    bool has_invalid_event = false;
+    for (size_t i = 0; i < batch->events.size(); i++) {
+      if (batch->statuses[i].is_error()) {
+        LOG(ERROR) << batch->statuses[i];
+        has_invalid_event = true;
+        break;
+      }
+      auto &event = batch->events[i];
+      if (debug_callback) {
+        debug_callback(event);
+      }
+      do_add_event(std::move(event));
+      if (info_.wrong_password) {
+        return Status::OK();
+      }
+    }
+    if (has_invalid_event) {
+      break;
+    }
+
+    if (batch->error.is_error()) {
+      if (batch->error.code() == -2) {
         auto old_size = detail::file_size(path_);
-        auto offset = reader.offset();
+        auto offset = batch->error_offset;
         auto data = debug_get_binlog_data(offset, old_size);
         fd_.seek(offset).ensure();
         fd_.truncate_to_current_position(offset).ensure();
@@ -528,31 +845,19 @@ Status Binlog::load_binlog(const Callback &callback, const Callback &debug_callb
           break;
         }
         LOG(FATAL) << "Truncate binlog \"" << path_ << "\" from size " << old_size << " to size " << offset
-                   << " due to error: " << r_need_size.error() << " after reading " << data;
+                   << " due to error: " << batch->error << " after reading " << data;
       }
-      LOG(ERROR) << r_need_size.error();
+      LOG(ERROR) << batch->error;
       break;
     }
-    auto need_size = r_need_size.move_as_ok();
-    // LOG(ERROR) << "Need size = " << need_size;
-    if (need_size == 0) {
-      if (debug_callback) {
-        debug_callback(event);
-      }
-      do_add_event(std::move(event));
-      if (info_.wrong_password) {
-        return Status::OK();
-      }
-    } else {
-      TRY_STATUS(fd_.flush_read(max(need_size, static_cast<size_t>(4096))));
-      buffer_reader_.sync_with_writer();
-      if (byte_flow_flag_) {
-        byte_flow_source_.wakeup();
-      }
-      if (reader.input()->size() < need_size) {
-        break;
-      }
+    if (batch->is_last) {
+      break;
     }
+
+    if (!is_next_batch_read) {
+      TRY_STATUS(read_batch(*next_batch));
+    }
+    std::swap(batch, next_batch);
   }
 
   auto offset = processor_->offset();
@@ -627,6 +932,7 @@ void Binlog::reset_encryption() {
 }
 
 void Binlog::do_reindex() {
+  cancel_incremental_reindex();
   flush_events_buffer(true);
   // start reindex
   CHECK(state_ == State::Run);
@@ -681,6 +987,8 @@ void Binlog::do_reindex() {
   auto finish_time = Clocks::monotonic();
   auto finish_size = fd_size_;
   auto finish_events = fd_events_;
+  stats_.reindex_count++;
+  stats_.max_reindex_step_time = max(stats_.max_reindex_step_time, finish_time - start_time);
   for (int left_tries = 10; left_tries > 0; left_tries--) {
     auto r_stat = stat(path_);
     if (r_stat.is_error()) {
@@ -718,6 +1026,135 @@ void Binlog::do_reindex() {
   update_write_encryption();
 }
 
+void Binlog::start_incremental_reindex() {
+  CHECK(state_ == State::Run);
+  CHECK(reindexer_ == nullptr);
+  flush_events_buffer(true);
+
+  string new_path = path_ + ".new";
+  auto r_opened_file = open_binlog(new_path, FileFd::Flags::Write | FileFd::Flags::Create | FileFd::Truncate);
+  if (r_opened_file.is_error()) {
+    LOG(ERROR) << "Can't open new binlog for regenerate: " << r_opened_file.error();
+    return;
+  }
+  auto reindexer = make_unique<detail::BinlogReindexer>(r_opened_file.move_as_ok());
+  reindexer->start_time = Clocks::monotonic();
+  reindexer->start_size = fd_size_;
+  reindexer->start_events = fd_events_;
+  reindexer->total_size = processor_->total_raw_events_size();
+
+  if (encryption_type_ == EncryptionType::AesCtr) {
+    // the key doesn't change, so reuse the key salt and choose a new IV
+    using EncryptionEvent = detail::AesCtrEncryptionEvent;
+    EncryptionEvent event;
+    event.key_salt_ = aes_ctr_key_salt_;
+    event.iv_.resize(EncryptionEvent::iv_size());
+    Random::secure_bytes(event.iv_);
+    event.key_hash_ = EncryptionEvent::generate_hash(as_slice(aes_ctr_key_));
+    reindexer->write(as_slice(
+        BinlogEvent::create_raw(0, BinlogEvent::ServiceTypes::AesCtrEncryption, 0, create_default_storer(event))));
+
+    UInt128 aes_ctr_iv;
+    as_mutable_slice(aes_ctr_iv).copy_from(event.iv_);
+    reindexer->aes_ctr_state.init(as_slice(aes_ctr_key_), as_slice(aes_ctr_iv));
+    reindexer->is_encrypted = true;
+  }
+
+  LOG(INFO) << "Start incremental reindex of " << tag("name", path_) << tag("size", format::as_size(fd_size_))
+            << tag("events_size", format::as_size(reindexer->total_size));
+  reindexer_ = std::move(reindexer);
+}
+
+void Binlog::reindex_step(int64 max_size) {
+  if (reindexer_ == nullptr) {
+    return;
+  }
+  CHECK(state_ == State::Run);
+
+  auto start_time = Clocks::monotonic();
+  auto &reindexer = *reindexer_;
+  reindexer.step_count++;
+  bool is_finished = processor_->for_each_after(reindexer.last_copied_event_id, max_size, [&](BinlogEvent &event) {
+    reindexer.write(as_slice(event.raw_event_));
+    reindexer.copied_size += static_cast<int64>(event.raw_event_.size());
+  });
+  reindexer.flush();
+  if (is_finished) {
+    finish_incremental_reindex();
+  }
+
+  stats_.max_reindex_step_time = max(stats_.max_reindex_step_time, Clocks::monotonic() - start_time);
+}
+
+void Binlog::finish_incremental_reindex() {
+  CHECK(reindexer_ != nullptr);
+  auto reindexer = std::move(reindexer_);
+
+  // all events are already written to the old file, so it just needs to be flushed before it is replaced
+  flush("finish_incremental_reindex");
+  reindexer->flush();
+  auto status = reindexer->fd.sync_barrier();
+  LOG_IF(FATAL, status.is_error()) << "Failed to sync binlog: " << status;
+
+  string new_path = path_ + ".new";
+  auto old_fd = std::move(fd_);  // can't close fd_ now, because it will release file lock
+  status = unlink(path_);
+  LOG_IF(FATAL, status.is_error()) << "Failed to unlink old binlog: " << status;
+  old_fd.close();  // now we can close old file and release the system lock
+  status = rename(new_path, path_);
+  FileFd::remove_local_lock(new_path);  // now we can release local lock for temporary file
+  LOG_IF(FATAL, status.is_error()) << "Failed to rename binlog: " << status;
+
+  fd_ = std::move(reindexer->fd);
+  fd_size_ = reindexer->fd_size;
+  fd_events_ = reindexer->fd_events;
+  need_sync_ = false;
+
+  buffer_writer_ = ChainBufferWriter();
+  buffer_reader_ = buffer_writer_.extract_reader();
+  if (reindexer->is_encrypted) {
+    encryption_type_ = EncryptionType::AesCtr;
+    aes_ctr_state_ = std::move(reindexer->aes_ctr_state);
+  } else {
+    encryption_type_ = EncryptionType::None;
+  }
+  update_write_encryption();
+  stats_.reindex_count++;
+
+  auto finish_time = Clocks::monotonic();
+  auto ratio = static_cast<double>(reindexer->start_size) / static_cast<double>(fd_size_ + 1);
+  LOG(INFO) << "Incrementally regenerate index " << tag("name", path_)
+            << tag("time", format::as_time(finish_time - reindexer->start_time))
+            << tag("steps", reindexer->step_count)
+            << tag("max_step_time", format::as_time(stats_.max_reindex_step_time))
+            << tag("before_size", format::as_size(reindexer->start_size))
+            << tag("after_size", format::as_size(fd_size_)) << tag("ratio", ratio)
+            << tag("before_events", reindexer->start_events) << tag("after_events", fd_events_);
+}
+
+void Binlog::cancel_incremental_reindex() {
+  if (reindexer_ == nullptr) {
+    return;
+  }
+
+  // the old file contains all events, so the new file can be just deleted
+  string new_path = path_ + ".new";
+  reindexer_->fd.lock(FileFd::LockFlags::Unlock, new_path, 1).ignore();
+  reindexer_->fd.close();
+  reindexer_ = nullptr;
+  unlink(new_path).ignore();
+  LOG(INFO) << "Cancel incremental reindex of " << tag("name", path_);
+}
+
+BinlogStats Binlog::get_stats() const {
+  auto stats = stats_;
+  if (reindexer_ != nullptr) {
+    stats.reindex_copied_size = reindexer_->copied_size;
+    stats.reindex_total_size = reindexer_->total_size;
+  }
+  return stats;
+}
+
 string Binlog::debug_get_binlog_data(int64 begin_offset, int64 end_offset) {
   if (begin_offset > end_offset) {
     return "Begin offset is bigger than end_offset";
@@ -37,10 +37,20 @@ struct BinlogInfo {
   bool is_opened{false};
 };
 
+struct BinlogStats {
+  uint64 event_count{0};
+  uint64 sync_count{0};
+  uint64 reindex_count{0};
+  double max_reindex_step_time{0};  // maximum time for which a reindex has blocked the binlog
+  int64 reindex_copied_size{0};     // size of events already copied by the current incremental reindex
+  int64 reindex_total_size{0};      // total size of events to be copied by the current incremental reindex
+};
+
 namespace detail {
 class BinlogReader;
 class BinlogEventsProcessor;
 class BinlogEventsBuffer;
+struct BinlogReindexer;
 }  // namespace detail
 
 class Binlog {
@@ -130,6 +140,18 @@ class Binlog {
     return info_;
   }
 
+  BinlogStats get_stats() const;
+
+  // Binlog is regenerated incrementally when it contains too many outdated events. Live events are copied
+  // to a new file in chunks by reindex_step, while new events are still appended to the old file.
+  static constexpr int64 REINDEX_STEP_SIZE = 1 << 20;
+
+  bool is_reindexing() const {
+    return reindexer_ != nullptr;
+  }
+
+  void reindex_step(int64 max_size = REINDEX_STEP_SIZE);
+
  private:
   BufferedFdBase<FileFd> fd_;
   ChainBufferWriter buffer_writer_;
@@ -137,6 +159,7 @@ class Binlog {
   detail::BinlogReader *binlog_reader_ptr_ = nullptr;
 
   BinlogInfo info_;
+  BinlogStats stats_;
   DbKey db_key_;
   bool db_key_used_ = false;
   DbKey old_db_key_;
@@ -158,6 +181,7 @@ class Binlog {
   vector<BinlogEvent> pending_events_;
   unique_ptr<detail::BinlogEventsProcessor> processor_;
   unique_ptr<detail::BinlogEventsBuffer> events_buffer_;
+  unique_ptr<detail::BinlogReindexer> reindexer_;
   bool in_flush_events_buffer_{false};
   uint64 last_event_id_{0};
   double need_flush_since_ = 0;
@@ -169,9 +193,17 @@ class Binlog {
   size_t flush_events_buffer(bool force);
   void do_add_event(BinlogEvent &&event);
   void do_event(BinlogEvent &&event);
+
+  static constexpr size_t READ_BLOCK_SIZE = 1 << 20;
+  static constexpr size_t PARALLEL_LOAD_MIN_SIZE = 1 << 22;  // smaller binlogs are validated by the current thread
+  static constexpr int32 MAX_LOAD_THREAD_COUNT = 3;
   Status load_binlog(const Callback &callback, const Callback &debug_callback = Callback()) TD_WARN_UNUSED_RESULT;
   void do_reindex();
 
+  void start_incremental_reindex();
+  void finish_incremental_reindex();
+  void cancel_incremental_reindex();
+
   void update_encryption(Slice key, Slice iv);
   void reset_encryption();
   void update_read_encryption();
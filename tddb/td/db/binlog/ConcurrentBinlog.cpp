@@ -59,6 +59,9 @@ class BinlogActor final : public Actor {
     });
     flush_immediate_sync();
     try_flush();
+    if (binlog_->is_reindexing()) {
+      yield();
+    }
   }
 
   void force_sync(Promise<> &&promise, const char *source) {
@@ -82,6 +85,15 @@ class BinlogActor final : public Actor {
     promise.set_value(Unit());
   }
 
+  void enable_group_commit(double min_sync_interval) {
+    CHECK(min_sync_interval >= 0);
+    min_sync_interval_ = min_sync_interval;
+  }
+
+  void get_stats(Promise<BinlogStats> promise) {
+    promise.set_value(binlog_->get_stats());
+  }
+
  private:
   unique_ptr<Binlog> binlog_;
 
@@ -93,8 +105,11 @@ class BinlogActor final : public Actor {
   bool lazy_sync_flag_ = false;
   bool flush_flag_ = false;
   double wakeup_at_ = 0;
+  double min_sync_interval_ = -1.0;  // negative if group commit is disabled
+  double last_sync_at_ = 0;
 
   static constexpr double FLUSH_TIMEOUT = 0.001;  // 1ms
+  static constexpr double FORCE_SYNC_DELAY = 0.003;  // 3ms
 
   void wakeup_after(double after) {
     auto now = Time::now_cached();
@@ -139,7 +154,12 @@ class BinlogActor final : public Actor {
     }
     if (!force_sync_flag_) {
       force_sync_flag_ = true;
-      wakeup_after(0.003);
+      if (min_sync_interval_ >= 0) {
+        // sync after all already received events are processed
+        wakeup_at(max(Time::now_cached(), last_sync_at_ + min_sync_interval_));
+      } else {
+        wakeup_after(FORCE_SYNC_DELAY);
+      }
     }
   }
 
@@ -154,6 +174,16 @@ class BinlogActor final : public Actor {
     }
   }
 
+  void loop() final {
+    if (binlog_->is_reindexing()) {
+      // copy the next chunk of events after all already received events are processed
+      binlog_->reindex_step();
+      if (binlog_->is_reindexing()) {
+        yield();
+      }
+    }
+  }
+
   void timeout_expired() final {
     bool need_sync = lazy_sync_flag_ || force_sync_flag_;
     lazy_sync_flag_ = false;
@@ -163,6 +193,7 @@ class BinlogActor final : public Actor {
     wakeup_at_ = 0;
     if (need_sync) {
       binlog_->sync("timeout_expired");
+      last_sync_at_ = Time::now();
       // LOG(ERROR) << "BINLOG SYNC";
       set_promises(sync_promises_);
     } else if (need_flush) {
@@ -218,6 +249,14 @@ void ConcurrentBinlog::change_key(DbKey db_key, Promise<> promise) {
   send_closure(binlog_actor_, &detail::BinlogActor::change_key, std::move(db_key), std::move(promise));
 }
 
+void ConcurrentBinlog::enable_group_commit(double min_sync_interval) {
+  send_closure(binlog_actor_, &detail::BinlogActor::enable_group_commit, min_sync_interval);
+}
+
+void ConcurrentBinlog::get_stats(Promise<BinlogStats> promise) {
+  send_closure(binlog_actor_, &detail::BinlogActor::get_stats, std::move(promise));
+}
+
 uint64 ConcurrentBinlog::erase_batch(vector<uint64> event_ids) {
   auto shift = narrow_cast<int32>(event_ids.size());
   if (shift == 0) {
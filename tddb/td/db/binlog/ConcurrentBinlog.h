@@ -45,6 +45,14 @@ class ConcurrentBinlog final : public BinlogInterface {
   void force_flush() final;
   void change_key(DbKey db_key, Promise<> promise) final;
 
+  // By default, force_sync requests are accumulated for 3 ms before the binlog is synced.
+  // In group commit mode, the binlog is synced as soon as possible after a force_sync request. Requests received
+  // while a sync is in progress are committed together by the next sync, which happens no earlier than
+  // min_sync_interval seconds after the previous sync.
+  void enable_group_commit(double min_sync_interval);
+
+  void get_stats(Promise<BinlogStats> promise);
+
   uint64 next_event_id() final {
     return last_event_id_.fetch_add(1, std::memory_order_relaxed);
   }
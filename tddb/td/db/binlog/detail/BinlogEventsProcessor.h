@@ -12,6 +12,8 @@
 #include "td/utils/logging.h"
 #include "td/utils/Status.h"
 
+#include <algorithm>
+
 namespace td {
 namespace detail {
 
@@ -33,6 +35,27 @@ class BinlogEventsProcessor {
     }
   }
 
+  // calls callback for events with identifiers bigger than event_id until total size of the processed events exceeds
+  // max_size; updates event_id to the identifier of the last checked event
+  // returns true if there are no more events to process
+  template <class CallbackT>
+  bool for_each_after(uint64 &event_id, int64 max_size, CallbackT &&callback) {
+    auto it = std::upper_bound(event_ids_.begin(), event_ids_.end(), event_id * 2 + 1);
+    int64 processed_size = 0;
+    for (; it != event_ids_.end(); ++it) {
+      if (processed_size >= max_size) {
+        return false;
+      }
+      event_id = *it / 2;
+      if ((*it & 1) == 0) {
+        auto &event = events_[it - event_ids_.begin()];
+        processed_size += static_cast<int64>(event.raw_event_.size());
+        callback(event);
+      }
+    }
+    return true;
+  }
+
   uint64 last_event_id() const {
     return last_event_id_;
   }
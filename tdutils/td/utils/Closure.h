@@ -76,6 +76,10 @@ class ImmediateClosure {
   auto run(ActorT *actor) -> decltype(mem_call_tuple(actor, std::move(args))) {
     return mem_call_tuple(actor, std::move(args));
   }
+
+  const FunctionT &get_function() const {
+    return std::get<0>(args);
+  }
 };
 
 template <class ActorT, class ResultT, class... DestArgsT, class... SrcArgsT>
@@ -108,6 +112,10 @@ class DelayedClosure {
   auto run(ActorT *actor) -> decltype(mem_call_tuple(actor, std::move(args))) {
     return mem_call_tuple(actor, std::move(args));
   }
+
+  const FunctionT &get_function() const {
+    return std::get<0>(args);
+  }
 };
 
 template <class ActorT, class ResultT, class... DestArgsT, class... SrcArgsT>
@@ -0,0 +1,257 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/CompactHints.h"
+
+#include "td/utils/algorithm.h"
+#include "td/utils/Hints.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/translit.h"
+#include "td/utils/utf8.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace td {
+
+static constexpr size_t MIN_MERGED_ENTRY_COUNT = 64;
+
+void CompactHints::WordIndex::add_word(Slice word, uint32 id) {
+  CHECK(pool_.size() + word.size() <= std::numeric_limits<uint32>::max());
+  new_entries_.push_back(WordEntry{static_cast<uint32>(pool_.size()), static_cast<uint32>(word.size()), id});
+  pool_.append(word.begin(), word.size());
+}
+
+void CompactHints::WordIndex::add_search_results(vector<uint32> &results, Slice word) const {
+  LOG(DEBUG) << "Search for word " << word;
+  auto it = std::lower_bound(sorted_entries_.begin(), sorted_entries_.end(), word,
+                             [this](const WordEntry &entry, Slice word) { return get_word(entry) < word; });
+  while (it != sorted_entries_.end() && begins_with(get_word(*it), word)) {
+    results.push_back(it->id);
+    ++it;
+  }
+  for (auto &entry : new_entries_) {
+    if (begins_with(get_word(entry), word)) {
+      results.push_back(entry.id);
+    }
+  }
+}
+
+void CompactHints::WordIndex::merge(const vector<KeyInfo> &infos) {
+  auto is_outdated = [&infos](const WordEntry &entry) {
+    return !infos[entry.id].is_actual;
+  };
+  auto compare = [this](const WordEntry &lhs, const WordEntry &rhs) {
+    auto lhs_word = get_word(lhs);
+    auto rhs_word = get_word(rhs);
+    return lhs_word < rhs_word || (lhs_word == rhs_word && lhs.id < rhs.id);
+  };
+
+  td::remove_if(sorted_entries_, is_outdated);
+  td::remove_if(new_entries_, is_outdated);
+  std::sort(new_entries_.begin(), new_entries_.end(), compare);
+
+  vector<WordEntry> entries;
+  entries.reserve(sorted_entries_.size() + new_entries_.size());
+  std::merge(sorted_entries_.begin(), sorted_entries_.end(), new_entries_.begin(), new_entries_.end(),
+             std::back_inserter(entries), compare);
+
+  // equal words are adjacent, so each of them is stored in the pool only once
+  string pool;
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto &entry = entries[i];
+    auto word = get_word(entry);
+    if (i > 0 && Slice(pool.data() + entries[i - 1].word_offset, entries[i - 1].word_length) == word) {
+      entry.word_offset = entries[i - 1].word_offset;
+      continue;
+    }
+    entry.word_offset = static_cast<uint32>(pool.size());
+    pool.append(word.begin(), word.size());
+  }
+  pool.shrink_to_fit();
+  entries.shrink_to_fit();
+
+  pool_ = std::move(pool);
+  sorted_entries_ = std::move(entries);
+  new_entries_ = vector<WordEntry>();
+}
+
+uint32 CompactHints::create_id(KeyT key, RatingT rating) {
+  uint32 id;
+  if (free_ids_.empty()) {
+    CHECK(infos_.size() < std::numeric_limits<uint32>::max());
+    id = static_cast<uint32>(infos_.size());
+    infos_.emplace_back();
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  }
+  auto &info = infos_[id];
+  info.key = key;
+  info.rating = rating;
+  info.is_actual = true;
+  key_to_id_[key] = id;
+  return id;
+}
+
+void CompactHints::outdate_id(uint32 id) {
+  auto &info = infos_[id];
+  CHECK(info.is_actual);
+  info.is_actual = false;
+  if (info.name.empty()) {
+    // there are no words for the identifier
+    free_ids_.push_back(id);
+  } else {
+    name_count_--;
+    string().swap(info.name);
+    outdated_ids_.push_back(id);
+  }
+}
+
+void CompactHints::merge_if_needed() {
+  auto need_merge = [](const WordIndex &index) {
+    return index.new_entries_.size() >= max(MIN_MERGED_ENTRY_COUNT, index.sorted_entries_.size() / 16);
+  };
+  if (!need_merge(words_) && !need_merge(translit_words_) &&
+      outdated_ids_.size() < max(MIN_MERGED_ENTRY_COUNT, infos_.size() / 8)) {
+    return;
+  }
+
+  words_.merge(infos_);
+  translit_words_.merge(infos_);
+  append(free_ids_, std::move(outdated_ids_));
+  outdated_ids_.clear();
+}
+
+void CompactHints::add(KeyT key, Slice name) {
+  RatingT rating = 0;
+  auto it = key_to_id_.find(key);
+  if (it != key_to_id_.end()) {
+    auto id = it->second;
+    if (!name.empty() && infos_[id].name == name) {
+      return;
+    }
+    rating = infos_[id].rating;
+    outdate_id(id);
+    key_to_id_.erase(it);
+  }
+  if (name.empty()) {
+    merge_if_needed();
+    return;
+  }
+
+  auto id = create_id(key, rating);
+  infos_[id].name = name.str();
+  name_count_++;
+
+  vector<string> transliterations;
+  for (auto &word : Hints::fix_words(utf8_get_search_words(name))) {
+    words_.add_word(word, id);
+
+    for (auto &w : get_word_transliterations(word, false)) {
+      if (w != word) {
+        transliterations.push_back(std::move(w));
+      }
+    }
+  }
+  for (auto &word : Hints::fix_words(transliterations)) {
+    translit_words_.add_word(word, id);
+  }
+
+  merge_if_needed();
+}
+
+void CompactHints::set_rating(KeyT key, RatingT rating) {
+  auto it = key_to_id_.find(key);
+  if (it == key_to_id_.end()) {
+    create_id(key, rating);
+  } else {
+    infos_[it->second].rating = rating;
+  }
+}
+
+vector<uint32> CompactHints::search_word(const string &word) const {
+  vector<uint32> results;
+  translit_words_.add_search_results(results, word);
+  for (const auto &w : get_word_transliterations(word, true)) {
+    words_.add_search_results(results, w);
+  }
+
+  td::remove_if(results, [this](uint32 id) { return !infos_[id].is_actual; });
+  td::unique(results);
+  return results;
+}
+
+std::pair<size_t, vector<CompactHints::KeyT>> CompactHints::search(Slice query, int32 limit,
+                                                                   bool return_all_for_empty_query) const {
+  vector<KeyT> keys;
+  if (limit < 0) {
+    return {name_count_, std::move(keys)};
+  }
+
+  vector<uint32> results;
+  auto words = Hints::fix_words(utf8_get_search_words(query));
+  if (return_all_for_empty_query && words.empty()) {
+    results.reserve(name_count_);
+    for (uint32 id = 0; id < infos_.size(); id++) {
+      if (infos_[id].is_actual && !infos_[id].name.empty()) {
+        results.push_back(id);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < words.size(); i++) {
+    vector<uint32> ids = search_word(words[i]);
+    if (i == 0) {
+      results = std::move(ids);
+      continue;
+    }
+
+    vector<uint32> intersection;
+    std::set_intersection(results.begin(), results.end(), ids.begin(), ids.end(), std::back_inserter(intersection));
+    results = std::move(intersection);
+  }
+
+  auto compare_by_rating = [this](uint32 lhs_id, uint32 rhs_id) {
+    const auto &lhs = infos_[lhs_id];
+    const auto &rhs = infos_[rhs_id];
+    return lhs.rating < rhs.rating || (lhs.rating == rhs.rating && lhs.key < rhs.key);
+  };
+  auto total_size = results.size();
+  if (total_size < static_cast<size_t>(limit)) {
+    std::sort(results.begin(), results.end(), compare_by_rating);
+  } else {
+    std::partial_sort(results.begin(), results.begin() + limit, results.end(), compare_by_rating);
+    results.resize(limit);
+  }
+
+  keys.reserve(results.size());
+  for (auto id : results) {
+    keys.push_back(infos_[id].key);
+  }
+  return {total_size, std::move(keys)};
+}
+
+bool CompactHints::has_key(KeyT key) const {
+  auto it = key_to_id_.find(key);
+  return it != key_to_id_.end() && !infos_[it->second].name.empty();
+}
+
+string CompactHints::key_to_string(KeyT key) const {
+  auto it = key_to_id_.find(key);
+  if (it == key_to_id_.end()) {
+    return string();
+  }
+  return infos_[it->second].name;
+}
+
+std::pair<size_t, vector<CompactHints::KeyT>> CompactHints::search_empty(int32 limit) const {
+  return search(Slice(), limit, true);
+}
+
+}  // namespace td
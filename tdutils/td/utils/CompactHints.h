@@ -0,0 +1,94 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/FlatHashMap.h"
+#include "td/utils/Slice.h"
+
+#include <utility>
+
+namespace td {
+
+// Has the same interface and returns the same results as Hints, but uses much less memory for big sets of keys.
+// Words are stored in a sorted array of fixed-size entries referencing a shared character pool. New words are added
+// to a small unsorted array, which is merged into the sorted array when it becomes too big. A key gets a new internal
+// identifier when its name is changed, so old words are just skipped until the next merge and needn't be searched for.
+class CompactHints {
+  using KeyT = int64;
+  using RatingT = int64;
+
+ public:
+  void add(KeyT key, Slice name);
+
+  void remove(KeyT key) {
+    add(key, "");
+  }
+
+  void set_rating(KeyT key, RatingT rating);
+
+  std::pair<size_t, vector<KeyT>> search(Slice query, int32 limit, bool return_all_for_empty_query = false) const;
+
+  bool has_key(KeyT key) const;
+
+  string key_to_string(KeyT key) const;
+
+  std::pair<size_t, vector<KeyT>> search_empty(int32 limit) const;  // == search("", limit, true)
+
+  size_t size() const {
+    return name_count_;
+  }
+
+ private:
+  struct KeyInfo {
+    KeyT key = 0;
+    RatingT rating = 0;
+    string name;
+    bool is_actual = false;  // false, if the key was renamed or removed
+  };
+
+  struct WordEntry {
+    uint32 word_offset;
+    uint32 word_length;
+    uint32 id;
+  };
+
+  struct WordIndex {
+    string pool_;
+    vector<WordEntry> sorted_entries_;
+    vector<WordEntry> new_entries_;
+
+    Slice get_word(const WordEntry &entry) const {
+      return Slice(pool_.data() + entry.word_offset, entry.word_length);
+    }
+
+    void add_word(Slice word, uint32 id);
+
+    void add_search_results(vector<uint32> &results, Slice word) const;
+
+    void merge(const vector<KeyInfo> &infos);
+  };
+
+  FlatHashMap<KeyT, uint32> key_to_id_;
+  vector<KeyInfo> infos_;
+  vector<uint32> free_ids_;
+  vector<uint32> outdated_ids_;  // can be reused after outdated words are deleted
+  size_t name_count_ = 0;
+
+  WordIndex words_;
+  WordIndex translit_words_;
+
+  uint32 create_id(KeyT key, RatingT rating);
+
+  void outdate_id(uint32 id);
+
+  void merge_if_needed();
+
+  vector<uint32> search_word(const string &word) const;
+};
+
+}  // namespace td
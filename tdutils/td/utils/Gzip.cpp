@@ -9,6 +9,7 @@
 char disable_linker_warning_about_empty_file_gzip_cpp TD_UNUSED;
 
 #if TD_HAVE_ZLIB
+#include "td/utils/port/thread_local.h"
 #include "td/utils/SliceBuilder.h"
 
 #include <cstring>
@@ -154,36 +155,99 @@ Gzip::~Gzip() {
   clear();
 }
 
-BufferSlice gzdecode(Slice s) {
-  Gzip gzip;
-  gzip.init_decode().ensure();
-  ChainBufferWriter message;
-  gzip.set_input(s);
-  gzip.close_input();
-  double k = 2;
-  gzip.set_output(message.prepare_append(static_cast<size_t>(static_cast<double>(s.size()) * k)));
-  while (true) {
-    auto r_state = gzip.run();
-    if (r_state.is_error()) {
-      return BufferSlice();
-    }
-    auto state = r_state.ok();
-    if (state == Gzip::State::Done) {
-      message.confirm_append(gzip.flush_output());
-      break;
+class GzipDecoder::Impl {
+ public:
+  z_stream stream_;
+  bool is_inited_ = false;
+
+  Impl() = default;
+  Impl(const Impl &) = delete;
+  Impl &operator=(const Impl &) = delete;
+  Impl(Impl &&) = delete;
+  Impl &operator=(Impl &&) = delete;
+  ~Impl() {
+    if (is_inited_) {
+      inflateEnd(&stream_);
     }
-    if (gzip.need_input()) {
+  }
+};
+
+GzipDecoder::GzipDecoder() : impl_(make_unique<Impl>()) {
+}
+
+GzipDecoder::~GzipDecoder() = default;
+
+BufferSlice GzipDecoder::decode(Slice s) {
+  if (s.size() > std::numeric_limits<uInt>::max()) {
+    return BufferSlice();
+  }
+
+  auto &stream = impl_->stream_;
+  if (!impl_->is_inited_) {
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) {
       return BufferSlice();
     }
-    if (gzip.need_output()) {
-      message.confirm_append(gzip.flush_output());
-      k *= 1.5;
-      gzip.set_output(message.prepare_append(static_cast<size_t>(static_cast<double>(gzip.left_input()) * k)));
+    impl_->is_inited_ = true;
+  } else if (inflateReset(&stream) != Z_OK) {
+    return BufferSlice();
+  }
+  stream.avail_in = static_cast<uInt>(s.size());
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(s.data()));
+
+  // the last 4 bytes of a gzip stream contain size of the uncompressed data modulo 2^32;
+  // if it looks plausible, then the whole result is decoded into one buffer without reallocations
+  size_t output_size = s.size() * 2;
+  if (s.size() >= 18) {
+    auto ubegin = s.ubegin() + s.size() - 4;
+    size_t uncompressed_size = static_cast<size_t>(ubegin[0]) | (static_cast<size_t>(ubegin[1]) << 8) |
+                               (static_cast<size_t>(ubegin[2]) << 16) | (static_cast<size_t>(ubegin[3]) << 24);
+    static constexpr size_t MAX_COMPRESSION_RATIO = 1032;  // the maximum for deflate
+    if (uncompressed_size / MAX_COMPRESSION_RATIO <= s.size() && uncompressed_size < (1u << 30)) {
+      output_size = uncompressed_size + 1;
     }
   }
+
+  auto inflate_to = [&stream](MutableSlice output) {
+    stream.avail_out = static_cast<uInt>(output.size());
+    stream.next_out = reinterpret_cast<Bytef *>(output.data());
+    auto ret = inflate(&stream, Z_NO_FLUSH);
+    if (ret == Z_OK && stream.avail_out != 0) {
+      // all input was consumed, but the stream isn't finished
+      return Z_DATA_ERROR;
+    }
+    return ret;
+  };
+
+  BufferWriter first_part(output_size);
+  auto output = first_part.prepare_append();
+  auto ret = inflate_to(output);
+  first_part.confirm_append(output.size() - stream.avail_out);
+  if (ret == Z_STREAM_END) {
+    return first_part.as_buffer_slice();
+  }
+
+  ChainBufferWriter message;
+  message.append(first_part.as_buffer_slice());
+  double k = 2;
+  while (ret == Z_OK) {
+    k *= 1.5;
+    output = message.prepare_append(static_cast<size_t>(static_cast<double>(stream.avail_in) * k));
+    ret = inflate_to(output);
+    message.confirm_append(output.size() - stream.avail_out);
+  }
+  if (ret != Z_STREAM_END) {
+    return BufferSlice();
+  }
   return message.extract_reader().move_as_buffer_slice();
 }
 
+BufferSlice gzdecode(Slice s) {
+  static TD_THREAD_LOCAL GzipDecoder *decoder;
+  init_thread_local<GzipDecoder>(decoder);
+  return decoder->decode(s);
+}
+
 BufferSlice gzencode(Slice s, double max_compression_ratio) {
   Gzip gzip;
   gzip.init_encode().ensure();
@@ -97,6 +97,25 @@ class Gzip {
   void swap(Gzip &other);
 };
 
+// decodes independent gzip streams, reusing the same inflate state for all of them
+class GzipDecoder {
+ public:
+  GzipDecoder();
+  GzipDecoder(const GzipDecoder &) = delete;
+  GzipDecoder &operator=(const GzipDecoder &) = delete;
+  GzipDecoder(GzipDecoder &&) = delete;
+  GzipDecoder &operator=(GzipDecoder &&) = delete;
+  ~GzipDecoder();
+
+  // returns an empty BufferSlice on error
+  BufferSlice decode(Slice s);
+
+ private:
+  class Impl;
+  unique_ptr<Impl> impl_;
+};
+
+// uses a thread-local GzipDecoder
 BufferSlice gzdecode(Slice s);
 
 BufferSlice gzencode(Slice s, double max_compression_ratio);
@@ -11,6 +11,8 @@
 #include "td/utils/SliceBuilder.h"
 #include "td/utils/utf8.h"
 
+#include <utility>
+
 namespace td {
 
 StringBuilder &operator<<(StringBuilder &sb, const JsonRawString &val) {
@@ -522,6 +524,136 @@ Status do_json_skip(Parser &parser, int32 max_depth) {
   return Status::Error("Can't parse");
 }
 
+JsonValue::Type JsonParser::peek_type() {
+  parser_.skip_whitespaces();
+  switch (parser_.peek_char()) {
+    case 'n':
+      return JsonValue::Type::Null;
+    case 'f':
+    case 't':
+      return JsonValue::Type::Boolean;
+    case '"':
+      return JsonValue::Type::String;
+    case '[':
+      return JsonValue::Type::Array;
+    case '{':
+      return JsonValue::Type::Object;
+    default:
+      return JsonValue::Type::Number;
+  }
+}
+
+Result<JsonValue> JsonParser::read_simple_value() {
+  auto type = peek_type();
+  if (type == JsonValue::Type::Array || type == JsonValue::Type::Object) {
+    return Status::Error(PSLICE() << "Unexpected " << type);
+  }
+  return do_json_decode(parser_, 0);
+}
+
+Status JsonParser::skip_value() {
+  return do_json_skip(parser_, max_depth_ - depth_);
+}
+
+Result<MutableSlice> JsonParser::peek_field(Slice name) {
+  parser_.skip_whitespaces();
+  Parser parser(parser_.data());
+  if (!parser.try_skip('{')) {
+    return Status::Error("'{' expected");
+  }
+  parser.skip_whitespaces();
+  if (parser.try_skip('}')) {
+    return MutableSlice();
+  }
+  while (true) {
+    auto field_begin = parser.ptr();
+    TRY_STATUS(json_string_skip(parser));
+    bool is_found = Slice(field_begin + 1, parser.ptr() - 1) == name;
+    parser.skip_whitespaces();
+    if (!parser.try_skip(':')) {
+      return Status::Error("':' expected");
+    }
+    parser.skip_whitespaces();
+    auto value_begin = parser.ptr();
+    TRY_STATUS(do_json_skip(parser, max_depth_ - depth_ - 1));
+    if (is_found) {
+      return MutableSlice(value_begin, parser.ptr());
+    }
+
+    parser.skip_whitespaces();
+    if (parser.try_skip('}')) {
+      return MutableSlice();
+    }
+    if (!parser.try_skip(',')) {
+      return Status::Error("Unexpected symbol while parsing JSON Object");
+    }
+    parser.skip_whitespaces();
+  }
+}
+
+Result<MutableSlice> JsonParser::read_first_field(Slice name) {
+  CHECK(!is_object_started_);
+  if (depth_ >= max_depth_) {
+    return Status::Error("Too big object depth");
+  }
+  parser_.skip_whitespaces();
+  Parser parser(parser_.data());
+  if (!parser.try_skip('{')) {
+    return Status::Error("'{' expected");
+  }
+  parser.skip_whitespaces();
+  if (parser.peek_char() != '"') {
+    return MutableSlice();
+  }
+  auto field_begin = parser.ptr();
+  TRY_STATUS(json_string_skip(parser));
+  if (Slice(field_begin + 1, parser.ptr() - 1) != name) {
+    return MutableSlice();
+  }
+  parser.skip_whitespaces();
+  if (!parser.try_skip(':')) {
+    return Status::Error("':' expected");
+  }
+
+  parser_ = std::move(parser);
+  depth_++;
+  parser_.skip_whitespaces();
+  auto value_begin = parser_.ptr();
+  TRY_STATUS(skip_value());
+  is_object_started_ = true;
+  return MutableSlice(value_begin, parser_.ptr());
+}
+
+Status JsonParser::enter_container(char c) {
+  if (depth_ >= max_depth_) {
+    return Status::Error("Too big object depth");
+  }
+  parser_.skip_whitespaces();
+  if (!parser_.try_skip(c)) {
+    return Status::Error(PSLICE() << '\'' << c << "' expected");
+  }
+  depth_++;
+  return Status::OK();
+}
+
+Status JsonParser::capture_field_value() {
+  parser_.skip_whitespaces();
+  auto value_begin = parser_.ptr();
+  TRY_STATUS(skip_value());
+  if (captured_field_value_.empty()) {
+    captured_field_value_ = MutableSlice(value_begin, parser_.ptr());
+  }
+  return Status::OK();
+}
+
+Status JsonParser::finish() {
+  parser_.skip_whitespaces();
+  if (!parser_.empty()) {
+    return Status::Error("Expected string end");
+  }
+  return Status::OK();
+}
+
 Slice JsonValue::get_type_name(Type type) {
   switch (type) {
     case Type::Null:
@@ -808,6 +808,136 @@ inline Result<JsonValue> json_decode(MutableSlice json) {
   return result;
 }
 
+// streaming JSON parser, which allows to convert JSON to other objects without creation of intermediate JsonValue
+// strings are decoded in place, so the parsed JSON text is changed
+class JsonParser {
+ public:
+  static constexpr int32 DEFAULT_MAX_DEPTH = 100;
+
+  explicit JsonParser(MutableSlice json, int32 max_depth = DEFAULT_MAX_DEPTH) : parser_(json), max_depth_(max_depth) {
+  }
+
+  // returns type of the next value; invalid values are reported as Number and fail to be read
+  JsonValue::Type peek_type();
+
+  // reads the next value, which must be null, boolean, number or string, without memory allocations
+  Result<JsonValue> read_simple_value() TD_WARN_UNUSED_RESULT;
+
+  Status skip_value() TD_WARN_UNUSED_RESULT;
+
+  // returns JSON text of the value of the field with the given name in the next object or an empty slice if there is
+  // no such field; the parser state and the JSON text aren't changed
+  // field names with escaped characters aren't compared with the name
+  Result<MutableSlice> peek_field(Slice name) TD_WARN_UNUSED_RESULT;
+
+  // if the next object starts with the field with the given name, then consumes the field and returns JSON text of
+  // its value; otherwise, returns an empty slice and doesn't change the parser state
+  // the rest of the object must be read by the subsequent call to read_object
+  Result<MutableSlice> read_first_field(Slice name) TD_WARN_UNUSED_RESULT;
+
+  // calls f(field_name) for each field of the next object; f must read or skip the field value and return Status
+  // f is called for every occurrence of a repeated field, so f must skip the field to use its first value
+  template <class F>
+  Status read_object(F &&f) TD_WARN_UNUSED_RESULT;
+
+  // calls f() for each element of the next array; f must read or skip the element and return Status
+  template <class F>
+  Status read_array(F &&f) TD_WARN_UNUSED_RESULT;
+
+  // the field with the given name of the outermost object will be skipped by read_object and its JSON text will be
+  // returned by get_captured_field_value; if the field is repeated, then the first value is returned
+  void set_captured_field_name(Slice name) {
+    captured_field_name_ = name;
+  }
+
+  MutableSlice get_captured_field_value() const {
+    return captured_field_value_;
+  }
+
+  // checks that there is nothing after the parsed value
+  Status finish() TD_WARN_UNUSED_RESULT;
+
+ private:
+  Parser parser_;
+  int32 max_depth_;
+  int32 depth_ = 0;
+  bool is_object_started_ = false;
+
+  Slice captured_field_name_;
+  MutableSlice captured_field_value_;
+
+  Status enter_container(char c) TD_WARN_UNUSED_RESULT;
+
+  Status capture_field_value() TD_WARN_UNUSED_RESULT;
+};
+
+template <class F>
+Status JsonParser::read_object(F &&f) {
+  bool need_separator = is_object_started_;
+  if (is_object_started_) {
+    is_object_started_ = false;
+  } else {
+    TRY_STATUS(enter_container('{'));
+  }
+  while (true) {
+    parser_.skip_whitespaces();
+    if (need_separator) {
+      if (parser_.try_skip('}')) {
+        break;
+      }
+      if (!parser_.try_skip(',')) {
+        if (parser_.empty()) {
+          return Status::Error("Unexpected string end");
+        }
+        return Status::Error("Unexpected symbol while parsing JSON Object");
+      }
+      parser_.skip_whitespaces();
+    } else if (parser_.try_skip('}')) {
+      break;
+    }
+    need_separator = true;
+
+    TRY_RESULT(field, json_string_decode(parser_));
+    parser_.skip_whitespaces();
+    if (!parser_.try_skip(':')) {
+      return Status::Error("':' expected");
+    }
+    if (depth_ == 1 && !captured_field_name_.empty() && field == captured_field_name_) {
+      TRY_STATUS(capture_field_value());
+    } else {
+      TRY_STATUS(f(Slice(field)));
+    }
+  }
+  depth_--;
+  return Status::OK();
+}
+
+template <class F>
+Status JsonParser::read_array(F &&f) {
+  TRY_STATUS(enter_container('['));
+  parser_.skip_whitespaces();
+  if (parser_.try_skip(']')) {
+    depth_--;
+    return Status::OK();
+  }
+  while (true) {
+    TRY_STATUS(f());
+
+    parser_.skip_whitespaces();
+    if (parser_.try_skip(']')) {
+      break;
+    }
+    if (!parser_.try_skip(',')) {
+      if (parser_.empty()) {
+        return Status::Error("Unexpected string end");
+      }
+      return Status::Error("Unexpected symbol while parsing JSON Array");
+    }
+  }
+  depth_--;
+  return Status::OK();
+}
+
 template <class StrT, class ValT>
 StrT json_encode(const ValT &val, bool pretty = false) {
   auto buf_len = 1 << 18;
@@ -10,6 +10,7 @@
 #include "td/utils/common.h"
 #include "td/utils/invoke.h"
 #include "td/utils/MovableValue.h"
+#include "td/utils/SmallObjectAllocator.h"
 #include "td/utils/Status.h"
 
 #include <tuple>
@@ -28,6 +29,8 @@ class PromiseInterface {
   PromiseInterface &operator=(PromiseInterface &&) = default;
   virtual ~PromiseInterface() = default;
 
+  TD_SMALL_OBJECT_ALLOCATION
+
   virtual void set_value(T &&value) {
     set_result(std::move(value));
   }
@@ -0,0 +1,125 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/SmallObjectAllocator.h"
+
+#include "td/utils/port/thread_local.h"
+
+#include <array>
+#include <new>
+
+namespace td {
+
+namespace {
+
+class SmallObjectCache {
+ public:
+  static constexpr size_t SIZE_STEP = 16;
+  static constexpr size_t SIZE_CLASS_COUNT = SmallObjectAllocator::MAX_OBJECT_SIZE / SIZE_STEP;
+
+  SmallObjectCache() = default;
+  SmallObjectCache(const SmallObjectCache &) = delete;
+  SmallObjectCache &operator=(const SmallObjectCache &) = delete;
+  SmallObjectCache(SmallObjectCache &&) = delete;
+  SmallObjectCache &operator=(SmallObjectCache &&) = delete;
+  ~SmallObjectCache() {
+    for (auto &free_list : free_lists_) {
+      while (free_list.head != nullptr) {
+        auto node = free_list.head;
+        free_list.head = node->next;
+        ::operator delete(node);
+      }
+    }
+  }
+
+  void *allocate(size_t size_class) {
+    auto &free_list = free_lists_[size_class];
+    auto node = free_list.head;
+    if (node == nullptr) {
+      return nullptr;
+    }
+    free_list.head = node->next;
+    free_list.size--;
+    reused_allocation_count_++;
+    return node;
+  }
+
+  bool deallocate(void *ptr, size_t size_class) {
+    auto &free_list = free_lists_[size_class];
+    if (free_list.size >= MAX_FREE_LIST_SIZE) {
+      return false;
+    }
+    auto node = static_cast<Node *>(ptr);
+    node->next = free_list.head;
+    free_list.head = node;
+    free_list.size++;
+    return true;
+  }
+
+  uint64 get_reused_allocation_count() const {
+    return reused_allocation_count_;
+  }
+
+ private:
+  // objects are often allocated in one thread and freed in another, so the cache size must be limited
+  static constexpr size_t MAX_FREE_LIST_SIZE = 256;
+
+  struct Node {
+    Node *next;
+  };
+  struct FreeList {
+    Node *head = nullptr;
+    size_t size = 0;
+  };
+  std::array<FreeList, SIZE_CLASS_COUNT> free_lists_;
+  uint64 reused_allocation_count_ = 0;
+};
+
+TD_THREAD_LOCAL SmallObjectCache *small_object_cache;  // static zero-initialized
+
+SmallObjectCache *get_small_object_cache() {
+  init_thread_local<SmallObjectCache>(small_object_cache);
+  return small_object_cache;
+}
+
+size_t get_size_class(size_t size) {
+  return (size - 1) / SmallObjectCache::SIZE_STEP;
+}
+
+}  // namespace
+
+void *SmallObjectAllocator::allocate(size_t size) {
+  if (size == 0 || size > MAX_OBJECT_SIZE) {
+    return ::operator new(size);
+  }
+  auto size_class = get_size_class(size);
+  auto ptr = get_small_object_cache()->allocate(size_class);
+  if (ptr != nullptr) {
+    return ptr;
+  }
+  // allocate the maximum size of the class to be able to reuse the memory for any object of the class
+  return ::operator new((size_class + 1) * SmallObjectCache::SIZE_STEP);
+}
+
+void SmallObjectAllocator::deallocate(void *ptr, size_t size) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (size == 0 || size > MAX_OBJECT_SIZE) {
+    return ::operator delete(ptr);
+  }
+  // the cache isn't created there, because objects can be freed while thread-local variables are being destroyed
+  auto cache = small_object_cache;
+  if (cache == nullptr || !cache->deallocate(ptr, get_size_class(size))) {
+    ::operator delete(ptr);
+  }
+}
+
+uint64 SmallObjectAllocator::get_reused_allocation_count() {
+  return small_object_cache == nullptr ? 0 : small_object_cache->get_reused_allocation_count();
+}
+
+}  // namespace td
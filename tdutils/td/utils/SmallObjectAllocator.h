@@ -0,0 +1,44 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+#include <cstddef>
+
+namespace td {
+
+// Allocates small objects, reusing memory of freed objects of the same size class, cached in the current thread.
+// Suitable for short-lived objects like actor events and promises, which are allocated and freed in large numbers,
+// possibly in different threads.
+class SmallObjectAllocator {
+ public:
+  static constexpr size_t MAX_OBJECT_SIZE = 256;
+
+  static void *allocate(size_t size);
+
+  static void deallocate(void *ptr, size_t size) noexcept;
+
+  // returns number of allocations, which were satisfied from the cache in the current thread
+  static uint64 get_reused_allocation_count();
+};
+
+// adds class-specific operators new and delete, which use SmallObjectAllocator
+#define TD_SMALL_OBJECT_ALLOCATION                                                   \
+  static void *operator new(std::size_t size) {                                      \
+    return ::td::SmallObjectAllocator::allocate(size);                               \
+  }                                                                                  \
+  static void operator delete(void *ptr, std::size_t size) noexcept {                \
+    ::td::SmallObjectAllocator::deallocate(ptr, size);                               \
+  }                                                                                  \
+  static void *operator new(std::size_t size, void *ptr) noexcept {                  \
+    return ptr;                                                                      \
+  }                                                                                  \
+  static void operator delete(void *ptr, void *place) noexcept {                     \
+  }
+
+}  // namespace td
@@ -103,6 +103,13 @@ class StealingQueue {
     }
   }
 
+  // can be called from any thread, but the result can be outdated
+  bool empty() const {
+    auto head = head_.load();
+    auto tail = tail_.load(std::memory_order_acquire);
+    return tail <= head;
+  }
+
   StealingQueue() {
     for (auto &x : buf_) {
 // workaround for https://gcc.gnu.org/bugzilla/show_bug.cgi?id=64658
@@ -0,0 +1,233 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/TimerWheel.h"
+
+#include "td/utils/bits.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/Time.h"
+
+#include <limits>
+
+namespace td {
+
+TimerWheel::TimerWheel() : TimerWheel(Time::now()) {
+}
+
+TimerWheel::TimerWheel(double now) {
+  slots_.fill(nullptr);
+  non_empty_slots_.fill(0);
+  expired_tail_ = &slots_[EXPIRED_SLOT];
+  current_tick_ = to_tick(now);
+}
+
+int64 TimerWheel::to_tick(double key) {
+  return static_cast<int64>(clamp(key, 0.0, 1e12) * TICKS_PER_SECOND);
+}
+
+void TimerWheel::insert(double key, TimerWheelNode *node) {
+  CHECK(!node->in_timer_wheel());
+  node->key_ = key;
+  node->tick_ = to_tick(key);
+  if (node->tick_ < current_tick_) {
+    // the key is less than the time passed to the last pop_expired call, so the node has already expired
+    link(node, EXPIRED_SLOT);
+  } else {
+    place(node);
+  }
+  size_++;
+}
+
+void TimerWheel::fix(double key, TimerWheelNode *node) {
+  erase(node);
+  insert(key, node);
+}
+
+void TimerWheel::erase(TimerWheelNode *node) {
+  CHECK(node->in_timer_wheel());
+  unlink(node);
+  size_--;
+}
+
+double TimerWheel::get_next_time() const {
+  CHECK(!empty());
+  if (slots_[EXPIRED_SLOT] != nullptr) {
+    return static_cast<double>(current_tick_) / TICKS_PER_SECOND;
+  }
+  // the tick is processed as soon as the next tick starts; add half of a tick to avoid rounding errors
+  return (static_cast<double>(get_next_tick()) + 1.5) / TICKS_PER_SECOND;
+}
+
+TimerWheelNode *TimerWheel::pop_expired(double now) {
+  advance(to_tick(now));
+  auto node = slots_[EXPIRED_SLOT];
+  if (node == nullptr) {
+    return nullptr;
+  }
+  erase(node);
+  return node;
+}
+
+TimerWheelNode *TimerWheel::pop() {
+  if (empty()) {
+    return nullptr;
+  }
+  auto node = slots_[EXPIRED_SLOT];
+  for (int32 level = 0; node == nullptr && level < LEVEL_COUNT; level++) {
+    auto bits = non_empty_slots_[level];
+    if (bits != 0) {
+      node = slots_[level * LEVEL_SIZE + count_trailing_zeroes_non_zero64(bits)];
+    }
+  }
+  if (node == nullptr) {
+    node = slots_[OVERFLOW_SLOT];
+  }
+  CHECK(node != nullptr);
+  erase(node);
+  return node;
+}
+
+void TimerWheel::link(TimerWheelNode *node, int32 slot) {
+  node->slot_ = slot;
+  if (slot == EXPIRED_SLOT) {
+    // expired nodes are kept in the order of expiration
+    node->next_ = nullptr;
+    node->prev_next_ = expired_tail_;
+    *expired_tail_ = node;
+    expired_tail_ = &node->next_;
+    return;
+  }
+
+  auto &head = slots_[slot];
+  node->next_ = head;
+  if (head != nullptr) {
+    head->prev_next_ = &node->next_;
+  }
+  head = node;
+  node->prev_next_ = &head;
+  if (slot < OVERFLOW_SLOT) {
+    non_empty_slots_[slot / LEVEL_SIZE] |= static_cast<uint64>(1) << (slot % LEVEL_SIZE);
+  }
+}
+
+void TimerWheel::unlink(TimerWheelNode *node) {
+  auto slot = node->slot_;
+  *node->prev_next_ = node->next_;
+  if (node->next_ != nullptr) {
+    node->next_->prev_next_ = node->prev_next_;
+  } else if (slot == EXPIRED_SLOT) {
+    expired_tail_ = node->prev_next_;
+  }
+  if (slot < OVERFLOW_SLOT && slots_[slot] == nullptr) {
+    non_empty_slots_[slot / LEVEL_SIZE] &= ~(static_cast<uint64>(1) << (slot % LEVEL_SIZE));
+  }
+  node->next_ = nullptr;
+  node->prev_next_ = nullptr;
+  node->slot_ = -1;
+}
+
+TimerWheelNode *TimerWheel::detach_slot(int32 slot) {
+  CHECK(slot < EXPIRED_SLOT);
+  auto head = slots_[slot];
+  slots_[slot] = nullptr;
+  if (slot < OVERFLOW_SLOT) {
+    non_empty_slots_[slot / LEVEL_SIZE] &= ~(static_cast<uint64>(1) << (slot % LEVEL_SIZE));
+  }
+  return head;
+}
+
+void TimerWheel::place(TimerWheelNode *node) {
+  // the node is placed to the lowest level, whose slots cover its tick
+  auto tick = node->tick_;
+  for (int32 level = 0; level < LEVEL_COUNT; level++) {
+    auto shift = level * LEVEL_BITS;
+    if ((tick >> shift) - (current_tick_ >> shift) < LEVEL_SIZE) {
+      return link(node, level * LEVEL_SIZE + static_cast<int32>((tick >> shift) & (LEVEL_SIZE - 1)));
+    }
+  }
+  if (slots_[OVERFLOW_SLOT] == nullptr || tick < overflow_min_tick_) {
+    overflow_min_tick_ = tick;
+  }
+  link(node, OVERFLOW_SLOT);
+}
+
+int64 TimerWheel::get_overflow_tick() const {
+  // the first tick, after which the earliest overflowed node fits in the last level
+  auto shift = (LEVEL_COUNT - 1) * LEVEL_BITS;
+  return max(current_tick_, max((overflow_min_tick_ >> shift) - (LEVEL_SIZE - 1), static_cast<int64>(0)) << shift);
+}
+
+int64 TimerWheel::get_next_tick() const {
+  auto result = std::numeric_limits<int64>::max();
+  for (int32 level = 0; level < LEVEL_COUNT; level++) {
+    auto bits = non_empty_slots_[level];
+    if (bits == 0) {
+      continue;
+    }
+    auto shift = level * LEVEL_BITS;
+    auto position = current_tick_ >> shift;
+    auto index = static_cast<int32>(position & (LEVEL_SIZE - 1));
+    if (index != 0) {
+      bits = (bits >> index) | (bits << (LEVEL_SIZE - index));
+    }
+    auto distance = count_trailing_zeroes_non_zero64(bits);
+    // a slot of the first level expires, a slot of other levels is moved to lower levels when its first tick comes
+    auto tick = distance == 0 ? current_tick_ : (position + distance) << shift;
+    result = min(result, tick);
+  }
+  if (slots_[OVERFLOW_SLOT] != nullptr) {
+    result = min(result, get_overflow_tick());
+  }
+  return result;
+}
+
+void TimerWheel::advance(int64 tick) {
+  while (current_tick_ < tick) {
+    auto next_tick = get_next_tick();
+    if (next_tick >= tick) {
+      current_tick_ = tick;
+      break;
+    }
+    current_tick_ = next_tick;
+    process_current_tick();
+    current_tick_++;
+  }
+}
+
+void TimerWheel::process_current_tick() {
+  auto replace_slot = [this](int32 slot) {
+    auto node = detach_slot(slot);
+    while (node != nullptr) {
+      auto next = node->next_;
+      node->slot_ = -1;
+      place(node);
+      node = next;
+    }
+  };
+
+  if (slots_[OVERFLOW_SLOT] != nullptr && current_tick_ >= get_overflow_tick()) {
+    replace_slot(OVERFLOW_SLOT);
+  }
+  // nodes move from higher levels to lower levels, so the levels must be processed from the highest one
+  for (int32 level = LEVEL_COUNT - 1; level > 0; level--) {
+    auto shift = level * LEVEL_BITS;
+    auto slot = level * LEVEL_SIZE + static_cast<int32>((current_tick_ >> shift) & (LEVEL_SIZE - 1));
+    if (slots_[slot] != nullptr) {
+      replace_slot(slot);
+    }
+  }
+
+  auto node = detach_slot(static_cast<int32>(current_tick_ & (LEVEL_SIZE - 1)));
+  while (node != nullptr) {
+    auto next = node->next_;
+    CHECK(node->tick_ == current_tick_);
+    link(node, EXPIRED_SLOT);
+    node = next;
+  }
+}
+
+}  // namespace td
@@ -0,0 +1,102 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#include "td/utils/common.h"
+
+#include <array>
+
+namespace td {
+
+struct TimerWheelNode {
+  bool in_timer_wheel() const {
+    return slot_ != -1;
+  }
+
+  TimerWheelNode *next_ = nullptr;
+  TimerWheelNode **prev_next_ = nullptr;
+  double key_ = 0.0;
+  int64 tick_ = 0;
+  int32 slot_ = -1;
+};
+
+// Hierarchical timing wheel with resolution of 1 millisecond.
+// Nodes are inserted and erased in O(1), but can expire up to 1 millisecond later than their key.
+class TimerWheel {
+ public:
+  TimerWheel();
+  explicit TimerWheel(double now);
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+  TimerWheel(TimerWheel &&) = delete;
+  TimerWheel &operator=(TimerWheel &&) = delete;
+  ~TimerWheel() = default;
+
+  bool empty() const {
+    return size_ == 0;
+  }
+  size_t size() const {
+    return size_;
+  }
+
+  double get_key(const TimerWheelNode *node) const {
+    CHECK(node->in_timer_wheel());
+    return node->key_;
+  }
+
+  void insert(double key, TimerWheelNode *node);
+
+  void fix(double key, TimerWheelNode *node);
+
+  void erase(TimerWheelNode *node);
+
+  // returns time, after which pop_expired must be called again; the wheel must not be empty
+  double get_next_time() const;
+
+  // returns a node with key less than now or nullptr
+  TimerWheelNode *pop_expired(double now);
+
+  // returns any node or nullptr if the wheel is empty
+  TimerWheelNode *pop();
+
+ private:
+  static constexpr double TICKS_PER_SECOND = 1000.0;
+  static constexpr int32 LEVEL_BITS = 6;
+  static constexpr int32 LEVEL_SIZE = 1 << LEVEL_BITS;
+  static constexpr int32 LEVEL_COUNT = 6;
+  static constexpr int32 OVERFLOW_SLOT = LEVEL_SIZE * LEVEL_COUNT;
+  static constexpr int32 EXPIRED_SLOT = OVERFLOW_SLOT + 1;
+  static constexpr int32 SLOT_COUNT = EXPIRED_SLOT + 1;
+  static_assert(LEVEL_SIZE == 64, "Non-empty slots of a level must fit in uint64");
+
+  std::array<TimerWheelNode *, SLOT_COUNT> slots_;
+  std::array<uint64, LEVEL_COUNT> non_empty_slots_;  // bitmask of non-empty slots for each level
+  TimerWheelNode **expired_tail_ = nullptr;
+  int64 current_tick_ = 0;  // all ticks before the current tick have already been processed
+  int64 overflow_min_tick_ = 0;
+  size_t size_ = 0;
+
+  static int64 to_tick(double key);
+
+  void link(TimerWheelNode *node, int32 slot);
+
+  void unlink(TimerWheelNode *node);
+
+  TimerWheelNode *detach_slot(int32 slot);
+
+  void place(TimerWheelNode *node);
+
+  int64 get_overflow_tick() const;
+
+  int64 get_next_tick() const;
+
+  void advance(int64 tick);
+
+  void process_current_tick();
+};
+
+}  // namespace td
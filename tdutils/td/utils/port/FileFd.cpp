@@ -649,6 +649,18 @@ Status FileFd::sync() {
   return Status::OK();
 }
 
+Status FileFd::sync_data() {
+  CHECK(!empty());
+#if TD_LINUX || TD_ANDROID
+  if (detail::skip_eintr([&] { return fdatasync(get_native_fd().fd()); }) != 0) {
+    return OS_ERROR("Sync data failed");
+  }
+  return Status::OK();
+#else
+  return sync();
+#endif
+}
+
 Status FileFd::sync_barrier() {
   CHECK(!empty());
 #if TD_DARWIN && defined(F_BARRIERFSYNC)
@@ -686,6 +698,49 @@ Status FileFd::truncate_to_current_position(int64 current_position) {
   }
   return Status::OK();
 }
+
+Status FileFd::preallocate(int64 size) {
+  CHECK(!empty());
+  if (size <= 0) {
+    return Status::OK();
+  }
+#if TD_LINUX
+  TRY_RESULT(size_off_t, narrow_cast_safe<off_t>(size));
+  if (detail::skip_eintr([&] { return fallocate(get_native_fd().fd(), FALLOC_FL_KEEP_SIZE, 0, size_off_t); }) != 0) {
+    return OS_ERROR("Preallocate failed");
+  }
+#elif TD_DARWIN
+  TRY_RESULT(real_size, get_real_size());
+  if (real_size >= size) {
+    return Status::OK();
+  }
+  // F_PEOFPOSMODE allocates space after the last allocated block
+  fstore_t store;
+  std::memset(&store, 0, sizeof(store));
+  store.fst_flags = F_ALLOCATECONTIG;
+  store.fst_posmode = F_PEOFPOSMODE;
+  store.fst_length = static_cast<off_t>(size - real_size);
+  if (fcntl(get_native_fd().fd(), F_PREALLOCATE, &store) == -1) {
+    store.fst_flags = F_ALLOCATEALL;
+    if (fcntl(get_native_fd().fd(), F_PREALLOCATE, &store) == -1) {
+      return OS_ERROR("Preallocate failed");
+    }
+  }
+#elif TD_PORT_WINDOWS
+  TRY_RESULT(current_size, get_size());
+  if (current_size >= size) {
+    // allocation size smaller than the file size truncates the file
+    return Status::OK();
+  }
+  FILE_ALLOCATION_INFO allocation_info;
+  allocation_info.AllocationSize.QuadPart = size;
+  if (SetFileInformationByHandle(get_native_fd().fd(), FileAllocationInfo, &allocation_info,
+                                 sizeof(allocation_info)) == 0) {
+    return OS_ERROR("Preallocate failed");
+  }
+#endif
+  return Status::OK();
+}
 PollableFdInfo &FileFd::get_poll_info() {
   CHECK(!empty());
   return impl_->info_;
@@ -62,12 +62,17 @@ class FileFd {
   Result<Stat> stat() const;
 
   Status sync() TD_WARN_UNUSED_RESULT;
+  // syncs file data and metadata needed to read it, but not modification time; falls back to sync() if unsupported
+  Status sync_data() TD_WARN_UNUSED_RESULT;
   Status sync_barrier() TD_WARN_UNUSED_RESULT;
 
   Status seek(int64 position) TD_WARN_UNUSED_RESULT;
 
   Status truncate_to_current_position(int64 current_position) TD_WARN_UNUSED_RESULT;
 
+  // reserves disk space for the first size bytes of the file without changing its size; does nothing if unsupported
+  Status preallocate(int64 size) TD_WARN_UNUSED_RESULT;
+
   const NativeFd &get_native_fd() const;
   NativeFd move_as_native_fd();
 
@@ -0,0 +1,77 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/common.h"
+#include "td/utils/CompactHints.h"
+#include "td/utils/Hints.h"
+#include "td/utils/Random.h"
+#include "td/utils/tests.h"
+
+TEST(CompactHints, simple) {
+  td::CompactHints hints;
+  hints.add(1, "Hello World");
+  hints.add(2, "Привет мир");
+  hints.add(3, "hello again");
+  hints.set_rating(3, -1);
+  ASSERT_EQ(3u, hints.size());
+  ASSERT_TRUE(hints.has_key(2));
+  ASSERT_STREQ("Привет мир", hints.key_to_string(2));
+
+  ASSERT_EQ((std::pair<size_t, td::vector<td::int64>>(2, {3, 1})), hints.search("hel", 10));
+  ASSERT_EQ((std::pair<size_t, td::vector<td::int64>>(1, {2})), hints.search("privet", 10));
+  ASSERT_EQ((std::pair<size_t, td::vector<td::int64>>(1, {1})), hints.search("world hello", 10));
+  ASSERT_EQ((std::pair<size_t, td::vector<td::int64>>(3, {3})), hints.search_empty(1));
+
+  hints.add(1, "Goodbye");
+  hints.remove(2);
+  ASSERT_EQ(2u, hints.size());
+  ASSERT_TRUE(!hints.has_key(2));
+  ASSERT_EQ((std::pair<size_t, td::vector<td::int64>>(1, {3})), hints.search("hel", 10));
+  ASSERT_EQ((std::pair<size_t, td::vector<td::int64>>(1, {1})), hints.search("good", 10));
+}
+
+TEST(CompactHints, random) {
+  td::vector<td::string> words = {"a",    "ab",    "abc", "b",      "ba",    "bac", "hello",
+                                  "help", "world", "мир", "привет", "прием", "ёж",  "ezh"};
+  auto get_random_name = [&] {
+    td::string name;
+    for (int i = td::Random::fast(0, 3); i > 0; i--) {
+      name += words[td::Random::fast(0, static_cast<int>(words.size()) - 1)];
+      name += ' ';
+    }
+    return name;
+  };
+
+  for (int test = 0; test < 10; test++) {
+    td::Hints hints;
+    td::CompactHints compact_hints;
+    auto max_key = td::Random::fast(1, 1000);
+    for (int i = 0; i < 10000; i++) {
+      td::int64 key = td::Random::fast(1, max_key);
+      auto type = td::Random::fast(0, 9);
+      if (type < 5) {
+        auto name = get_random_name();
+        hints.add(key, name);
+        compact_hints.add(key, name);
+      } else if (type < 7) {
+        auto rating = td::Random::fast(-10, 10);
+        hints.set_rating(key, rating);
+        compact_hints.set_rating(key, rating);
+      } else if (type < 8) {
+        hints.remove(key);
+        compact_hints.remove(key);
+      } else {
+        auto query = get_random_name();
+        auto limit = td::Random::fast(-1, 100);
+        ASSERT_EQ(hints.search(query, limit), compact_hints.search(query, limit));
+        ASSERT_EQ(hints.search(query, limit, true), compact_hints.search(query, limit, true));
+      }
+      ASSERT_EQ(hints.size(), compact_hints.size());
+      ASSERT_EQ(hints.has_key(key), compact_hints.has_key(key));
+      ASSERT_EQ(hints.key_to_string(key), compact_hints.key_to_string(key));
+    }
+  }
+}
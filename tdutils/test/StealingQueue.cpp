@@ -20,10 +20,13 @@
 
 TEST(StealingQueue, very_simple) {
   td::StealingQueue<int, 8> q;
+  ASSERT_TRUE(q.empty());
   q.local_push(1, [](auto x) { UNREACHABLE(); });
+  ASSERT_TRUE(!q.empty());
   int x;
   CHECK(q.local_pop(x));
   ASSERT_EQ(1, x);
+  ASSERT_TRUE(q.empty());
 }
 
 #if !TD_THREAD_UNSUPPORTED
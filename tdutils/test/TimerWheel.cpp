@@ -0,0 +1,118 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/utils/common.h"
+#include "td/utils/Random.h"
+#include "td/utils/tests.h"
+#include "td/utils/TimerWheel.h"
+
+#include <algorithm>
+
+TEST(TimerWheel, simple) {
+  td::TimerWheel wheel(100.0);
+  td::vector<td::TimerWheelNode> nodes(4);
+  wheel.insert(100.5, &nodes[0]);
+  wheel.insert(101.0, &nodes[1]);
+  wheel.insert(99.0, &nodes[2]);
+  wheel.insert(1e9, &nodes[3]);
+  ASSERT_EQ(4u, wheel.size());
+  ASSERT_EQ(101.0, wheel.get_key(&nodes[1]));
+
+  ASSERT_TRUE(wheel.pop_expired(100.0) == &nodes[2]);
+  ASSERT_TRUE(wheel.pop_expired(100.0) == nullptr);
+  ASSERT_TRUE(wheel.pop_expired(100.01) == nullptr);
+  // the wheel can wake up earlier to move the node to a lower level
+  ASSERT_TRUE(wheel.get_next_time() > 100.4);
+  ASSERT_TRUE(wheel.get_next_time() < 100.502);
+
+  wheel.fix(200.0, &nodes[0]);
+  wheel.erase(&nodes[1]);
+  ASSERT_TRUE(!nodes[1].in_timer_wheel());
+  ASSERT_TRUE(wheel.pop_expired(150.0) == nullptr);
+  ASSERT_TRUE(wheel.pop_expired(200.1) == &nodes[0]);
+  ASSERT_TRUE(wheel.pop_expired(1e8) == nullptr);
+  ASSERT_TRUE(wheel.pop() == &nodes[3]);
+  ASSERT_TRUE(wheel.empty());
+  ASSERT_TRUE(wheel.pop() == nullptr);
+}
+
+TEST(TimerWheel, random) {
+  td::Random::Xorshift128plus rnd(123);
+  for (int test = 0; test < 4; test++) {
+    double now = 1000.0 + rnd.fast(0, 1000000);
+    td::TimerWheel wheel(now);
+    int n = 1000;
+    td::vector<td::TimerWheelNode> nodes(n);
+    td::vector<double> keys(n, -1.0);  // expected keys of nodes in the wheel
+
+    auto random_key = [&] {
+      switch (rnd.fast(0, 3)) {
+        case 0:
+          return now + rnd.fast(0, 1000) * 0.001;
+        case 1:
+          return now + rnd.fast(0, 1000000) * 0.01;
+        case 2:
+          return now + rnd.fast(0, 1000000000) * 1.0;
+        default:
+          return now - rnd.fast(0, 1000) * 0.001;
+      }
+    };
+    auto check_expired = [&] {
+      td::vector<int> expired;
+      while (auto node = wheel.pop_expired(now)) {
+        auto id = static_cast<int>(node - &nodes[0]);
+        ASSERT_TRUE(keys[id] >= 0);
+        ASSERT_TRUE(keys[id] < now);
+        keys[id] = -1.0;
+        expired.push_back(id);
+      }
+      for (int i = 0; i < n; i++) {
+        // nodes can expire up to 1 millisecond later than their key
+        ASSERT_TRUE(keys[i] < 0 || keys[i] >= now - 0.0011);
+      }
+    };
+
+    for (int step = 0; step < 10000; step++) {
+      auto id = rnd.fast(0, n - 1);
+      switch (rnd.fast(0, 4)) {
+        case 0:
+        case 1:
+          keys[id] = random_key();
+          if (nodes[id].in_timer_wheel()) {
+            wheel.fix(keys[id], &nodes[id]);
+          } else {
+            wheel.insert(keys[id], &nodes[id]);
+          }
+          break;
+        case 2:
+          if (nodes[id].in_timer_wheel()) {
+            wheel.erase(&nodes[id]);
+            keys[id] = -1.0;
+          }
+          break;
+        case 3:
+          now += rnd.fast(0, 2000) * 0.001;
+          check_expired();
+          break;
+        case 4:
+          if (!wheel.empty()) {
+            // jump to the next time, at which something can happen
+            auto next_time = wheel.get_next_time();
+            ASSERT_TRUE(next_time <= td::max(now, *std::max_element(keys.begin(), keys.end()) + 0.0016));
+            now = td::max(now, next_time);
+            check_expired();
+          }
+          break;
+      }
+      ASSERT_EQ(static_cast<size_t>(std::count_if(keys.begin(), keys.end(), [](double key) { return key >= 0; })),
+                wheel.size());
+    }
+
+    now += 2e9;
+    check_expired();
+    ASSERT_TRUE(wheel.empty());
+  }
+}
@@ -12,6 +12,7 @@
 #include "td/utils/GzipByteFlow.h"
 #include "td/utils/logging.h"
 #include "td/utils/port/thread_local.h"
+#include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/Status.h"
 #include "td/utils/tests.h"
@@ -29,6 +30,27 @@ TEST(Gzip, gzencode_gzdecode) {
   encode_decode(td::string(1000000, 'a'));
 }
 
+TEST(Gzip, decoder) {
+  td::GzipDecoder decoder;
+  for (int i = 0; i < 100; i++) {
+    auto s = td::rand_string('a', 'c', td::Random::fast(0, 100000));
+    auto r = td::gzencode(s, 2);
+    ASSERT_TRUE(!r.empty());
+    ASSERT_EQ(s, decoder.decode(r.as_slice()));
+
+    if (!s.empty()) {
+      // truncated stream
+      ASSERT_TRUE(decoder.decode(r.as_slice().substr(0, td::Random::fast(0, static_cast<int>(r.size()) - 1))).empty());
+
+      // wrong size of the uncompressed data
+      auto changed = r.as_slice().str();
+      changed[changed.size() - 4 + td::Random::fast(0, 3)] ^= static_cast<char>(td::Random::fast(1, 255));
+      ASSERT_TRUE(decoder.decode(changed).empty());
+    }
+  }
+  ASSERT_TRUE(decoder.decode("abacaba").empty());
+}
+
 static void test_gzencode(const td::string &s) {
   auto begin_time = td::Time::now();
   auto r = td::gzencode(s, td::max(2, static_cast<int>(100 / s.size())));
@@ -298,3 +298,70 @@ TEST(JSON, string_decode) {
   test_string_decode_error("\"\\uD800\\ug123\"");
   test_string_decode_error("\"\\uD800\\u123\"");
 }
+
+TEST(JSON, parser) {
+  td::string str = " {\"a\\\"b\": [1, \"x\\ny\", null], \"@type\" : \"t\", \"c\": {\"d\": true}, \"e\": -5.5e1} ";
+  td::JsonParser parser(str);
+  ASSERT_TRUE(parser.peek_type() == td::JsonValue::Type::Object);
+  ASSERT_EQ("\"t\"", parser.peek_field("@type").ok());
+  ASSERT_EQ("{\"d\": true}", parser.peek_field("c").ok());
+  ASSERT_TRUE(parser.peek_field("d").ok().empty());
+
+  td::vector<td::string> fields;
+  td::vector<td::string> values;
+  auto status = parser.read_object([&](td::Slice name) {
+    fields.push_back(name.str());
+    if (name == "a\"b") {
+      return parser.read_array([&] {
+        if (parser.peek_type() == td::JsonValue::Type::Null) {
+          values.push_back("null");
+          return parser.skip_value();
+        }
+        auto r_value = parser.read_simple_value();
+        if (r_value.is_error()) {
+          return r_value.move_as_error();
+        }
+        auto value = r_value.move_as_ok();
+        values.push_back(value.type() == td::JsonValue::Type::String ? value.get_string().str()
+                                                                     : value.get_number().str());
+        return td::Status::OK();
+      });
+    }
+    if (name == "e") {
+      auto r_value = parser.read_simple_value();
+      if (r_value.is_error()) {
+        return r_value.move_as_error();
+      }
+      values.push_back(r_value.ok().get_number().str());
+      return td::Status::OK();
+    }
+    return parser.skip_value();
+  });
+  ASSERT_TRUE(status.is_ok());
+  ASSERT_TRUE(parser.finish().is_ok());
+  ASSERT_EQ((td::vector<td::string>{"a\"b", "@type", "c", "e"}), fields);
+  ASSERT_EQ((td::vector<td::string>{"1", "x\ny", "null", "-5.5e1"}), values);
+
+  str = "{\"@type\":\"t\",\"@extra\": {\"x\\n\": [1]}, \"a\":{\"@extra\":2}, \"@extra\":3}";
+  td::JsonParser extra_parser(str);
+  extra_parser.set_captured_field_name("@extra");
+  ASSERT_EQ("\"t\"", extra_parser.read_first_field("@type").ok());
+  fields.clear();
+  status = extra_parser.read_object([&](td::Slice name) {
+    fields.push_back(name.str());
+    return extra_parser.read_object([&](td::Slice inner_name) {
+      fields.push_back(inner_name.str());
+      return extra_parser.skip_value();
+    });
+  });
+  ASSERT_TRUE(status.is_ok());
+  ASSERT_TRUE(extra_parser.finish().is_ok());
+  ASSERT_EQ((td::vector<td::string>{"a", "@extra"}), fields);
+  ASSERT_EQ("{\"x\\n\": [1]}", extra_parser.get_captured_field_value());
+
+  for (td::string bad_str : {"{\"a\":1", "{\"a\" 1}", "{\"a\":[1 2]}", "{\"a\":[1,]}", "{\"a\":1} 2"}) {
+    td::JsonParser bad_parser(bad_str);
+    auto bad_status = bad_parser.read_object([&](td::Slice name) { return bad_parser.skip_value(); });
+    ASSERT_TRUE(bad_status.is_error() || bad_parser.finish().is_error());
+  }
+}
@@ -33,6 +33,7 @@
 #include "td/utils/Random.h"
 #include "td/utils/Slice.h"
 #include "td/utils/SliceBuilder.h"
+#include "td/utils/SmallObjectAllocator.h"
 #include "td/utils/Status.h"
 #include "td/utils/StringBuilder.h"
 #include "td/utils/tests.h"
@@ -1391,3 +1392,39 @@ TEST(UniqueValuePtr, Basic) {
   ASSERT_TRUE(c == d);
   ASSERT_TRUE(6 == **d);
 }
+
+TEST(Misc, SmallObjectAllocator) {
+  struct Object {
+    td::int64 values[3];
+
+    TD_SMALL_OBJECT_ALLOCATION
+  };
+  struct BigObject {
+    char data[td::SmallObjectAllocator::MAX_OBJECT_SIZE + 1];
+
+    TD_SMALL_OBJECT_ALLOCATION
+  };
+
+  auto object = td::make_unique<Object>();
+  object->values[2] = 3;
+  auto *raw_object = object.get();
+  object.reset();
+  auto reused_allocation_count = td::SmallObjectAllocator::get_reused_allocation_count();
+  object = td::make_unique<Object>();
+  ASSERT_TRUE(raw_object == object.get());
+  ASSERT_EQ(reused_allocation_count + 1, td::SmallObjectAllocator::get_reused_allocation_count());
+
+  td::vector<td::unique_ptr<Object>> objects;
+  for (int i = 0; i < 1000; i++) {
+    objects.push_back(td::make_unique<Object>());
+    objects.back()->values[0] = i;
+  }
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(i, objects[i]->values[0]);
+  }
+  objects.clear();
+
+  auto big_object = td::make_unique<BigObject>();
+  big_object->data[td::SmallObjectAllocator::MAX_OBJECT_SIZE] = 'a';
+  big_object.reset();
+}
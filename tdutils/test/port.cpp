@@ -124,6 +124,25 @@ TEST(Port, SparseFiles) {
   td::unlink(path).ensure();
 }
 
+TEST(Port, Preallocate) {
+  td::CSlice path = "preallocated.txt";
+  td::unlink(path).ignore();
+  auto fd = td::FileFd::open(path, td::FileFd::Write | td::FileFd::Read | td::FileFd::CreateNew).move_as_ok();
+  td::int64 size = 1 << 20;
+  auto status = fd.preallocate(size);
+  if (status.is_error()) {
+    LOG(ERROR) << "File system doesn't support preallocation: " << status;
+  }
+  ASSERT_EQ(0, fd.get_size().move_as_ok());
+  fd.pwrite("abcd", size - 4).ensure();
+  ASSERT_EQ(size, fd.get_size().move_as_ok());
+  td::string res(4, '\0');
+  fd.pread(res, size - 4).ensure();
+  ASSERT_STREQ(res, "abcd");
+  fd.close();
+  td::unlink(path).ensure();
+}
+
 TEST(Port, LargeFiles) {
   td::CSlice path = "large.txt";
   td::unlink(path).ignore();
@@ -15,6 +15,7 @@
 #include "td/db/SqliteDb.h"
 #include "td/db/SqliteKeyValue.h"
 #include "td/db/SqliteKeyValueSafe.h"
+#include "td/db/SqliteTransactionBatcher.h"
 #include "td/db/TsSeqKeyValue.h"
 
 #include "td/actor/actor.h"
@@ -138,6 +139,59 @@ TEST(DB, binlog_encryption) {
   td::Binlog::destroy(binlog_name).ignore();
 }
 
+TEST(DB, binlog_incremental_reindex) {
+  td::CSlice binlog_name = "test_binlog";
+  for (auto db_key : {td::DbKey::empty(), td::DbKey::raw_key(td::string(32, 'A'))}) {
+    td::Binlog::destroy(binlog_name).ignore();
+
+    std::map<td::uint64, td::string> events;
+    auto check_events = [&] {
+      std::map<td::uint64, td::string> loaded_events;
+      td::Binlog binlog;
+      binlog
+          .init(
+              binlog_name.str(),
+              [&](const td::BinlogEvent &event) { loaded_events[event.id_] = event.get_data().str(); }, db_key)
+          .ensure();
+      ASSERT_TRUE(events == loaded_events);
+    };
+
+    td::uint64 reindex_count = 0;
+    for (int iter = 0; iter < 3; iter++) {
+      td::Binlog binlog;
+      binlog.init(binlog_name.str(), [](const td::BinlogEvent &event) {}, db_key).ensure();
+      for (int i = 0; i < 20000; i++) {
+        auto data = td::rand_string('a', 'z', td::Random::fast(1, 25) * 4);
+        auto op = td::Random::fast(0, 9);
+        if (events.empty() || op < 3) {
+          auto event_id = binlog.add(1, td::create_storer(data));
+          events[event_id] = data;
+        } else {
+          auto it = events.lower_bound(td::Random::fast_uint64() % (events.rbegin()->first + 1));
+          if (it == events.end()) {
+            it = events.begin();
+          }
+          if (op < 8) {
+            binlog.rewrite(it->first, 1, td::create_storer(data));
+            it->second = data;
+          } else {
+            binlog.erase(it->first);
+            events.erase(it);
+          }
+        }
+        if (binlog.is_reindexing() && td::Random::fast(0, 100) == 0) {
+          binlog.reindex_step(td::Random::fast(0, 10000));
+        }
+      }
+      reindex_count += binlog.get_stats().reindex_count;
+      binlog.close().ensure();
+      check_events();
+    }
+    ASSERT_TRUE(reindex_count > 0);
+  }
+  td::Binlog::destroy(binlog_name).ignore();
+}
+
 TEST(DB, sqlite_lfs) {
   td::string path = "test_sqlite_db";
   td::SqliteDb::destroy(path).ignore();
@@ -524,6 +578,35 @@ TEST(DB, key_value_set_all) {
   td::SqliteDb::destroy(sqlite_kv_name).ignore();
 }
 
+TEST(DB, sqlite_transaction_batcher) {
+  td::SqliteTransactionBatcher batcher("TestBatcher");
+  auto add_queries = [&](int count) {
+    for (int i = 1; i < count; i++) {
+      ASSERT_TRUE(!batcher.on_query_added());
+      ASSERT_TRUE(batcher.get_commit_time() > 0);
+    }
+    return batcher.on_query_added();
+  };
+
+  // full batches increase maximum batch size
+  ASSERT_TRUE(add_queries(50));
+  batcher.on_committed(0.001);
+  ASSERT_TRUE(add_queries(100));
+  batcher.on_committed(0.001);
+  ASSERT_TRUE(add_queries(200));
+  batcher.on_committed(0.001);
+
+  // small batches decrease it
+  ASSERT_TRUE(!add_queries(1));
+  batcher.on_committed(0.001);
+  ASSERT_TRUE(!add_queries(100));
+  ASSERT_TRUE(add_queries(100));
+  batcher.on_committed(0.001);
+
+  auto stats = td::get_sqlite_transaction_batcher_stats();
+  ASSERT_TRUE(stats.find("TestBatcher transactions: 5, queries: 551") != td::string::npos);
+}
+
 #if !TD_THREAD_UNSUPPORTED
 TEST(DB, thread_key_value) {
   td::vector<td::string> keys;
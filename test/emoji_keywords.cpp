@@ -0,0 +1,34 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/EmojiKeywordIndex.h"
+
+#include "td/utils/common.h"
+#include "td/utils/tests.h"
+
+#include <utility>
+
+TEST(EmojiKeywords, index) {
+  td::EmojiKeywordIndex index({{"cat", "a$b"}, {"car", "c"}, {"dog", "d"}, {"cat", "e"}, {"empty", ""}});
+  ASSERT_EQ(3u, index.size());
+  ASSERT_EQ(td::vector<td::string>{"e"}, index.get_emojis("cat"));
+  ASSERT_EQ(td::vector<td::string>{"c"}, index.get_emojis("car"));
+  ASSERT_TRUE(index.get_emojis("ca").empty());
+  ASSERT_TRUE(index.get_emojis("empty").empty());
+
+  using Result = td::vector<std::pair<td::string, td::string>>;
+  ASSERT_EQ((Result{{"c", "car"}, {"e", "cat"}}), index.search("ca"));
+  ASSERT_EQ((Result{{"d", "dog"}}), index.search("dog"));
+  ASSERT_TRUE(index.search("dogs").empty());
+  ASSERT_EQ(3u, index.search("").size());
+
+  index.set_emojis("cab", {"f", "g"});
+  index.set_emojis("cat", {});
+  index.set_emojis("dog", {"h"});
+  ASSERT_EQ((Result{{"f", "cab"}, {"g", "cab"}, {"c", "car"}}), index.search("ca"));
+  ASSERT_EQ(td::vector<td::string>{"h"}, index.get_emojis("dog"));
+  ASSERT_EQ(3u, index.size());
+}
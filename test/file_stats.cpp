@@ -0,0 +1,65 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/DialogId.h"
+#include "td/telegram/files/FileStats.h"
+#include "td/telegram/files/FileType.h"
+#include "td/telegram/td_api.h"
+
+#include "td/utils/common.h"
+#include "td/utils/tests.h"
+#include "td/utils/tl_helpers.h"
+
+static td::FullFileInfo get_file_info(td::DialogId owner_dialog_id, td::FileType file_type, td::int64 size,
+                                      bool is_temp) {
+  td::FullFileInfo info;
+  info.file_type = file_type;
+  info.owner_dialog_id = owner_dialog_id;
+  info.size = size;
+  info.atime_nsec = 0;
+  info.mtime_nsec = 0;
+  info.is_temp = is_temp;
+  return info;
+}
+
+static void check_stats(const td::FileStats &file_stats, td::int64 size, td::int32 count) {
+  auto stats = file_stats.get_storage_statistics_object();
+  ASSERT_EQ(size, stats->size_);
+  ASSERT_EQ(count, stats->count_);
+}
+
+TEST(FileStats, counters_after_download) {
+  td::DialogId owner_dialog_id(static_cast<td::int64>(12345));
+
+  // full scan finds a downloaded video, a partially downloaded video and a generated file
+  td::FileStats scan_stats(false, true);
+  scan_stats.add(get_file_info(owner_dialog_id, td::FileType::Video, 1000, false));
+  scan_stats.add(get_file_info(owner_dialog_id, td::FileType::Video, 300, true));
+  scan_stats.add(get_file_info(td::DialogId(), td::FileType::Temp, 50, true));
+  check_stats(scan_stats.get_counters(false, false), 1350, 3);
+
+  // the partial files are excluded from the counters
+  auto counters = scan_stats.get_counters(true, true);
+  check_stats(counters, 1000, 1);
+
+  // the partial video is downloaded
+  counters.add_counters(owner_dialog_id, td::FileType::Video, 300, 1);
+  check_stats(counters, 1300, 2);
+  check_stats(counters.get_counters(false, false), 1300, 2);
+
+  // the counters are saved and loaded from the database
+  td::FileStats loaded_counters(false, true);
+  ASSERT_TRUE(td::unserialize(loaded_counters, td::serialize(counters)).is_ok());
+  check_stats(loaded_counters, 1300, 2);
+
+  // the next full scan must give the same counters
+  td::FileStats new_scan_stats(false, true);
+  new_scan_stats.add(get_file_info(owner_dialog_id, td::FileType::Video, 1000, false));
+  new_scan_stats.add(get_file_info(owner_dialog_id, td::FileType::Video, 300, false));
+  new_scan_stats.add(get_file_info(td::DialogId(), td::FileType::Temp, 50, true));
+  ASSERT_STREQ(td::td_api::to_string(new_scan_stats.get_counters(true, true).get_storage_statistics_object()),
+               td::td_api::to_string(loaded_counters.get_storage_statistics_object()));
+}
@@ -0,0 +1,181 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/DialogId.h"
+#include "td/telegram/MessageDb.h"
+#include "td/telegram/MessageFullId.h"
+#include "td/telegram/MessageId.h"
+#include "td/telegram/NotificationId.h"
+#include "td/telegram/ServerMessageId.h"
+#include "td/telegram/UserId.h"
+#include "td/telegram/Version.h"
+
+#include "td/db/DbKey.h"
+#include "td/db/SqliteConnectionSafe.h"
+#include "td/db/SqliteDb.h"
+
+#include "td/actor/ConcurrentScheduler.h"
+
+#include "td/utils/algorithm.h"
+#include "td/utils/buffer.h"
+#include "td/utils/common.h"
+#include "td/utils/SliceBuilder.h"
+#include "td/utils/tests.h"
+
+#include <memory>
+
+static std::shared_ptr<td::MessageDbSyncSafeInterface> create_message_db(td::SqliteDb &db, bool use_trigram_index) {
+  db.exec("BEGIN TRANSACTION").ensure();
+  td::init_message_db(db, td::current_db_version(), use_trigram_index).ensure();
+  db.exec("COMMIT TRANSACTION").ensure();
+
+  auto sql_connection = std::make_shared<td::SqliteConnectionSafe>(":memory:", td::DbKey::empty());
+  sql_connection->set(db.clone());
+  return td::create_message_db_sync(std::move(sql_connection));
+}
+
+static const td::DialogId DIALOG_ID(td::UserId(static_cast<td::int64>(123)));
+
+// the message text is stored as the message data to identify found messages
+static void add_message(td::MessageDbSyncInterface &db, td::int32 id, const td::string &text) {
+  db.add_message(td::MessageFullId(DIALOG_ID, td::MessageId(td::ServerMessageId(id))), td::ServerMessageId(),
+                 td::DialogId(), 0, 0, 0, id, text, td::NotificationId(), td::MessageId(), td::BufferSlice(text));
+}
+
+static td::vector<td::string> get_message_texts(const td::MessageDbFtsResult &result) {
+  td::vector<td::string> texts;
+  for (auto &message : result.messages) {
+    texts.push_back(message.data.as_slice().str());
+  }
+  return texts;
+}
+
+static td::vector<td::string> search_messages(td::MessageDbSyncInterface &db, td::string query) {
+  td::MessageDbFtsQuery fts_query;
+  fts_query.query = std::move(query);
+  return get_message_texts(db.get_messages_fts(std::move(fts_query)));
+}
+
+static td::MessageDbFtsResult search_messages_by_rank(td::MessageDbSyncInterface &db, td::string query,
+                                                      td::int32 offset, td::int32 limit) {
+  td::MessageDbFtsQuery fts_query;
+  fts_query.query = std::move(query);
+  fts_query.order_by_rank = true;
+  fts_query.offset = offset;
+  fts_query.limit = limit;
+  return db.get_messages_fts(std::move(fts_query));
+}
+
+TEST(MessageDb, trigram_search) {
+  td::ConcurrentScheduler sched(0, 0);
+  auto guard = sched.get_main_guard();
+
+  auto sqlite_db = td::SqliteDb::open_with_key(":memory:", true, td::DbKey::empty()).move_as_ok();
+  auto message_db = create_message_db(sqlite_db, true);
+  auto &db = message_db->get();
+  ASSERT_TRUE(db.build_trigram_index(10));
+
+  add_message(db, 1, "Hello world");
+  add_message(db, 2, "Привет, мир");
+  add_message(db, 3, "go to the supermarket");
+  add_message(db, 4, "\xF0\x9F\x98\x80 emoji smile \xF0\x9F\x98\x80 smiles");
+  add_message(db, 5, "an ox");
+  add_message(db, 6, "smile");
+
+  using Texts = td::vector<td::string>;
+  // parts of words
+  ASSERT_EQ(Texts{"go to the supermarket"}, search_messages(db, "market"));
+  ASSERT_EQ(Texts{"go to the supermarket"}, search_messages(db, "SUPERM"));
+  ASSERT_EQ(Texts{"Hello world"}, search_messages(db, "orl"));
+  ASSERT_EQ(Texts{"Hello world"}, search_messages(db, "ello worl"));
+  ASSERT_EQ(Texts{"Привет, мир"}, search_messages(db, "риве"));
+  ASSERT_EQ(Texts(), search_messages(db, "hello market"));
+  ASSERT_EQ(Texts(), search_messages(db, "wrld"));
+
+  // words shorter than 3 characters are searched by prefix
+  ASSERT_EQ(Texts{"an ox"}, search_messages(db, "ox"));
+  ASSERT_EQ(Texts{"an ox"}, search_messages(db, "an o"));
+  ASSERT_EQ(Texts{"go to the supermarket"}, search_messages(db, "to"));
+  ASSERT_EQ(Texts(), search_messages(db, "x"));
+
+  // transliterations
+  ASSERT_EQ(Texts{"Привет, мир"}, search_messages(db, "privet"));
+  ASSERT_EQ(Texts{"Привет, мир"}, search_messages(db, "privet mir"));
+  ASSERT_EQ(Texts{"Привет, мир"}, search_messages(db, "мир"));
+
+  // search by relevance with offsets of matched words in UTF-16 code units
+  auto result = search_messages_by_rank(db, "smile", 0, 10);
+  ASSERT_EQ(2u, result.messages.size());
+  ASSERT_EQ(2u, result.matches.size());
+  ASSERT_EQ(2, result.next_offset);
+  for (size_t i = 0; i < result.messages.size(); i++) {
+    auto text = result.messages[i].data.as_slice().str();
+    auto &matches = result.matches[i];
+    if (text == "smile") {
+      ASSERT_EQ(1u, matches.size());
+      ASSERT_EQ(0, matches[0].offset);
+      ASSERT_EQ(5, matches[0].length);
+    } else {
+      ASSERT_EQ(2u, matches.size());
+      ASSERT_EQ(9, matches[0].offset);
+      ASSERT_EQ(5, matches[0].length);
+      ASSERT_EQ(18, matches[1].offset);
+      ASSERT_EQ(6, matches[1].length);
+    }
+  }
+
+  auto first_result = search_messages_by_rank(db, "smile", 0, 1);
+  ASSERT_EQ(1, first_result.next_offset);
+  auto second_result = search_messages_by_rank(db, "smile", first_result.next_offset, 1);
+  ASSERT_EQ(2, second_result.next_offset);
+  auto texts = get_message_texts(first_result);
+  td::append(texts, get_message_texts(second_result));
+  ASSERT_EQ(get_message_texts(result), texts);
+  ASSERT_TRUE(search_messages_by_rank(db, "smile", 2, 1).messages.empty());
+}
+
+TEST(MessageDb, trigram_index_migration) {
+  td::ConcurrentScheduler sched(0, 0);
+  auto guard = sched.get_main_guard();
+
+  auto sqlite_db = td::SqliteDb::open_with_key(":memory:", true, td::DbKey::empty()).move_as_ok();
+  auto message_db = create_message_db(sqlite_db, false);
+  for (int i = 1; i <= 7; i++) {
+    add_message(message_db->get(), i, PSTRING() << "pineapple " << i);
+  }
+  ASSERT_TRUE(search_messages(message_db->get(), "neapp").empty());
+  ASSERT_EQ(7u, search_messages(message_db->get(), "pineapple").size());
+  message_db.reset();
+
+  message_db = create_message_db(sqlite_db, true);
+  ASSERT_TRUE(!message_db->get().build_trigram_index(3));
+
+  // the old index is used until the new one is complete
+  add_message(message_db->get(), 8, "pineapple 8");
+  ASSERT_TRUE(search_messages(message_db->get(), "neapp").empty());
+  ASSERT_EQ(8u, search_messages(message_db->get(), "pineapple").size());
+
+  // the progress is kept in the database
+  message_db.reset();
+  message_db = create_message_db(sqlite_db, true);
+  ASSERT_TRUE(!message_db->get().build_trigram_index(3));
+  ASSERT_TRUE(search_messages(message_db->get(), "neapp").empty());
+  ASSERT_TRUE(message_db->get().build_trigram_index(3));
+
+  auto texts = search_messages(message_db->get(), "neapp");
+  ASSERT_EQ(8u, texts.size());
+  for (int i = 1; i <= 8; i++) {
+    ASSERT_EQ(texts[8 - i], PSTRING() << "pineapple " << i);
+  }
+  ASSERT_TRUE(message_db->get().build_trigram_index(3));
+
+  // the trigram index is dropped if it is disabled
+  message_db.reset();
+  message_db = create_message_db(sqlite_db, false);
+  ASSERT_TRUE(message_db->get().build_trigram_index(3));
+  ASSERT_TRUE(search_messages(message_db->get(), "neapp").empty());
+  ASSERT_EQ(8u, search_messages(message_db->get(), "pineapple").size());
+}
@@ -0,0 +1,197 @@
+//
+// Copyright Aliaksei Levin (levlam@telegram.org), Arseny Smirnov (arseny30@gmail.com) 2014-2024
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+#include "td/telegram/MessageId.h"
+#include "td/telegram/OrderedMessage.h"
+
+#include "td/utils/common.h"
+#include "td/utils/Random.h"
+#include "td/utils/tests.h"
+
+#include <iterator>
+#include <map>
+#include <utility>
+
+class SimpleOrderedMessages {
+ public:
+  void insert(td::MessageId message_id, bool auto_attach, td::MessageId old_last_message_id) {
+    auto &message = messages_[message_id.get()];
+    auto it = messages_.find(message_id.get());
+    auto prev = it == messages_.begin() ? messages_.end() : std::prev(it);
+    auto next = std::next(it);
+    if (auto_attach) {
+      if (prev != messages_.end() &&
+          (prev->second.second || (old_last_message_id.is_valid() && prev->first >= old_last_message_id.get()))) {
+        message.first = true;
+        message.second = prev->second.second;
+        prev->second.second = true;
+      } else if (!message_id.is_yet_unsent() && next != messages_.end()) {
+        message.second = true;
+        next->second.first = true;
+      }
+    } else if (prev != messages_.end() && prev->second.second) {
+      prev->second.second = false;
+      next->second.first = false;
+    }
+  }
+
+  void erase(td::MessageId message_id, bool only_from_memory) {
+    auto it = messages_.find(message_id.get());
+    CHECK(it != messages_.end());
+    if (it->second.first && (only_from_memory || !it->second.second)) {
+      std::prev(it)->second.second = false;
+    }
+    if (it->second.second && (only_from_memory || !it->second.first)) {
+      std::next(it)->second.first = false;
+    }
+    messages_.erase(it);
+  }
+
+  void attach_message_to_previous(td::MessageId message_id) {
+    auto it = messages_.find(message_id.get());
+    if (it->second.first) {
+      return;
+    }
+    it->second.first = true;
+    auto prev = std::prev(it);
+    if (prev->second.second) {
+      it->second.second = true;
+    } else {
+      prev->second.second = true;
+    }
+  }
+
+  void attach_message_to_next(td::MessageId message_id) {
+    auto it = messages_.find(message_id.get());
+    if (it->second.second) {
+      return;
+    }
+    it->second.second = true;
+    auto next = std::next(it);
+    if (next->second.first) {
+      it->second.first = true;
+    } else {
+      next->second.first = true;
+    }
+  }
+
+  // pairs (have_previous, have_next)
+  std::map<td::int64, std::pair<bool, bool>> messages_;
+};
+
+static void check_ordered_messages(const td::OrderedMessages &ordered_messages, const SimpleOrderedMessages &simple) {
+  const auto &messages = simple.messages_;
+  ASSERT_EQ(messages.empty(), ordered_messages.empty());
+  ASSERT_EQ(messages.size(), ordered_messages.size());
+  for (auto it = messages.begin(); it != messages.end(); ++it) {
+    td::MessageId message_id(it->first);
+    auto ordered_it = ordered_messages.get_const_iterator(message_id);
+    ASSERT_TRUE(*ordered_it != nullptr);
+    ASSERT_EQ(message_id, (*ordered_it)->get_message_id());
+    ASSERT_EQ(it->second.second, (*ordered_it)->have_next());
+    ++ordered_it;
+    if (it->second.second) {
+      ASSERT_TRUE(*ordered_it != nullptr);
+      ASSERT_EQ(std::next(it)->first, (*ordered_it)->get_message_id().get());
+    } else {
+      ASSERT_TRUE(*ordered_it == nullptr);
+    }
+
+    ordered_it = ordered_messages.get_const_iterator(message_id);
+    --ordered_it;
+    if (it->second.first) {
+      ASSERT_TRUE(*ordered_it != nullptr);
+      ASSERT_EQ(std::prev(it)->first, (*ordered_it)->get_message_id().get());
+    } else {
+      ASSERT_TRUE(*ordered_it == nullptr);
+    }
+  }
+
+  auto max_message_id = td::MessageId(static_cast<td::int64>(td::Random::fast(0, 1 << 16)) << 20);
+  td::vector<td::MessageId> older_message_ids;
+  td::vector<td::MessageId> newer_message_ids;
+  for (auto &message : messages) {
+    if (message.first <= max_message_id.get()) {
+      older_message_ids.push_back(td::MessageId(message.first));
+    } else {
+      newer_message_ids.push_back(td::MessageId(message.first));
+    }
+  }
+  ASSERT_TRUE(older_message_ids == ordered_messages.find_older_messages(max_message_id));
+  ASSERT_TRUE(newer_message_ids == ordered_messages.find_newer_messages(max_message_id));
+
+  auto get_message_date = [](td::MessageId message_id) {
+    return static_cast<td::int32>(message_id.get() >> 24);
+  };
+  auto date = get_message_date(max_message_id);
+  td::MessageId last_message_id;
+  td::vector<td::MessageId> message_ids;
+  for (auto &message : messages) {
+    td::MessageId message_id(message.first);
+    auto message_date = get_message_date(message_id);
+    if (message_date <= date) {
+      last_message_id = message_id;
+    }
+    if (date - 2 <= message_date && message_date <= date + 3) {
+      message_ids.push_back(message_id);
+    }
+  }
+  ASSERT_EQ(last_message_id, ordered_messages.find_message_by_date(date, get_message_date));
+  ASSERT_TRUE(message_ids == ordered_messages.find_messages_by_date(date - 2, date + 3, get_message_date));
+}
+
+TEST(OrderedMessages, stress) {
+  for (int test = 0; test < 100; test++) {
+    td::OrderedMessages ordered_messages;
+    SimpleOrderedMessages simple;
+    auto max_server_message_id = td::Random::fast(10, 1 << 12);
+    auto mode = td::Random::fast(0, 2);
+    td::int64 last_server_message_id = mode == 2 ? max_server_message_id + 1 : 0;
+    for (int i = 0; i < 2000; i++) {
+      auto type = td::Random::fast(0, 9);
+      if (type < 6 || simple.messages_.empty()) {
+        td::int64 server_message_id = mode == 0   ? td::Random::fast(1, max_server_message_id)
+                                      : mode == 1 ? ++last_server_message_id
+                                                  : --last_server_message_id;
+        if (server_message_id <= 0) {
+          continue;
+        }
+        td::MessageId message_id((server_message_id << 20) + (td::Random::fast(0, 9) == 0 ? 1 : 0));
+        if (simple.messages_.count(message_id.get()) != 0) {
+          continue;
+        }
+        bool auto_attach = td::Random::fast_bool();
+        auto old_last_message_id = simple.messages_.empty() || td::Random::fast_bool()
+                                       ? td::MessageId()
+                                       : td::MessageId(simple.messages_.rbegin()->first);
+        ordered_messages.insert(message_id, auto_attach, old_last_message_id, "stress");
+        simple.insert(message_id, auto_attach, old_last_message_id);
+      } else {
+        auto server_message_id = static_cast<td::int64>(td::Random::fast(0, max_server_message_id));
+        auto it = simple.messages_.lower_bound(server_message_id << 20);
+        if (it == simple.messages_.end()) {
+          it = simple.messages_.begin();
+        }
+        td::MessageId message_id(it->first);
+        if (type < 8) {
+          bool only_from_memory = td::Random::fast_bool();
+          ordered_messages.erase(message_id, only_from_memory);
+          simple.erase(message_id, only_from_memory);
+        } else if (type == 8 && it != simple.messages_.begin()) {
+          ordered_messages.attach_message_to_previous(message_id, "stress");
+          simple.attach_message_to_previous(message_id);
+        } else if (type == 9 && std::next(it) != simple.messages_.end()) {
+          ordered_messages.attach_message_to_next(message_id, "stress");
+          simple.attach_message_to_next(message_id);
+        }
+      }
+      if (i % 200 == 0) {
+        check_ordered_messages(ordered_messages, simple);
+      }
+    }
+    check_ordered_messages(ordered_messages, simple);
+  }
+}
@@ -8,6 +8,8 @@
 
 #include "td/telegram/Client.h"
 #include "td/telegram/ClientActor.h"
+#include "td/telegram/ClientJson.h"
+#include "td/telegram/files/DownloadSpeedEstimator.h"
 #include "td/telegram/files/PartsManager.h"
 #include "td/telegram/td_api.h"
 
@@ -34,6 +36,7 @@
 #include "td/utils/tests.h"
 
 #include <atomic>
+#include <cmath>
 #include <cstdio>
 #include <functional>
 #include <map>
@@ -891,6 +894,19 @@ TEST(Client, SimpleMulti) {
   }
 }
 
+TEST(Client, JsonRepeatedFields) {
+  // the first value of a repeated field must be used
+  ASSERT_STREQ("{\"@type\":\"text\",\"text\":\"a\",\"@extra\":1}",
+               td::ClientJson::execute(
+                   "{\"@type\":\"cleanFileName\",\"file_name\":\"a\",\"@extra\":1,\"file_name\":\"b\",\"@extra\":2}"));
+  ASSERT_STREQ("{\"@type\":\"text\",\"text\":\"a\"}",
+               td::ClientJson::execute("{\"file_name\":\"a\",\"@type\":\"cleanFileName\",\"@type\":\"testSquareInt\","
+                                       "\"file_name\":\"b\"}"));
+  ASSERT_STREQ("{\"@type\":\"formattedText\",\"text\":\"a\",\"entities\":[]}",
+               td::ClientJson::execute("{\"@type\":\"getMarkdownText\",\"text\":{\"@type\":\"formattedText\","
+                                       "\"text\":\"a\",\"entities\":[],\"text\":\"b\"},\"text\":null}"));
+}
+
 #if !TD_THREAD_UNSUPPORTED
 TEST(Client, Multi) {
   td::vector<td::thread> threads;
@@ -970,6 +986,54 @@ TEST(Client, Manager) {
   }
 }
 
+#if !TD_THREAD_UNSUPPORTED && !TD_EVENTFD_UNSUPPORTED
+TEST(Client, ManagerThreadPools) {
+  td::ClientManager client;
+  td::ClientManager::ThreadPoolOptions options;
+  options.pool_count = 2;
+  options.additional_thread_count = 1;
+  ASSERT_TRUE(client.set_thread_pool_options(options));
+
+  int clients_n = 5;
+  td::vector<td::ClientManager::ClientId> client_ids;
+  for (int i = 0; i < clients_n; i++) {
+    client_ids.push_back(client.create_client_id());
+  }
+  ASSERT_TRUE(client.set_client_thread_pool(client_ids[0], td::ClientManager::DEDICATED_THREAD_POOL));
+  ASSERT_TRUE(client.set_client_thread_pool(client_ids[1], 1));
+  ASSERT_TRUE(!client.set_client_thread_pool(client_ids[2], 2));
+  for (auto client_id : client_ids) {
+    client.send(client_id, 3, td::make_tl_object<td::td_api::testSquareInt>(3));
+  }
+  ASSERT_TRUE(!client.set_thread_pool_options(options));
+  ASSERT_TRUE(!client.set_client_thread_pool(client_ids[2], 0));
+
+  std::set<td::int32> ids;
+  while (ids.size() != static_cast<size_t>(clients_n)) {
+    auto event = client.receive(10);
+    if (event.request_id == 3) {
+      ASSERT_EQ(td::td_api::testInt::ID, event.object->get_id());
+      ASSERT_TRUE(ids.insert(event.client_id).second);
+    }
+  }
+
+  auto stats = client.get_thread_pool_stats();
+  ASSERT_EQ(3u, stats.size());
+  td::int32 client_count = 0;
+  td::uint64 request_count = 0;
+  for (auto &pool_stats : stats) {
+    ASSERT_EQ(pool_stats.is_dedicated, pool_stats.pool_id >= 2);
+    ASSERT_EQ(3, pool_stats.thread_count);
+    client_count += pool_stats.client_count;
+    request_count += pool_stats.request_count;
+  }
+  ASSERT_EQ(1, stats[2].client_count);
+  ASSERT_TRUE(stats[1].client_count >= 1);
+  ASSERT_EQ(clients_n, client_count);
+  ASSERT_TRUE(request_count >= static_cast<td::uint64>(clients_n));
+}
+#endif
+
 #if !TD_EVENTFD_UNSUPPORTED  // Client must be used from a single thread if there is no EventFd
 TEST(Client, Close) {
   std::atomic<bool> stop_send{false};
@@ -1190,3 +1254,26 @@ TEST(PartsManager, hands) {
     pm.init(1, 100000, true, 10, {0, 1, 2}, false, true).ensure_error();
   }
 }
+
+TEST(DownloadSpeedEstimator, resource_limit) {
+  for (auto speed : {1e7, 1e8}) {
+    td::DownloadSpeedEstimator estimator;
+    ASSERT_EQ(2000000, estimator.get_resource_limit(2000000, 64000000));
+
+    td::int64 part_size = 1 << 19;
+    double now = 1000.0;
+    while (now < 1003.0) {
+      now += static_cast<double>(part_size) / speed;
+      estimator.on_part_downloaded(part_size, 0.05, now);
+    }
+    ASSERT_TRUE(std::abs(estimator.get_speed() / speed - 1.0) < 0.1);
+    ASSERT_EQ(0.05, estimator.get_min_latency());
+    auto limit = estimator.get_resource_limit(2000000, 64000000);
+    ASSERT_TRUE(limit >= 2000000);
+    ASSERT_TRUE(std::abs(static_cast<double>(limit) - td::max(2000000.0, speed * 0.1)) < speed * 0.01);
+
+    // the estimation is reset after a long pause
+    estimator.on_part_downloaded(part_size, 0.05, now + 100);
+    ASSERT_EQ(0.0, estimator.get_speed());
+  }
+}